@@ -0,0 +1,639 @@
+// bench/QASM2Bench.cpp
+#include <benchmark/benchmark.h>
+#include <antlr4-runtime.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <unistd.h>
+#include "QASM2Lexer.h"
+#include "QASM2Parser.h"
+#include "Visitor.h"
+#include "AST.h"
+#include "AllocCounter.h"
+#include "CircuitGenerator.h"
+#include "Simulator.h"
+#include "Resources.h"
+#include "Validator.h"
+#include "Server.h"
+#include "Batch.h"
+#include "Driver.h"
+#include "Template.h"
+#include "Transpiler.h"
+#include "Fingerprint.h"
+#include "Noise.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+namespace
+{
+    // Number of qubits used by the generated circuits
+    const int kBenchQubits = 16;
+
+    // Changes the working directory for the lifetime of a scope, so the
+    // benchmarks that run afterwards keep the original one
+    class ScopedWorkingDir
+    {
+    public:
+        explicit ScopedWorkingDir(const char *path)
+        {
+            changed = getcwd(previous, sizeof(previous)) != nullptr && chdir(path) == 0;
+        }
+
+        ~ScopedWorkingDir()
+        {
+            if (changed && chdir(previous) != 0)
+                std::cerr << "Could not restore working directory: " << previous << std::endl;
+        }
+
+        bool ok() const { return changed; }
+
+    private:
+        char previous[4096];
+        bool changed = false;
+    };
+
+    // Generated circuit together with the number of statements it holds
+    struct BenchCircuit
+    {
+        std::string source;
+        int64_t statements;
+    };
+
+    // Generate a circuit with the given number of gate statements.
+    // The gates rotate through U, CX and parametric library-style gates so
+    // every alternative of the uop rule is exercised.
+    BenchCircuit makeCircuit(int64_t gates)
+    {
+        std::ostringstream out;
+        out << "OPENQASM 2.0;\n";
+        out << "qreg q[" << kBenchQubits << "];\n";
+        out << "creg c[" << kBenchQubits << "];\n";
+
+        for (int64_t i = 0; i < gates; ++i)
+        {
+            int a = static_cast<int>(i % kBenchQubits);
+            int b = static_cast<int>((i + 1) % kBenchQubits);
+            switch (i % 4)
+            {
+            case 0:
+                out << "h q[" << a << "];\n";
+                break;
+            case 1:
+                out << "cx q[" << a << "],q[" << b << "];\n";
+                break;
+            case 2:
+                out << "U(pi/2,0,pi) q[" << a << "];\n";
+                break;
+            default:
+                out << "u3(0.25,-pi/4,pi/8) q[" << a << "];\n";
+                break;
+            }
+        }
+
+        BenchCircuit circuit;
+        circuit.source = out.str();
+        circuit.statements = gates + 2;
+        return circuit;
+    }
+
+    // Cache generated circuits so large inputs are only built once per run
+    const BenchCircuit &getCircuit(int64_t gates)
+    {
+        static std::map<int64_t, BenchCircuit> circuits;
+        auto it = circuits.find(gates);
+        if (it == circuits.end())
+        {
+            it = circuits.emplace(gates, makeCircuit(gates)).first;
+        }
+        return it->second;
+    }
+
+    std::string readFile(const std::string &path)
+    {
+        std::ifstream stream(path);
+        if (!stream.is_open())
+        {
+            throw std::runtime_error("Could not open file: " + path);
+        }
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+        return buffer.str();
+    }
+
+    // Report throughput as bytes/s and statements/s
+    void setThroughput(benchmark::State &state, int64_t bytes, int64_t statements)
+    {
+        state.SetBytesProcessed(state.iterations() * bytes);
+        state.counters["stmts/s"] = benchmark::Counter(static_cast<double>(statements), benchmark::Counter::kIsIterationInvariantRate);
+    }
+
+    // Report the heap allocations per statement made during the timed loop
+    void setAllocations(benchmark::State &state, const AllocCounts &counts, int64_t statements)
+    {
+        if (state.iterations() > 0 && statements > 0)
+        {
+            state.counters["allocs/stmt"] = static_cast<double>(counts.allocations) / state.iterations() / statements;
+        }
+    }
+
+    // Count the statements of a QASM source by its top level terminators
+    int64_t countStatements(const std::string &source)
+    {
+        int64_t count = 0;
+        int depth = 0;
+        for (char c : source)
+        {
+            if (c == '{')
+                depth++;
+            else if (c == '}' && --depth == 0)
+                count++;
+            else if (c == ';' && depth == 0)
+                count++;
+        }
+        return count;
+    }
+} // namespace
+
+// Fixture holding a generated circuit sized by the benchmark argument
+class GeneratedCircuit : public benchmark::Fixture
+{
+public:
+    const BenchCircuit *circuit = nullptr;
+
+    void SetUp(const benchmark::State &state) override
+    {
+        circuit = &getCircuit(state.range(0));
+    }
+};
+
+// Fixture holding a parse tree so the visitor can be measured on its own
+class ParsedCircuit : public GeneratedCircuit
+{
+public:
+    std::unique_ptr<ANTLRInputStream> input;
+    std::unique_ptr<qasmcpp::QASM2Lexer> lexer;
+    std::unique_ptr<CommonTokenStream> tokens;
+    std::unique_ptr<qasmcpp::QASM2Parser> parser;
+    tree::ParseTree *tree = nullptr;
+
+    void SetUp(const benchmark::State &state) override
+    {
+        GeneratedCircuit::SetUp(state);
+        input.reset(new ANTLRInputStream(circuit->source));
+        lexer.reset(new qasmcpp::QASM2Lexer(input.get()));
+        tokens.reset(new CommonTokenStream(lexer.get()));
+        parser.reset(new qasmcpp::QASM2Parser(tokens.get()));
+        tree = parser->main();
+    }
+
+    void TearDown(const benchmark::State &) override
+    {
+        tree = nullptr;
+        parser.reset();
+        tokens.reset();
+        lexer.reset();
+        input.reset();
+    }
+};
+
+// Lexing phase: character stream to token stream
+BENCHMARK_DEFINE_F(GeneratedCircuit, Lex)(benchmark::State &state)
+{
+    AllocCounts allocs;
+    {
+        AllocScope scope(&allocs);
+        for (auto _ : state)
+        {
+            ANTLRInputStream input(circuit->source);
+            qasmcpp::QASM2Lexer lexer(&input);
+            CommonTokenStream tokens(&lexer);
+            tokens.fill();
+            benchmark::DoNotOptimize(tokens.size());
+        }
+    }
+    setThroughput(state, circuit->source.size(), circuit->statements);
+    setAllocations(state, allocs, circuit->statements);
+}
+
+// Parsing phase: lexing plus parse tree construction
+BENCHMARK_DEFINE_F(GeneratedCircuit, Parse)(benchmark::State &state)
+{
+    AllocCounts allocs;
+    {
+        AllocScope scope(&allocs);
+        for (auto _ : state)
+        {
+            ANTLRInputStream input(circuit->source);
+            qasmcpp::QASM2Lexer lexer(&input);
+            CommonTokenStream tokens(&lexer);
+            tokens.fill();
+            qasmcpp::QASM2Parser parser(&tokens);
+            benchmark::DoNotOptimize(parser.main());
+        }
+    }
+    setThroughput(state, circuit->source.size(), circuit->statements);
+    setAllocations(state, allocs, circuit->statements);
+}
+
+// AST construction phase: visiting an existing parse tree
+BENCHMARK_DEFINE_F(ParsedCircuit, Visit)(benchmark::State &state)
+{
+    AllocCounts allocs;
+    {
+        AllocScope scope(&allocs);
+        for (auto _ : state)
+        {
+            QASM2Visitor visitor;
+            visitor.visit(tree);
+            benchmark::DoNotOptimize(visitor.getProgram());
+        }
+    }
+    setThroughput(state, circuit->source.size(), circuit->statements);
+    setAllocations(state, allocs, circuit->statements);
+}
+
+// Teardown phase: releasing the AST built from a generated circuit
+BENCHMARK_DEFINE_F(ParsedCircuit, Teardown)(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::shared_ptr<ProgramNode> program;
+        {
+            QASM2Visitor visitor;
+            visitor.visit(tree);
+            program = visitor.getProgram();
+        }
+        state.ResumeTiming();
+        program.reset();
+    }
+    setThroughput(state, circuit->source.size(), circuit->statements);
+}
+
+BENCHMARK_REGISTER_F(GeneratedCircuit, Lex)->RangeMultiplier(10)->Range(1000, QASM2_BENCH_MAX_GATES)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(GeneratedCircuit, Parse)->RangeMultiplier(10)->Range(1000, QASM2_BENCH_MAX_GATES)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ParsedCircuit, Visit)->RangeMultiplier(10)->Range(1000, QASM2_BENCH_MAX_GATES)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ParsedCircuit, Teardown)->RangeMultiplier(10)->Range(1000, QASM2_BENCH_MAX_GATES)->Unit(benchmark::kMillisecond);
+
+// Include handling: lex, parse and visit qelib1.inc through an include statement
+static void BM_IncludeQelib1(benchmark::State &state)
+{
+    std::string path = std::string(QASM2_TEST_DIR) + "/circuits/qelib1.inc";
+    std::string source = "OPENQASM 2.0;\ninclude \"" + path + "\";\n";
+    std::string library = readFile(path);
+
+    for (auto _ : state)
+    {
+        ANTLRInputStream input(source);
+        qasmcpp::QASM2Lexer lexer(&input);
+        CommonTokenStream tokens(&lexer);
+        qasmcpp::QASM2Parser parser(&tokens);
+        tree::ParseTree *tree = parser.main();
+
+        QASM2Visitor visitor;
+        visitor.visit(tree);
+        benchmark::DoNotOptimize(visitor.getSymbolTable().gateDefines.size());
+    }
+    setThroughput(state, library.size(), countStatements(library));
+}
+BENCHMARK(BM_IncludeQelib1)->Unit(benchmark::kMicrosecond);
+
+// Full front end on the bundled adder circuit, including both of its includes
+static void BM_AdderCircuit(benchmark::State &state)
+{
+    // The circuit includes "../test/circuits/*.inc" relative to the working directory
+    ScopedWorkingDir workingDir(QASM2_TEST_DIR);
+    if (!workingDir.ok())
+    {
+        state.SkipWithError("Could not change to the test directory");
+        return;
+    }
+    std::string source = readFile("circuits/adder_n4_cus.qasm");
+    // qelib1.inc loads the built-in tables, only myLibrary.inc is read from disk
+    int64_t bytes = source.size() + readFile("circuits/myLibrary.inc").size();
+
+    for (auto _ : state)
+    {
+        ANTLRInputStream input(source);
+        qasmcpp::QASM2Lexer lexer(&input);
+        CommonTokenStream tokens(&lexer);
+        qasmcpp::QASM2Parser parser(&tokens);
+        tree::ParseTree *tree = parser.main();
+
+        QASM2Visitor visitor;
+        visitor.visit(tree);
+        benchmark::DoNotOptimize(visitor.getProgram());
+    }
+    setThroughput(state, bytes, countStatements(source));
+}
+BENCHMARK(BM_AdderCircuit)->Unit(benchmark::kMicrosecond);
+
+// Full front end on each workload kind of the circuit generator
+static void BM_GeneratedWorkload(benchmark::State &state, const std::string &kind, int qubits, int64_t size)
+{
+    std::ostringstream out;
+    CircuitGenerator generator(1, false);
+    generator.generate(out, kind, qubits, size);
+    std::string source = out.str();
+
+    for (auto _ : state)
+    {
+        ANTLRInputStream input(source);
+        qasmcpp::QASM2Lexer lexer(&input);
+        CommonTokenStream tokens(&lexer);
+        qasmcpp::QASM2Parser parser(&tokens);
+        tree::ParseTree *tree = parser.main();
+
+        QASM2Visitor visitor;
+        visitor.visit(tree);
+        benchmark::DoNotOptimize(visitor.getProgram());
+    }
+    setThroughput(state, source.size(), countStatements(source));
+}
+BENCHMARK_CAPTURE(BM_GeneratedWorkload, clifford_t, std::string("clifford_t"), 32, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_GeneratedWorkload, qft, std::string("qft"), 64, 10)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_GeneratedWorkload, adder, std::string("adder"), 256, 10)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_GeneratedWorkload, vqe, std::string("vqe"), 32, 1000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_GeneratedWorkload, nested, std::string("nested"), 32, 10000)->Unit(benchmark::kMillisecond);
+
+// Streaming resource estimate of a generated workload, no AST is built
+static void BM_EstimateResources(benchmark::State &state, const std::string &kind, int qubits, int64_t size)
+{
+    std::ostringstream out;
+    CircuitGenerator generator(1, false);
+    generator.generate(out, kind, qubits, size);
+    std::string source = out.str();
+
+    for (auto _ : state)
+    {
+        ResourceEstimator estimator;
+        benchmark::DoNotOptimize(estimator.estimateString(source));
+    }
+    setThroughput(state, source.size(), countStatements(source));
+}
+BENCHMARK_CAPTURE(BM_EstimateResources, clifford_t, std::string("clifford_t"), 32, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EstimateResources, nested, std::string("nested"), 32, 10000)->Unit(benchmark::kMillisecond);
+
+// Validation of a generated file with every error collected in a sink, no AST
+static void BM_Validate(benchmark::State &state, const std::string &kind, int qubits, int64_t size)
+{
+    std::ostringstream out;
+    CircuitGenerator generator(1, false);
+    generator.generate(out, kind, qubits, size);
+    std::string source = out.str();
+
+    for (auto _ : state)
+    {
+        DiagnosticSink sink;
+        Validator validator(sink);
+        benchmark::DoNotOptimize(validator.validateString(source));
+    }
+    setThroughput(state, source.size(), countStatements(source));
+}
+BENCHMARK_CAPTURE(BM_Validate, clifford_t, std::string("clifford_t"), 32, 100000)->Unit(benchmark::kMillisecond);
+
+// Structural fingerprint of a parsed workload, the parse is not timed
+static void BM_Fingerprint(benchmark::State &state, const std::string &kind, int qubits, int64_t size)
+{
+    std::ostringstream out;
+    CircuitGenerator generator(1, false);
+    generator.generate(out, kind, qubits, size);
+    std::string source = out.str();
+
+    QASM2Driver driver;
+    auto program = driver.parseString(source);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(fingerprint(*program, driver.getSymbolTable()).hash);
+    }
+    setThroughput(state, source.size(), countStatements(source));
+}
+BENCHMARK_CAPTURE(BM_Fingerprint, clifford_t, std::string("clifford_t"), 32, 100000)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_Fingerprint, nested, std::string("nested"), 32, 10000)->Unit(benchmark::kMillisecond);
+
+// Latency of one small request on a warm compile server
+static void BM_ServerRequest(benchmark::State &state, const std::string &command)
+{
+    const std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg c[3];\n"
+                               "h q[0];\ncx q[0], q[1];\nccx q[0], q[1], q[2];\nmeasure q -> c;\n";
+    CompileServer server;
+    std::string response;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(server.handle(command, source, response));
+    }
+}
+BENCHMARK_CAPTURE(BM_ServerRequest, parse, std::string("parse"))->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_ServerRequest, resources, std::string("resources"))->Unit(benchmark::kMicrosecond);
+
+// Batch of small circuits sharing qelib1.inc through a base symbol table
+static void BM_BatchParse(benchmark::State &state)
+{
+    const int circuits = static_cast<int>(state.range(0));
+    std::vector<std::string> sources(circuits, "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg c[3];\n"
+                                               "h q[0];\ncx q[0], q[1];\nccx q[0], q[1], q[2];\nmeasure q -> c;\n");
+    BatchParser batch(BatchParser::makeBase("OPENQASM 2.0;\ninclude \"qelib1.inc\";"));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(batch.parse(sources));
+    }
+    state.counters["circuits/s"] = benchmark::Counter(circuits, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_BatchParse)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Binding the angles of a parametric ansatz: a layer of ry(t_i) on every qubit and a CX chain,
+// rebound in place (arg 1) or copied from the template (arg 0)
+static void BM_TemplateBind(benchmark::State &state)
+{
+    const int qubits = 16;
+    const int layers = 64;
+    std::ostringstream source;
+    source << "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[" << qubits << "];\n";
+    std::vector<std::string> params;
+    for (int layer = 0; layer < layers; ++layer)
+    {
+        for (int q = 0; q < qubits; ++q)
+        {
+            params.push_back("t" + std::to_string(params.size()));
+            source << "ry(" << params.back() << ") q[" << q << "];\n";
+        }
+        for (int q = 0; q + 1 < qubits; ++q)
+        {
+            source << "cx q[" << q << "], q[" << q + 1 << "];\n";
+        }
+    }
+
+    QASM2Driver driver;
+    auto program = driver.parseString(source.str());
+    CircuitTemplate circuitTemplate(*program, driver.getSymbolTable(), params);
+    std::vector<double> values(params.size());
+    Circuit circuit = circuitTemplate.bind(values);
+    for (auto _ : state)
+    {
+        values[0] += 0.001;
+        if (state.range(0) == 1)
+            circuitTemplate.rebind(values, circuit);
+        else
+            circuit = circuitTemplate.bind(values);
+        benchmark::DoNotOptimize(circuit.instructions.data());
+    }
+    state.counters["slots"] = static_cast<double>(circuitTemplate.getNumSlots());
+    state.counters["binds/s"] = benchmark::Counter(1, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_TemplateBind)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Transpilation of a lowered Clifford+T+rotation circuit to rz, sx, cx; the qubits form
+// four independent blocks of 8
+static void BM_Transpile(benchmark::State &state)
+{
+    const int qubits = 32;
+    const int64_t gates = state.range(0);
+    Circuit circuit;
+    circuit.numQubits = qubits;
+    circuit.qregs.push_back(RegisterLayout{"q", 0, qubits});
+    const int matrices[] = {circuit.matrices.intern(M_PI / 2, 0, M_PI), circuit.matrices.intern(0, 0, M_PI / 4),
+                            circuit.matrices.intern(0.3, -0.2, 0.1)};
+    for (int64_t i = 0; i < gates; ++i)
+    {
+        int q = static_cast<int>(i % qubits);
+        if (i % 3 == 2)
+        {
+            Instruction cx{Instruction::CX, {q, q / 8 * 8 + (q + 1) % 8}, -1, -1, {0, 0, 0}};
+            circuit.instructions.push_back(cx);
+        }
+        else
+        {
+            Instruction u{Instruction::U, {q, -1}, -1, matrices[i % 3 == 0 ? (i / 3) % 3 : 1], {0, 0, 0}};
+            circuit.instructions.push_back(u);
+        }
+    }
+
+    auto basis = Basis::get({"rz", "sx", "cx"});
+    TranspileStats stats;
+    for (auto _ : state)
+    {
+        stats = TranspileStats();
+        TranspiledCircuit transpiled = transpile(circuit, basis, &stats);
+        benchmark::DoNotOptimize(transpiled.ops.data());
+    }
+    state.counters["blocks"] = static_cast<double>(stats.blocks);
+    state.counters["out gates"] = static_cast<double>(stats.outputGates);
+    state.counters["gates/s"] = benchmark::Counter(static_cast<double>(gates), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_Transpile)->Arg(1000000)->Arg(10000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Register declaration: symbol table insertion of registers with per-bit storage
+static void BM_RegisterDecl(benchmark::State &state)
+{
+    const int registers = static_cast<int>(state.range(0));
+    const int size = 64;
+    std::vector<std::string> names;
+    for (int i = 0; i < registers; ++i)
+    {
+        names.push_back("r" + std::to_string(i));
+    }
+
+    for (auto _ : state)
+    {
+        SymbolTable symbolTable;
+        for (int i = 0; i < registers; ++i)
+        {
+            if (i % 2 == 0)
+                symbolTable.addQubitRegister(names[i], size);
+            else
+                symbolTable.addCbitRegister(names[i], size);
+        }
+        benchmark::DoNotOptimize(symbolTable.qubitRegisters.size());
+    }
+    state.counters["stmts/s"] = benchmark::Counter(registers, benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_RegisterDecl)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+// Statevector execution of a wide, shallow circuit: 10 layers of u3 on every qubit
+// and a CX brickwork, with layered sweeps (arg 1) or one sweep per gate (arg 0)
+static void BM_SimulateLayers(benchmark::State &state)
+{
+    const int qubits = static_cast<int>(state.range(0));
+    Circuit circuit;
+    circuit.numQubits = qubits;
+    for (int layer = 0; layer < 10; ++layer)
+    {
+        for (int q = 0; q < qubits; ++q)
+        {
+            Instruction u{Instruction::U, {q, -1}, -1, circuit.matrices.intern(0.1 * q, 0.2 * layer, 0.3), {0.1 * q, 0.2 * layer, 0.3}};
+            circuit.instructions.push_back(u);
+        }
+        for (int q = layer % 2; q + 1 < qubits; q += 2)
+        {
+            Instruction cx{Instruction::CX, {q, q + 1}, -1, -1, {0, 0, 0}};
+            circuit.instructions.push_back(cx);
+        }
+    }
+
+    std::vector<Layer> layers = scheduleLayers(circuit);
+    if (state.range(1) == 0)
+    {
+        layers.clear();
+        for (size_t i = 0; i < circuit.instructions.size(); ++i)
+        {
+            layers.push_back(Layer{i, i + 1, true});
+        }
+    }
+
+    StatevectorSimulator simulator(qubits);
+    std::vector<int> cbits;
+    for (auto _ : state)
+    {
+        simulator.run(circuit, layers, cbits);
+        benchmark::DoNotOptimize(simulator.getState().data());
+    }
+    state.counters["layers"] = static_cast<double>(layers.size());
+    state.counters["gates/s"] = benchmark::Counter(static_cast<double>(circuit.instructions.size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_SimulateLayers)->ArgsProduct({{16, 20, 24}, {0, 1}})->Unit(benchmark::kMillisecond);
+
+// Noisy trajectories of a 12-qubit brickwork circuit under depolarizing and
+// readout errors, 256 trajectories per iteration split between the threads
+static void BM_NoisyTrajectories(benchmark::State &state)
+{
+    const int qubits = 12;
+    Circuit circuit;
+    circuit.numQubits = qubits;
+    circuit.numCbits = qubits;
+    circuit.qregs.push_back(RegisterLayout{"q", 0, qubits});
+    circuit.cregs.push_back(RegisterLayout{"c", 0, qubits});
+    for (int layer = 0; layer < 10; ++layer)
+    {
+        for (int q = 0; q < qubits; ++q)
+        {
+            Instruction u{Instruction::U, {q, -1}, -1, circuit.matrices.intern(0.1 * q, 0.2 * layer, 0.3), {0.1 * q, 0.2 * layer, 0.3}};
+            circuit.instructions.push_back(u);
+        }
+        for (int q = layer % 2; q + 1 < qubits; q += 2)
+        {
+            Instruction cx{Instruction::CX, {q, q + 1}, -1, -1, {0, 0, 0}};
+            circuit.instructions.push_back(cx);
+        }
+    }
+    for (int q = 0; q < qubits; ++q)
+    {
+        Instruction measure{Instruction::MEASURE, {q, -1}, q, -1, {0, 0, 0}};
+        circuit.instructions.push_back(measure);
+    }
+
+    NoiseModel noise = NoiseModel::parse("depolarizing=0.001,depolarizing2=0.01,readout=0.02");
+    SimOptions options;
+    options.shots = 256;
+    for (auto _ : state)
+    {
+        SimResult result = simulateNoisy(circuit, noise, options);
+        benchmark::DoNotOptimize(result.counts.size());
+        options.seed++;
+    }
+    state.counters["trajectories/s"] = benchmark::Counter(static_cast<double>(options.shots), benchmark::Counter::kIsIterationInvariantRate);
+}
+BENCHMARK(BM_NoisyTrajectories)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -130,9 +130,13 @@ unaryop returns [ExprNode::UnaryOpType opType]
   | SQRT    { $opType = ExprNode::UnaryOpType::SQRT; }
   ;
 
-catch [...] {
-  // Replaces the standard exception handling.
-  
+catch [RecognitionException &e] {
+  // Belongs to unaryop alone, the other rules keep the default handling.
+  // Reports the error and resynchronizes like that default, instead of
+  // dropping a bad unary operator without a syntax error.
+  _errHandler->reportError(this, e);
+  _localctx->exception = std::current_exception();
+  _errHandler->recover(this, _localctx->exception);
 }
 finally {
 
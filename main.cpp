@@ -1,58 +1,322 @@
 #include <iostream>
 #include <fstream>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
 #include <antlr4-runtime.h>
 #include "QASM2Parser.h"
 #include "QASM2Lexer.h"
+#include "Driver.h"
 #include "Visitor.h"
 #include "AST.h"
+#include "Lowering.h"
+#include "Simulator.h"
+#include "Resources.h"
+#include "Validator.h"
+#include "Server.h"
+#include "Warmup.h"
+#include "StreamingParser.h"
+#include "Transpiler.h"
+#include "Fingerprint.h"
+#include "Noise.h"
 
+#ifdef BUILD_QPLAYER
 #include "qplayer.h"
+#endif
 
 using namespace std;
 using namespace qasmcpp;
 using namespace antlr4;
 
-int main(int argc, const char* argv[]) {
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--stats[=json] [--profile]] [--resources[=json]] [--validate] [--single-pass] [--simulate [--shots N] [--seed N] [--noise=MODEL]] <path-to-qasm>" << std::endl;
+    std::cerr << "       " << program << " --transpile=GATES [--stats[=json]] <path-to-qasm>" << std::endl;
+    std::cerr << "       " << program << " --fingerprint [--single-pass] <path-to-qasm>" << std::endl;
+    std::cerr << "       " << program << " --stream [--stats[=json]] <path-to-qasm>" << std::endl;
+    std::cerr << "       " << program << " --serve[=SOCKET]" << std::endl;
+    std::cerr << "       " << program << " --write-snapshot=OUT <path-to-workload>" << std::endl;
+    std::cerr << "Any mode accepts --snapshot=PATH, default qasm2.snapshot next to the binary." << std::endl;
+}
+
+// The warmup snapshot is looked up next to the binary unless given explicitly.
+// argv[0] has no directory when the binary is found through PATH, so the
+// binary is located through /proc/self/exe; empty if it cannot be found.
+static std::string defaultSnapshotPath(const char* program) {
+    std::string path;
+    char buffer[4096];
+    ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer) - 1);
+    if (length > 0) {
+        path.assign(buffer, static_cast<size_t>(length));
+    } else if (std::strchr(program, '/') != nullptr) {
+        path = program;
+    } else {
+        return std::string();
+    }
+    return path.substr(0, path.rfind('/') + 1) + "qasm2.snapshot";
+}
 
+// Parses a non-negative decimal count, false unless the whole text is one
+static bool parseCount(const char* text, unsigned long long& value) {
+    if (*text < '0' || *text > '9') {
+        return false;
+    }
+    char* end;
+    errno = 0;
+    value = std::strtoull(text, &end, 10);
+    return errno == 0 && *end == '\0';
+}
 
+int main(int argc, const char* argv[]) {
+
+#ifdef BUILD_QPLAYER
     // This is a test if QPlayer works
     QRegister QReg = new QRegister(12);
     cout << "QReg: " << QReg.getNumQubits() << endl;
+#endif
+
+    enum { STATS_NONE, STATS_TEXT, STATS_JSON } statsMode = STATS_NONE;
+    enum { RESOURCES_NONE, RESOURCES_TEXT, RESOURCES_JSON } resourcesMode = RESOURCES_NONE;
+    const char* filePath = nullptr;
+    bool validateOnly = false;
+    bool singlePass = false;
+    bool profilePredictions = false;
+    bool streamMode = false;
+    bool serveMode = false;
+    const char* socketPath = nullptr;
+    const char* snapshotPath = nullptr;
+    const char* writeSnapshotPath = nullptr;
+    bool simulateCircuit = false;
+    SimOptions simOptions;
+    NoiseModel noiseModel;
+    const char* transpileBasis = nullptr;
+    bool printFingerprint = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--stats") == 0) {
+            statsMode = STATS_TEXT;
+        } else if (std::strcmp(argv[i], "--stats=json") == 0) {
+            statsMode = STATS_JSON;
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            profilePredictions = true;
+        } else if (std::strcmp(argv[i], "--resources") == 0) {
+            resourcesMode = RESOURCES_TEXT;
+        } else if (std::strcmp(argv[i], "--resources=json") == 0) {
+            resourcesMode = RESOURCES_JSON;
+        } else if (std::strcmp(argv[i], "--serve") == 0) {
+            serveMode = true;
+        } else if (std::strncmp(argv[i], "--serve=", 8) == 0) {
+            serveMode = true;
+            socketPath = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--snapshot=", 11) == 0) {
+            snapshotPath = argv[i] + 11;
+        } else if (std::strncmp(argv[i], "--write-snapshot=", 17) == 0) {
+            writeSnapshotPath = argv[i] + 17;
+        } else if (std::strcmp(argv[i], "--validate") == 0) {
+            validateOnly = true;
+        } else if (std::strcmp(argv[i], "--stream") == 0) {
+            streamMode = true;
+        } else if (std::strcmp(argv[i], "--single-pass") == 0) {
+            singlePass = true;
+        } else if (std::strcmp(argv[i], "--simulate") == 0) {
+            simulateCircuit = true;
+        } else if (std::strncmp(argv[i], "--noise=", 8) == 0) {
+            try {
+                noiseModel = NoiseModel::parse(argv[i] + 8);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--fingerprint") == 0) {
+            printFingerprint = true;
+        } else if (std::strncmp(argv[i], "--transpile=", 12) == 0) {
+            transpileBasis = argv[i] + 12;
+        } else if ((std::strcmp(argv[i], "--shots") == 0 || std::strcmp(argv[i], "--seed") == 0) && hasValue) {
+            unsigned long long value;
+            if (!parseCount(argv[i + 1], value)) {
+                std::cerr << "Invalid value for " << argv[i] << ": " << argv[i + 1] << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            if (std::strcmp(argv[i], "--shots") == 0) {
+                simOptions.shots = static_cast<size_t>(value);
+            } else {
+                simOptions.seed = value;
+            }
+            ++i;
+        } else if (filePath == nullptr && argv[i][0] != '-') {
+            filePath = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
 
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <path-to-qasm>" << std::endl;
+    // the snapshot is written from a cold parser, so it keeps every statement that adds prediction states
+    if (writeSnapshotPath != nullptr) {
+        if (filePath == nullptr) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        try {
+            std::ifstream workload(filePath);
+            if (!workload.is_open()) {
+                throw std::runtime_error("Could not open file: " + std::string(filePath));
+            }
+            std::ofstream snapshot(writeSnapshotPath);
+            size_t kept = warmup::writeSnapshot(workload, snapshot);
+            std::cerr << "Kept " << kept << " statements, " << warmup::dfaStateCount() << " DFA states" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // replaying the snapshot builds the prediction DFAs before the first real parse
+    try {
+        if (snapshotPath != nullptr) {
+            if (!warmup::replayFile(snapshotPath)) {
+                throw std::runtime_error("Could not open snapshot: " + std::string(snapshotPath));
+            }
+        } else {
+            std::string defaultPath = defaultSnapshotPath(argv[0]);
+            if (!defaultPath.empty()) {
+                warmup::replayFile(defaultPath);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
         return 1;
     }
 
-    const char* filePath = argv[1];
-    
-    // Open the input file
-    std::ifstream stream;
-    stream.open(filePath);
-    
-    if (!stream.is_open()) {
-        std::cerr << "Could not open file: " << filePath << std::endl;
+    // the server keeps the parser warm and answers framed requests until quit
+    if (serveMode) {
+        try {
+            CompileServer server;
+            if (socketPath != nullptr) {
+                server.serveSocket(socketPath);
+            } else {
+                std::ios::sync_with_stdio(false);
+                server.serve(std::cin, std::cout);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (filePath == nullptr) {
+        printUsage(argv[0]);
         return 1;
     }
 
-    ANTLRInputStream input(stream);
-    qasmcpp::QASM2Lexer lexer(&input);
-    CommonTokenStream tokens(&lexer);
+    // the resource estimate streams the file and never builds the AST
+    if (resourcesMode != RESOURCES_NONE) {
+        try {
+            ResourceEstimator estimator;
+            ResourceCounts resources = estimator.estimateFile(filePath);
+            if (resourcesMode == RESOURCES_JSON) {
+                resources.printJson(std::cout);
+            } else {
+                resources.print(std::cout);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
-    tokens.fill();
+    // validation reports every error of the file instead of stopping at the first
+    if (validateOnly) {
+        DiagnosticSink sink;
+        Validator validator(sink);
+        bool valid = validator.validateFile(filePath);
+        sink.print(std::cerr);
+        return valid ? 0 : 1;
+    }
 
-    qasmcpp::QASM2Parser parser(&tokens);
-    tree::ParseTree *tree = parser.main();
+    // streaming parses and prints one statement at a time, the program is never held whole
+    if (streamMode) {
+        if (simulateCircuit) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        ParseStats stats;
+        try {
+            std::ifstream stream(filePath);
+            if (!stream.is_open()) {
+                throw std::runtime_error("Could not open file: " + std::string(filePath));
+            }
+            PhaseTimer totalTimer(statsMode != STATS_NONE ? &stats.totalTime : nullptr);
+            StreamingParser parser(stream);
+            parser.setStats(statsMode != STATS_NONE ? &stats : nullptr);
+            std::shared_ptr<QASMNode> statement;
+            while (parser.next(statement)) {
+                statement->dump();
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        if (statsMode == STATS_TEXT) {
+            stats.print(std::cerr);
+        } else if (statsMode == STATS_JSON) {
+            stats.printJson(std::cerr);
+        }
+        return 0;
+    }
 
-    QASM2Visitor visitor;
-    visitor.visit(tree);
+    QASM2Driver driver;
+    driver.setCollectStats(statsMode != STATS_NONE);
+    driver.setProfilePredictions(profilePredictions);
+    driver.setSinglePass(singlePass);
+
+    std::shared_ptr<ProgramNode> program;
+    try {
+        program = driver.parseFile(filePath);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
 
-    auto program = visitor.getProgram();
+    // one line per file, so the output can key a cache from a shell script
+    if (printFingerprint) {
+        try {
+            std::cout << fingerprint(*program, driver.getSymbolTable()).toHex() << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
+    // the transpiled program is the only output, so it can be piped into the next tool
+    if (transpileBasis != nullptr) {
+        TranspileStats stats;
+        try {
+            auto basis = Basis::get(Basis::parseList(transpileBasis));
+            Lowering lowering(driver.getSymbolTable());
+            Circuit circuit = lowering.lower(*program);
+            transpile(circuit, basis, &stats).write(std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        if (statsMode == STATS_TEXT) {
+            stats.print(std::cerr);
+        } else if (statsMode == STATS_JSON) {
+            stats.printJson(std::cerr);
+        }
+        return 0;
+    }
 
-    auto gateDefines = visitor.getSymbolTable().gateDefines;
-    auto regDefines = visitor.getSymbolTable().qubitRegisters;
-    auto cregDefines = visitor.getSymbolTable().cbitRegisters;
+    auto gateDefines = driver.getSymbolTable().gateDefines;
+    auto regDefines = driver.getSymbolTable().qubitRegisters;
+    auto cregDefines = driver.getSymbolTable().cbitRegisters;
 
     for (const auto& gate : gateDefines) {
         std::cout << "GATE: " << gate.first << std::endl;
@@ -63,8 +327,32 @@ int main(int argc, const char* argv[]) {
     // }
 
 
-    // std::cout << tree->toStringTree(&parser) << std::endl;
-    std::cout << "FINISH PARSING\n";    
+    std::cout << "FINISH PARSING\n";
+
+    if (simulateCircuit) {
+        try {
+            Lowering lowering(driver.getSymbolTable());
+            Circuit circuit = lowering.lower(*program);
+            SimResult result = noiseModel.isIdeal() ? simulate(circuit, simOptions) : simulateNoisy(circuit, noiseModel, simOptions);
+            for (const auto& count : result.counts) {
+                std::cout << count.first << ": " << count.second << std::endl;
+            }
+            if (statsMode == STATS_TEXT) {
+                result.stats.print(std::cerr);
+            } else if (statsMode == STATS_JSON) {
+                result.stats.printJson(std::cerr);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // statistics go to stderr so the regular output stays unchanged
+    if (statsMode == STATS_TEXT) {
+        driver.getStats().print(std::cerr);
+    } else if (statsMode == STATS_JSON) {
+        driver.getStats().printJson(std::cerr);
+    }
     return 0;
 }
-
@@ -1,6 +1,7 @@
 #ifndef AST_H
 #define AST_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -14,6 +15,7 @@ namespace qasmcpp
     typedef std::string Identifier;
 
     class ExprNode;
+    class ExprPool;
 
     // Base class for all QASM nodes
     class QASMNode
@@ -82,6 +84,7 @@ namespace qasmcpp
     public:
         std::vector<std::shared_ptr<QASMNode>> statements;
         std::string version;
+        std::shared_ptr<ExprPool> exprPool; // shared expressions of the statements
         void dump() const override;
     };
 
@@ -188,9 +191,10 @@ namespace qasmcpp
     {
     public:
         Bit classicalRegister;
+        uint64_t value;
         std::shared_ptr<QASMNode> statement;
 
-        IfStmtNode(const Bit &classicalRegister, std::shared_ptr<QASMNode> statement);
+        IfStmtNode(const Bit &classicalRegister, uint64_t value, std::shared_ptr<QASMNode> statement);
         void dump() const override;
     };
 
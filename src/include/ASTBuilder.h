@@ -0,0 +1,132 @@
+#ifndef QASM_AST_BUILDER_H
+#define QASM_AST_BUILDER_H
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+#include <antlr4-runtime.h>
+#include "QASM2Parser.h"
+#include "AST.h"
+#include "Expr.h"
+#include "Stats.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @class ASTBuilder
+     * @brief Builds the AST from parser events while the source is parsed.
+     *
+     * The builder is attached to a parser as a parse listener and turns off
+     * parse tree construction, so rule contexts are not linked into a tree and
+     * no second pass over a tree is needed. Each rule hands its result to the
+     * enclosing one through small operand stacks as it exits: arguments,
+     * identifier lists and expressions are pushed, and statements pop them.
+     * Exit events of the left-recursive exp rule arrive in post-order, so a
+     * binary expression finds both operands on the stack.
+     *
+     * The result is the same program and symbol table as QASM2Visitor. A
+     * statement with a syntax error is left out, the error itself is reported
+     * by the error listeners of the parser.
+     */
+    class ASTBuilder : public antlr4::tree::ParseTreeListener
+    {
+    public:
+        ASTBuilder();
+
+        /**
+         * @brief Parses a program with the parse tree disabled and builds its AST.
+         *
+         * @param parser The parser over the tokens of the program.
+         * @return The program node.
+         * @throws std::runtime_error On a semantic error, e.g. a redefined register.
+         */
+        std::shared_ptr<ProgramNode> build(QASM2Parser &parser);
+
+        /**
+         * @brief Parses one top-level statement and builds its node.
+         *
+         * The node is returned instead of being added to the program, so a
+         * long stream of statements can be built and released one at a time.
+         * The version statement sets the version of the program.
+         *
+         * @param parser The parser over the tokens of one statement.
+         * @return The node, null for the version statement and a statement with a syntax error.
+         * @throws std::runtime_error On a semantic error, e.g. a redefined register.
+         */
+        std::shared_ptr<QASMNode> buildStatement(QASM2Parser &parser);
+
+        void enterEveryRule(antlr4::ParserRuleContext *ctx) override;
+        void exitEveryRule(antlr4::ParserRuleContext *ctx) override;
+        void visitTerminal(antlr4::tree::TerminalNode *node) override {}
+        void visitErrorNode(antlr4::tree::ErrorNode *node) override {}
+
+        // inline set methods
+        inline void setStats(ParseStats *parseStats) { stats = parseStats; }
+        inline void setUseBuiltinStdlib(bool enable) { useBuiltinStdlib = enable; }
+        inline void setBaseSymbolTable(const std::shared_ptr<const SymbolTable> &base) { symbolTable.base = base; }
+
+        // inline get methods
+        inline const std::shared_ptr<ProgramNode> &getProgram() const { return program; }
+        inline const SymbolTable &getSymbolTable() const { return symbolTable; }
+
+    private:
+        void exitVersion(QASM2Parser::VersionContext *ctx);
+        void exitInclude(QASM2Parser::IncludeDeclStmtContext *ctx);
+        void exitRegDecl(QASM2Parser::RegDeclStmtContext *ctx);
+        void exitGateDecl(QASM2Parser::GateDeclStmtContext *ctx);
+        void exitQop(QASM2Parser::QopStmtContext *ctx);
+        void exitIf(QASM2Parser::IfDeclStmtContext *ctx);
+        void exitBarrier(QASM2Parser::BarrierDeclStmtContext *ctx);
+        void exitUop(QASM2Parser::UopContext *ctx);
+        void exitArgument(QASM2Parser::ArgumentContext *ctx);
+        void exitIdList(QASM2Parser::IdListContext *ctx);
+        void exitExp(QASM2Parser::ExpContext *ctx);
+
+        // rethrows the error stored during the last parse
+        void rethrow();
+
+        // pops the top expression, null and the statement is malformed if there is none
+        std::shared_ptr<ExprNode> popExpr();
+
+        SymbolTable symbolTable;
+        std::shared_ptr<ProgramNode> program;
+        std::shared_ptr<ExprPool> exprPool = std::make_shared<ExprPool>();
+
+        // operands of the construct being built
+        std::vector<std::shared_ptr<ExprNode>> exprs;
+        std::vector<ExprNode::ArithOpType> arithOps;
+        std::vector<ExprNode::UnaryOpType> unaryOps;
+        std::vector<Bit> bits;
+        std::vector<std::vector<std::string>> idLists;
+        std::vector<std::shared_ptr<QASMNode>> gateBody;
+
+        // the node of the current statement, and the uop of the current qop
+        std::shared_ptr<QASMNode> statement;
+        std::shared_ptr<QASMNode> uop;
+
+        // buildStatement returns the statement instead of adding it to the program
+        bool keepStatements = true;
+        std::shared_ptr<QASMNode> completed;
+
+        bool inGate = false;
+        bool malformed = false;
+
+        // the first semantic error, rethrown by build once the parser returns,
+        // since exit events run in the scope guards of the generated rules
+        std::exception_ptr error;
+
+        // statements of included files only fill the symbol table
+        int includeDepth = 0;
+
+        // parse statistics, null when not collected
+        ParseStats *stats = nullptr;
+
+        // include "qelib1.inc" loads the built-in standard library
+        bool useBuiltinStdlib = true;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_AST_BUILDER_H
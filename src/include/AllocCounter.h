@@ -0,0 +1,80 @@
+#ifndef QASM_ALLOC_COUNTER_H
+#define QASM_ALLOC_COUNTER_H
+
+#include <cstddef>
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct AllocCounts
+     * @brief Number of heap allocations and bytes requested through operator new.
+     */
+    struct AllocCounts
+    {
+        size_t allocations = 0; /**< Number of calls to operator new. */
+        size_t bytes = 0;       /**< Bytes requested by those calls. */
+    };
+
+    /**
+     * @brief Allocation accounting shared by the counting operator new hooks.
+     *
+     * Counting is opt-in: the replaceable operator new and delete are defined
+     * in AllocHooks.cpp, which only targets that want accounting link in
+     * (run_test and run_bench). Without it every count stays zero.
+     */
+    namespace alloc
+    {
+        /**
+         * @brief Checks if the counting operator new hooks are linked in.
+         *
+         * @return True if allocations are being counted.
+         */
+        bool hooksInstalled();
+
+        /**
+         * @brief Returns the allocations made by the calling thread so far.
+         *
+         * @return The running allocation counts of the calling thread.
+         */
+        AllocCounts current();
+
+        // Called by the hooks: marks them installed and records an allocation
+        void installHooks();
+        void record(size_t bytes);
+    } // namespace alloc
+
+    /**
+     * @class AllocScope
+     * @brief Scoped counter that adds the allocations made by the calling thread
+     *        during its lifetime to a target.
+     *
+     * A null target disables the scope, mirroring PhaseTimer.
+     */
+    class AllocScope
+    {
+    public:
+        explicit AllocScope(AllocCounts *target) : target(target)
+        {
+            if (target != nullptr)
+                start = alloc::current();
+        }
+
+        ~AllocScope()
+        {
+            if (target != nullptr)
+            {
+                AllocCounts end = alloc::current();
+                target->allocations += end.allocations - start.allocations;
+                target->bytes += end.bytes - start.bytes;
+            }
+        }
+
+    private:
+        AllocCounts *target;
+        AllocCounts start;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_ALLOC_COUNTER_H
@@ -0,0 +1,85 @@
+#ifndef QASM_BATCH_H
+#define QASM_BATCH_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "AST.h"
+#include "SymbolTable.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct BatchResult
+     * @brief The outcome of one circuit of a batch.
+     */
+    struct BatchResult
+    {
+        bool ok = false;                      /**< True if the circuit parsed without errors. */
+        std::string error;                    /**< The first error, empty if ok. */
+        std::shared_ptr<ProgramNode> program; /**< The program, null if parsing threw. */
+        SymbolTable symbolTable;              /**< The own declarations, on top of the shared base. */
+    };
+
+    /**
+     * @class BatchParser
+     * @brief Parses many circuits concurrently against one shared symbol table.
+     *
+     * Circuits of a batch usually share their include set and many gate
+     * definitions. These are parsed once into a read-only base table, which
+     * every circuit of the batch sees through SymbolTable::base without a
+     * copy, so each circuit pays only for its own statements. An include
+     * already loaded into the base adds nothing.
+     *
+     * The circuits are spread over OpenMP threads with dynamic scheduling, so
+     * an idle thread takes the next circuit and long and short ones balance
+     * out; OMP_NUM_THREADS sets the number of threads. Without OpenMP they
+     * are parsed one after another.
+     */
+    class BatchParser
+    {
+    public:
+        /**
+         * @brief Constructs a batch parser.
+         *
+         * @param base The shared table, null for none.
+         */
+        explicit BatchParser(std::shared_ptr<const SymbolTable> base = nullptr);
+
+        /**
+         * @brief Parses the declarations shared by a batch into a base table.
+         *
+         * @param prelude A QASM2 program of include statements and gate definitions.
+         * @param useBuiltinStdlib False to read qelib1.inc from disk.
+         * @return The base table.
+         * @throws std::runtime_error If the prelude has an error.
+         */
+        static std::shared_ptr<const SymbolTable> makeBase(const std::string &prelude, bool useBuiltinStdlib = true);
+
+        /**
+         * @brief Parses a batch of circuits.
+         *
+         * An error in one circuit does not affect the others.
+         *
+         * @param sources The QASM2 sources of the circuits.
+         * @return One result per source, in the order of the sources.
+         */
+        std::vector<BatchResult> parse(const std::vector<std::string> &sources) const;
+
+        // inline set methods
+        inline void setSinglePass(bool enable) { singlePass = enable; }
+        inline void setUseBuiltinStdlib(bool enable) { useBuiltinStdlib = enable; }
+
+        // inline get methods
+        inline const std::shared_ptr<const SymbolTable> &getBase() const { return base; }
+
+    private:
+        std::shared_ptr<const SymbolTable> base;
+        bool singlePass = false;
+        bool useBuiltinStdlib = true;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_BATCH_H
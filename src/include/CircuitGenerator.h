@@ -0,0 +1,103 @@
+#ifndef QASM_CIRCUIT_GENERATOR_H
+#define QASM_CIRCUIT_GENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace qasmcpp
+{
+
+    /**
+     * @class CircuitGenerator
+     * @brief Writes synthetic QASM2 circuits of any size for workloads and benchmarks.
+     *
+     * Every circuit is streamed to the output as it is generated, so the size
+     * of a circuit is not limited by memory. The output only depends on the
+     * seed and the size arguments.
+     */
+    class CircuitGenerator
+    {
+    public:
+        /**
+         * @brief Constructs a generator.
+         *
+         * @param seed The seed of the pseudo random sequence.
+         * @param includeStdlib True to emit include "qelib1.inc" in the header.
+         */
+        explicit CircuitGenerator(uint64_t seed, bool includeStdlib = true);
+
+        /**
+         * @brief Writes random Clifford+T gates (h, s, sdg, t, tdg, x, cx).
+         *
+         * @param out The output stream.
+         * @param qubits The number of qubits.
+         * @param gates The number of gates.
+         */
+        void cliffordT(std::ostream &out, int qubits, int64_t gates);
+
+        /**
+         * @brief Writes the quantum Fourier transform, repeated to reach the gate count.
+         *
+         * @param out The output stream.
+         * @param qubits The number of qubits.
+         * @param repetitions The number of QFT blocks.
+         */
+        void qft(std::ostream &out, int qubits, int64_t repetitions = 1);
+
+        /**
+         * @brief Writes a ripple-carry adder of two registers with random inputs.
+         *
+         * @param out The output stream.
+         * @param width The width of each addend.
+         * @param repetitions The number of additions applied in sequence.
+         */
+        void adder(std::ostream &out, int width, int64_t repetitions = 1);
+
+        /**
+         * @brief Writes a layered VQE ansatz of parametric u3 rotations and CX chains.
+         *
+         * @param out The output stream.
+         * @param qubits The number of qubits.
+         * @param layers The number of ansatz layers.
+         */
+        void vqe(std::ostream &out, int qubits, int64_t layers);
+
+        /**
+         * @brief Writes a hierarchy of nested user gates and random applications of the top one.
+         *
+         * @param out The output stream.
+         * @param qubits The number of qubits.
+         * @param depth The nesting depth of the gate hierarchy.
+         * @param gates The number of applications of the top gate.
+         * @throws std::invalid_argument If there are fewer than 2 qubits.
+         */
+        void nested(std::ostream &out, int qubits, int depth, int64_t gates);
+
+        /**
+         * @brief Writes a circuit by kind name: clifford_t, qft, adder, vqe or nested.
+         *
+         * @param out The output stream.
+         * @param kind The kind of circuit.
+         * @param qubits The number of qubits (the addend width for adder).
+         * @param size The gates, repetitions or layers of the circuit.
+         * @param depth The nesting depth for nested circuits.
+         * @throws std::invalid_argument If the kind is unknown or nested gets fewer than 2 qubits.
+         */
+        void generate(std::ostream &out, const std::string &kind, int qubits, int64_t size, int depth = 4);
+
+    private:
+        uint64_t next();
+        int nextQubit(int qubits);
+        double nextAngle();
+
+        void writeHeader(std::ostream &out);
+        void writeMeasure(std::ostream &out, const std::string &qreg, const std::string &creg);
+
+        uint64_t state;
+        bool includeStdlib;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_CIRCUIT_GENERATOR_H
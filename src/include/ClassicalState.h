@@ -0,0 +1,86 @@
+#ifndef QASM_CLASSICAL_STATE_H
+#define QASM_CLASSICAL_STATE_H
+
+#include <cstdint>
+#include <vector>
+#include "Lowering.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @class ClassicalState
+     * @brief The classical bits of one shot, packed into 64-bit words.
+     *
+     * The words follow the layout of Condition: each creg starts a new word,
+     * so testing the condition of an if statement on a creg of up to 64 bits
+     * is a single integer compare, and writing a measured bit is a masked
+     * word update without branches.
+     */
+    class ClassicalState
+    {
+    public:
+        /**
+         * @brief Constructs the all-zero state of the cregs of a circuit.
+         *
+         * @param circuit The circuit that defines the classical registers.
+         */
+        explicit ClassicalState(const Circuit &circuit);
+
+        /**
+         * @brief Sets every bit back to 0.
+         */
+        void clear();
+
+        /**
+         * @brief Writes a bit, given by its global cbit index.
+         */
+        inline void set(int cbit, int value)
+        {
+            uint64_t &word = words[wordOf[cbit]];
+            const int shift = shiftOf[cbit];
+            word = (word & ~(uint64_t(1) << shift)) | (uint64_t(value & 1) << shift);
+        }
+
+        /**
+         * @brief Reads a bit, given by its global cbit index.
+         */
+        inline int get(int cbit) const { return static_cast<int>(words[wordOf[cbit]] >> shiftOf[cbit] & 1); }
+
+        /**
+         * @brief Checks if the creg of a condition equals its value.
+         */
+        inline bool test(const Condition &condition) const
+        {
+            const uint64_t *creg = words.data() + condition.word;
+            uint64_t diff = condition.numWords > 0 ? creg[0] ^ condition.value : condition.value;
+            for (int i = 1; i < condition.numWords; ++i)
+            {
+                diff |= creg[i];
+            }
+            return diff == 0;
+        }
+
+        /**
+         * @brief Unpacks the state to one int per global cbit index.
+         *
+         * @param cbits Set to the classical bits.
+         */
+        void toBits(std::vector<int> &cbits) const;
+
+        // inline set methods
+        inline void setWords(const std::vector<uint64_t> &packed) { words = packed; }
+
+        // inline get methods
+        // the packed words, equal states have equal words
+        inline const std::vector<uint64_t> &getWords() const { return words; }
+
+    private:
+        std::vector<uint64_t> words;
+        std::vector<int> wordOf;
+        std::vector<int> shiftOf;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_CLASSICAL_STATE_H
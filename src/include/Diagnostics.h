@@ -0,0 +1,89 @@
+#ifndef QASM_DIAGNOSTICS_H
+#define QASM_DIAGNOSTICS_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace qasmcpp
+{
+
+    /**
+     * @brief Kinds of errors found in QASM2 source.
+     */
+    enum class DiagCode
+    {
+        SyntaxError,          /**< The source does not match the grammar. */
+        UnsupportedVersion,   /**< The OPENQASM version is not 2.x. */
+        IncludeNotFound,      /**< An included file cannot be opened. */
+        IncludeTooDeep,       /**< Includes nest too deeply, usually an include cycle. */
+        DuplicateRegister,    /**< A register name is declared twice. */
+        DuplicateGate,        /**< A gate name is defined twice. */
+        DuplicateArgument,    /**< A gate declares a parameter or qubit name twice. */
+        InvalidSize,          /**< A register size is zero or too large. */
+        UndefinedRegister,    /**< A register is used before it is declared. */
+        UndefinedGate,        /**< A gate is applied before it is defined. */
+        UndefinedIdentifier,  /**< A gate body uses an unknown qubit or parameter. */
+        WrongRegisterKind,    /**< A creg is used as a qreg or the other way around. */
+        IndexOutOfRange,      /**< A register index is past the register size. */
+        WrongArgumentCount,   /**< A gate is applied with the wrong number of arguments. */
+        RegisterSizeMismatch, /**< Register arguments of one statement differ in size. */
+        DuplicateQubit,       /**< A gate is applied to the same qubit twice. */
+        ValueOutOfRange,      /**< An if condition does not fit the creg. */
+    };
+
+    /**
+     * @struct Diagnostic
+     * @brief One error with its source location.
+     */
+    struct Diagnostic
+    {
+        DiagCode code;       /**< Kind of error. */
+        std::string source;  /**< File name, or "<input>" for source in memory. */
+        size_t line;         /**< Line, starting at 1. */
+        size_t column;       /**< Column, starting at 1. */
+        std::string message; /**< Description of the error. */
+    };
+
+    /**
+     * @class DiagnosticSink
+     * @brief Collects diagnostics instead of throwing on the first error.
+     */
+    class DiagnosticSink
+    {
+    public:
+        /**
+         * @brief Records a diagnostic.
+         */
+        void report(DiagCode code, const std::string &source, size_t line, size_t column, const std::string &message);
+
+        /**
+         * @brief Removes every diagnostic.
+         */
+        inline void clear() { diagnostics.clear(); }
+
+        /**
+         * @brief Prints each diagnostic as "source:line:column: error: message [code]".
+         *
+         * @param out The output stream.
+         */
+        void print(std::ostream &out) const;
+
+        /**
+         * @brief Returns the stable name of a code, e.g. "undefined-gate".
+         */
+        static const char *codeName(DiagCode code);
+
+        // inline get methods
+        inline bool hasErrors() const { return !diagnostics.empty(); }
+        inline size_t getErrorCount() const { return diagnostics.size(); }
+        inline const std::vector<Diagnostic> &getDiagnostics() const { return diagnostics; }
+
+    private:
+        std::vector<Diagnostic> diagnostics;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_DIAGNOSTICS_H
@@ -0,0 +1,123 @@
+#ifndef QASM_DRIVER_H
+#define QASM_DRIVER_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include "AST.h"
+#include "Stats.h"
+#include "SymbolTable.h"
+
+namespace antlr4
+{
+    class ANTLRInputStream;
+}
+
+namespace qasmcpp
+{
+
+    /**
+     * @class QASM2Driver
+     * @brief Runs the lexer, parser and visitor over a QASM2 source.
+     *
+     * The driver owns the symbol table of the last parse and, when enabled,
+     * collects per-phase statistics about it.
+     */
+    class QASM2Driver
+    {
+    public:
+        /**
+         * @brief Parses a QASM2 file.
+         *
+         * @param path The path of the file.
+         * @return The program node of the parsed file.
+         */
+        std::shared_ptr<ProgramNode> parseFile(const std::string &path);
+
+        /**
+         * @brief Parses QASM2 source code held in memory.
+         *
+         * @param source The QASM2 source code.
+         * @return The program node of the parsed source.
+         */
+        std::shared_ptr<ProgramNode> parseString(const std::string &source);
+
+        /**
+         * @brief Enables or disables collection of parse statistics.
+         *
+         * @param enable True to collect statistics on the following parses.
+         */
+        inline void setCollectStats(bool enable) { collectStats = enable; }
+
+        /**
+         * @brief Enables or disables counting of SLL predictions and LL fallbacks.
+         *
+         * The counts come from ANTLR's profiling simulator, which wraps every
+         * prediction, so the parse time of a profiled parse is not that of a
+         * plain one. Only used while statistics are collected.
+         *
+         * @param enable True to profile the predictions of the following parses.
+         */
+        inline void setProfilePredictions(bool enable) { profilePredictions = enable; }
+
+        /**
+         * @brief Keeps the syntax errors of the following parses instead of printing them.
+         *
+         * @param enable True to collect the lexer and parser errors of the
+         *               source in getSyntaxErrorMessages(), false to print
+         *               them to the console (default).
+         */
+        inline void setCollectSyntaxErrors(bool enable) { collectSyntaxErrors = enable; }
+
+        /**
+         * @brief Selects how include "qelib1.inc" is resolved.
+         *
+         * @param enable True to load the built-in standard library (default),
+         *               false to read and parse the file from disk.
+         */
+        inline void setUseBuiltinStdlib(bool enable) { useBuiltinStdlib = enable; }
+
+        /**
+         * @brief Selects how the AST is built.
+         *
+         * @param enable True to build the AST from parser events without a
+         *               parse tree, false to visit the parse tree (default).
+         */
+        inline void setSinglePass(bool enable) { singlePass = enable; }
+
+        /**
+         * @brief Sets a read-only symbol table shared with other parses.
+         *
+         * Its gates and include files are visible to the parsed program and
+         * are not copied; the own declarations go into getSymbolTable().
+         *
+         * @param base The shared table, null for none.
+         */
+        inline void setBaseSymbolTable(const std::shared_ptr<const SymbolTable> &base) { baseSymbolTable = base; }
+
+        // inline get methods
+        inline const ParseStats &getStats() const { return stats; }
+        inline const SymbolTable &getSymbolTable() const { return symbolTable; }
+        // syntax errors reported by the parser of the last parse
+        inline size_t getSyntaxErrors() const { return syntaxErrors; }
+        // "line:column message" of each lexer and parser error of the last parse, when collected
+        inline const std::vector<std::string> &getSyntaxErrorMessages() const { return syntaxErrorMessages; }
+
+    private:
+        std::shared_ptr<ProgramNode> parse(antlr4::ANTLRInputStream &input, size_t bytes);
+
+        bool collectStats = false;
+        bool profilePredictions = false;
+        bool collectSyntaxErrors = false;
+        bool useBuiltinStdlib = true;
+        bool singlePass = false;
+        std::shared_ptr<const SymbolTable> baseSymbolTable;
+        size_t syntaxErrors = 0;
+        std::vector<std::string> syntaxErrorMessages;
+        ParseStats stats;
+        SymbolTable symbolTable;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_DRIVER_H
@@ -1,15 +1,19 @@
 #ifndef EXPRESSION_NODE_H
 #define EXPRESSION_NODE_H
 
+#include <cstdint>
 #include <string>
 #include <iostream>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 #include "AST.h"
 
 namespace qasmcpp
 {
 
     class QASMNode;
+    class ExprPool;
 
     // Base class for all QASM nodes
     class ExprNode : public QASMNode
@@ -53,6 +57,11 @@ namespace qasmcpp
         virtual int getExpType() const { return EXPR; };
 
         void dump() const { /* Need to implement */ };
+
+        // set by the ExprPool that owns the node, left as is for nodes built directly
+        const ExprPool *pool = nullptr; /**< Pool that owns the node. */
+        int id = -1;                    /**< Id of the node in its pool. */
+        bool constant = false;          /**< True if the pooled node uses no identifier. */
     };
 
     // Numeric literal expressions
@@ -119,5 +128,166 @@ namespace qasmcpp
         int getOp() const { return op; }
     };
 
+    /**
+     * @class ExprPool
+     * @brief Hash-consing store of expressions.
+     *
+     * Structurally identical expressions are built once and shared, so
+     * "pi/2" used by a thousand gates is a single node. Each pooled node has
+     * a dense id, assigned in creation order and never reused, that the
+     * ExprEvaluator uses to memoize results. Children of a pooled node are
+     * always pooled in the same pool, so a key is the node type, its
+     * operator or value and the ids of its children.
+     */
+    class ExprPool
+    {
+    public:
+        // return the shared node of a literal, identifier or operation, built on first use
+        std::shared_ptr<ExprNode> integer(int value);
+        std::shared_ptr<ExprNode> real(double value);
+        std::shared_ptr<ExprNode> identifier(const std::string &name);
+        std::shared_ptr<ExprNode> unary(int op, const std::shared_ptr<ExprNode> &operand);
+        std::shared_ptr<ExprNode> binary(int op, const std::shared_ptr<ExprNode> &left, const std::shared_ptr<ExprNode> &right);
+
+        /**
+         * @brief Returns the pooled node of an expression built outside of the pool.
+         *
+         * @param expr The expression, which may already belong to this pool.
+         * @return The shared node with the same structure.
+         */
+        std::shared_ptr<ExprNode> intern(const std::shared_ptr<ExprNode> &expr);
+
+        // inline get methods
+        inline size_t size() const { return nodes.size(); }
+        inline const std::shared_ptr<ExprNode> &get(int id) const { return nodes[id]; }
+        // number of requests answered with an existing node
+        inline size_t getReuses() const { return reuses; }
+
+    private:
+        std::shared_ptr<ExprNode> add(std::string key, std::shared_ptr<ExprNode> node, bool constant);
+        int childId(const std::shared_ptr<ExprNode> &child);
+
+        std::vector<std::shared_ptr<ExprNode>> nodes;
+        std::unordered_map<std::string, int> index;
+        size_t reuses = 0;
+    };
+
+    /**
+     * @class ExprTape
+     * @brief Straight-line program of the expressions that depend on free parameters.
+     *
+     * The first nodes are the free parameters and every other node refers to
+     * earlier nodes by index, so one pass from front to back computes all of
+     * them without identifier lookups or any string work.
+     */
+    class ExprTape
+    {
+    public:
+        /**
+         * @brief Constructs a tape whose first nodes are the parameters.
+         *
+         * @param numParams The number of free parameters.
+         */
+        explicit ExprTape(size_t numParams = 0);
+
+        // append a node and return its index
+        int constant(double value);
+        int unary(int op, int operand);
+        int binary(int op, int left, int right);
+
+        /**
+         * @brief Computes every node of the tape.
+         *
+         * @param params The values of the free parameters.
+         * @param values Set to the value of each node.
+         */
+        void evaluate(const std::vector<double> &params, std::vector<double> &values) const;
+
+        // inline get methods
+        inline size_t size() const { return nodes.size(); }
+        inline size_t getNumParams() const { return numParams; }
+
+    private:
+        struct Node
+        {
+            int type; // one of ExprNode's types, ID for a parameter
+            int op;
+            int left;
+            int right;
+            double value;
+        };
+
+        std::vector<Node> nodes;
+        size_t numParams;
+    };
+
+    /**
+     * @class ExprEvaluator
+     * @brief Evaluates expressions with results memoized per pooled node and binding.
+     *
+     * A binding is the list of parameter values of a gate application. The
+     * result of a pooled node is computed once per binding, and once overall
+     * if the node is constant, so a shared subexpression such as "lambda+phi"
+     * is evaluated once no matter how often it occurs. Nodes that are not
+     * pooled are evaluated directly.
+     */
+    class ExprEvaluator
+    {
+    public:
+        /**
+         * @brief Sets the parameters for the following evaluations.
+         *
+         * Binding the same parameter list and values again keeps the memoized results.
+         *
+         * @param params The parameter names in scope, must outlive the binding.
+         * @param values The values of the parameters.
+         */
+        void bind(const std::vector<std::string> &params, const std::vector<double> &values);
+
+        /**
+         * @brief Evaluates an expression in the current binding.
+         *
+         * @throws std::runtime_error If the expression uses an unknown identifier.
+         */
+        double evaluate(const ExprNode &expr);
+
+        /**
+         * @brief Compiles the part of an expression that depends on free parameters.
+         *
+         * Identifiers resolve to the parameter of the current binding with the
+         * same position, whose tape node is given by symbols. Subexpressions
+         * that depend on no free parameter are evaluated and folded into constants.
+         *
+         * @param expr The expression to compile.
+         * @param symbols The tape node of each parameter in scope, -1 for a fixed value.
+         * @param tape The tape to append to.
+         * @return The tape node of the expression, -1 if it depends on no free parameter.
+         * @throws std::runtime_error If the expression uses an unknown identifier.
+         */
+        int compile(const ExprNode &expr, const std::vector<int> &symbols, ExprTape &tape);
+
+        // inline get methods
+        // number of node evaluations that were computed, not read from the memo
+        inline size_t getComputed() const { return computed; }
+
+    private:
+        // results of the nodes of one pool, valid when the stamp matches
+        struct Memo
+        {
+            const ExprPool *pool;
+            std::vector<double> values;
+            std::vector<uint32_t> stamps;
+        };
+
+        double compute(const ExprNode &expr);
+        Memo &memoFor(const ExprPool *pool);
+
+        const std::vector<std::string> *params = nullptr;
+        std::vector<double> values;
+        uint32_t generation = 1;
+        std::vector<Memo> memos;
+        size_t computed = 0;
+    };
+
 } // namespace qasmcpp
 #endif // EXPRESSION_NODE_H
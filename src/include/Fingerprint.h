@@ -0,0 +1,58 @@
+#ifndef QASM_FINGERPRINT_H
+#define QASM_FINGERPRINT_H
+
+#include <cstdint>
+#include <string>
+#include "AST.h"
+#include "SymbolTable.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct Fingerprint
+     * @brief Structural hash of a parsed program, for cache keys and deduplication.
+     *
+     * Programs that differ only in whitespace, comments, register names,
+     * the names and order of their gate definitions, the names of gate
+     * parameters and arguments, or the spelling of constants ("pi/2" or
+     * 1.5707963267948966) get the same fingerprint.
+     */
+    struct Fingerprint
+    {
+        uint64_t registers = 0;    /**< Hash of the register types and sizes in declaration order. */
+        uint64_t gates = 0;        /**< Order-independent hash of the gate definitions. */
+        uint64_t instructions = 0; /**< Hash of the top-level statements in program order. */
+        uint64_t hash = 0;         /**< Combination of the three, the cache key. */
+
+        /**
+         * @brief Returns the hash as 16 hexadecimal digits.
+         */
+        std::string toHex() const;
+
+        inline bool operator==(const Fingerprint &other) const { return hash == other.hash; }
+        inline bool operator!=(const Fingerprint &other) const { return hash != other.hash; }
+    };
+
+    /**
+     * @brief Computes the structural fingerprint of a program in one pass over its statements.
+     *
+     * Registers are identified by their position among the registers of
+     * their kind and gates by the hash of their definition, so names do not
+     * contribute. Inside a definition, parameters and qubit arguments are
+     * identified by position. A gate from an include or the base table that
+     * the program does not define is hashed by its body as well, only the
+     * built-in qelib1 gates are identified by their name. Constant
+     * expressions are evaluated and rounded to a multiple of 2^-32, so
+     * equal values written differently hash alike.
+     *
+     * @param program The program node of the parsed source.
+     * @param symbolTable The symbol table of the parsed program.
+     * @return The fingerprint.
+     * @throws std::runtime_error If the program uses an undeclared register.
+     */
+    Fingerprint fingerprint(const ProgramNode &program, const SymbolTable &symbolTable);
+
+} // namespace qasmcpp
+
+#endif // QASM_FINGERPRINT_H
@@ -0,0 +1,174 @@
+#ifndef QASM_LOWERING_H
+#define QASM_LOWERING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "AST.h"
+#include "Expr.h"
+#include "SymbolTable.h"
+#include "MatrixCache.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct Instruction
+     * @brief One primitive operation of a lowered circuit on global qubit and cbit indices.
+     */
+    struct Instruction
+    {
+        enum OpType
+        {
+            U,
+            CX,
+            MEASURE,
+            RESET,
+            BARRIER
+        };
+
+        int op;             /**< Operation type, one of OpType. */
+        int qubits[2];      /**< Target qubit (U, MEASURE, RESET) or control and target (CX). */
+        int cbit;           /**< Classical bit written by MEASURE, -1 otherwise. */
+        int matrixId;       /**< Id of the U matrix in Circuit::matrices, -1 otherwise. */
+        double params[3];   /**< theta, phi and lambda of U. */
+        int condition = -1; /**< Index in Circuit::conditions that must hold, -1 if unconditioned. */
+        int barrier = -1;   /**< Barrier statement of a BARRIER, shared by its qubits, -1 otherwise. */
+    };
+
+    /**
+     * @struct Condition
+     * @brief The classical condition of an if statement, a creg compared with a value.
+     *
+     * Each creg starts a new 64-bit word of the classical state, in
+     * declaration order, with its bit i at bit i % 64 of word i / 64. A creg
+     * of up to 64 bits is then equal to the value if its word is, and a
+     * wider one if its higher words are also zero.
+     */
+    struct Condition
+    {
+        int word;       /**< First word of the creg in the classical state. */
+        int numWords;   /**< Number of words of the creg. */
+        uint64_t value; /**< The value compared with. */
+    };
+
+    /**
+     * @struct RegisterLayout
+     * @brief Placement of a register in the global qubit or cbit index space.
+     */
+    struct RegisterLayout
+    {
+        std::string name; /**< Name of the register. */
+        int offset;       /**< Global index of the first bit. */
+        int size;         /**< Number of bits. */
+    };
+
+    /**
+     * @struct Circuit
+     * @brief A program flattened to U, CX, measure, reset and barrier instructions.
+     *
+     * Registers are laid out in declaration order, so qubit i of the first
+     * qreg is global qubit i and the following registers come after it.
+     * Instructions refer to bit positions of the statevector, which are the
+     * global qubit indices unless the circuit was relabeled. The operation
+     * of an if statement lowers to instructions that share its condition.
+     */
+    struct Circuit
+    {
+        int numQubits = 0;                       /**< Total number of qubits. */
+        int numCbits = 0;                        /**< Total number of classical bits. */
+        std::vector<RegisterLayout> qregs;       /**< Qubit registers in declaration order. */
+        std::vector<RegisterLayout> cregs;       /**< Cbit registers in declaration order. */
+        std::vector<Instruction> instructions;   /**< Instructions in program order. */
+        std::vector<Condition> conditions;       /**< Conditions of the if statements. */
+        int numWords = 0;                        /**< Number of 64-bit words of the classical state. */
+        MatrixCache matrices;                    /**< Matrices of the U instructions. */
+        std::vector<int> physicalQubits;         /**< Bit position of each qubit after relabeling, empty if not relabeled. */
+    };
+
+    /**
+     * @struct ParamSlot
+     * @brief A U instruction of a lowered template whose angles depend on free parameters.
+     */
+    struct ParamSlot
+    {
+        size_t instruction; /**< Index of the instruction in Circuit::instructions. */
+        int angles[3];      /**< Tape node of theta, phi and lambda, -1 for a fixed angle. */
+    };
+
+    /**
+     * @class Lowering
+     * @brief Expands a parsed program into a flat Circuit.
+     *
+     * User and standard gates are expanded recursively down to U and CX with
+     * their parameter expressions evaluated, and register arguments are
+     * broadcast over the register. Expressions are evaluated through an
+     * ExprEvaluator, so pooled expressions shared by many gate applications
+     * are computed once per binding.
+     */
+    class Lowering
+    {
+    public:
+        /**
+         * @brief Constructs a lowering over the gate definitions of a symbol table.
+         *
+         * @param symbolTable The symbol table of the parsed program.
+         */
+        explicit Lowering(const SymbolTable &symbolTable);
+
+        /**
+         * @brief Lowers a program.
+         *
+         * @param program The program node of the parsed source.
+         * @return The flattened circuit.
+         * @throws std::runtime_error On undefined gates or registers, mismatched
+         *         arguments and statements the lowering does not support.
+         */
+        Circuit lower(const ProgramNode &program);
+
+        /**
+         * @brief Lowers a program whose top-level expressions may use free parameters.
+         *
+         * The free parameters are resolved like the parameters of a gate body.
+         * Every U instruction with an angle that depends on one gets no matrix,
+         * its angles are compiled into the tape and it is recorded as a slot,
+         * in instruction order.
+         *
+         * @param program The program node of the parsed source.
+         * @param freeParams The names of the free parameters.
+         * @param tape The tape to compile the angles into, with a node per free parameter.
+         * @param slots Appended with the parameterized instructions.
+         * @return The flattened circuit, with the slots still to be filled.
+         * @throws std::runtime_error As lower().
+         */
+        Circuit lowerTemplate(const ProgramNode &program, const std::vector<std::string> &freeParams, ExprTape &tape, std::vector<ParamSlot> &slots);
+
+    private:
+        Circuit lowerProgram(const ProgramNode &program);
+        void lowerStatement(const QASMNode &statement, Circuit &circuit);
+        void expandGate(const std::string &name, const std::vector<double> &values, const std::vector<int> &symbols, const std::vector<int> &qubits, Circuit &circuit, int depth);
+        void compileAngles(const UStmtNode &u, const std::vector<int> &symbols, double angles[3], int nodes[3]);
+        void pushU(Circuit &circuit, int qubit, const double angles[3], const int nodes[3]);
+
+        std::vector<int> resolve(const Bit &bit, bool quantum) const;
+        size_t broadcastSize(const std::vector<std::vector<int>> &args) const;
+
+        const SymbolTable &symbolTable;
+        ExprEvaluator evaluator;
+
+        // free parameters of a template, empty for a plain lowering
+        const std::vector<std::string> *freeParams = nullptr;
+        std::vector<double> freeValues;
+        std::vector<int> freeSymbols;
+        ExprTape *tape = nullptr;
+        std::vector<ParamSlot> *slots = nullptr;
+        std::unordered_map<std::string, RegisterLayout> qregs;
+        std::unordered_map<std::string, RegisterLayout> cregs;
+        std::unordered_map<std::string, int> cregWords;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_LOWERING_H
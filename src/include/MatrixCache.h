@@ -0,0 +1,76 @@
+#ifndef QASM_MATRIX_CACHE_H
+#define QASM_MATRIX_CACHE_H
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace qasmcpp
+{
+
+    /**
+     * @class MatrixCache
+     * @brief Interns the 2x2 unitaries of U gates by their resolved parameters.
+     *
+     * Each distinct (theta, phi, lambda) tuple is computed once and gets a
+     * dense id, which lowered instructions store so executors fetch the
+     * matrix by index without any trigonometry.
+     */
+    class MatrixCache
+    {
+    public:
+        typedef std::array<std::complex<double>, 4> Matrix;
+
+        /**
+         * @brief Returns the id of U(theta, phi, lambda), computing its matrix on first use.
+         *
+         * Parameters are compared by bit pattern, so only exactly equal angles share an id.
+         *
+         * @return The dense id of the matrix.
+         */
+        int intern(double theta, double phi, double lambda);
+
+        /**
+         * @brief Returns the matrix of an id, in row-major order.
+         */
+        inline const Matrix &get(int id) const { return matrices[id]; }
+
+        /**
+         * @brief Returns the number of distinct matrices.
+         */
+        inline size_t size() const { return matrices.size(); }
+
+        /**
+         * @brief Forgets the matrices with an id of size or more.
+         *
+         * The remaining ids are unchanged, so instructions that use them stay valid.
+         */
+        void truncate(size_t size);
+
+        /**
+         * @brief Computes the matrix of U(theta, phi, lambda).
+         */
+        static Matrix uMatrix(double theta, double phi, double lambda);
+
+    private:
+        struct Key
+        {
+            uint64_t bits[3];
+            bool operator==(const Key &other) const;
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const;
+        };
+
+        std::vector<Matrix> matrices;
+        std::vector<Key> keys;
+        std::unordered_map<Key, int, KeyHash> ids;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_MATRIX_CACHE_H
@@ -0,0 +1,71 @@
+#ifndef QASM_NOISE_H
+#define QASM_NOISE_H
+
+#include <string>
+#include "Lowering.h"
+#include "Simulator.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct NoiseModel
+     * @brief Error probabilities applied by the noisy trajectory executor.
+     *
+     * Depolarizing and amplitude-damping errors follow every gate on the
+     * qubits it acts on; a readout error flips a measured bit.
+     */
+    struct NoiseModel
+    {
+        double depolarizing = 0;     /**< Probability of a random X, Y or Z after a U. */
+        double depolarizing2 = 0;    /**< Probability of a random two-qubit Pauli other than II after a CX. */
+        double amplitudeDamping = 0; /**< Decay probability of |1> to |0> after a gate. */
+        double readout = 0;          /**< Probability that a measured bit is flipped. */
+
+        /**
+         * @brief Parses a comma-separated list of name=probability pairs.
+         *
+         * The names are depolarizing, depolarizing2, amplitude_damping and
+         * readout, e.g. "depolarizing=0.001,readout=0.02". Missing names keep
+         * a probability of 0.
+         *
+         * @param description The noise model description.
+         * @return The noise model.
+         * @throws std::runtime_error On an unknown name or a probability outside [0, 1].
+         */
+        static NoiseModel parse(const std::string &description);
+
+        /**
+         * @brief Checks if every probability is 0.
+         */
+        bool isIdeal() const;
+    };
+
+    /**
+     * @brief Samples measurement counts over stochastic trajectories of a noisy circuit.
+     *
+     * Each shot is one trajectory: the circuit runs from the all-zero state
+     * and every error is drawn as it occurs, so a trajectory is a pure state
+     * and the counts converge to those of the noisy channel. Amplitude
+     * damping is unraveled into a jump to |0> or a damped no-jump branch,
+     * weighted by the population of |1>. Conditioned instructions test the
+     * measured bits as in simulate().
+     *
+     * Trajectories are split into fixed chunks that OpenMP threads take in
+     * turn. Every thread keeps one statevector for all of its trajectories,
+     * and each chunk counts its outcomes in a histogram of its own, merged in
+     * chunk order after the threads join, so no lock is taken. A trajectory
+     * draws its errors and measurements from a counter-based stream of the
+     * seed and its index, so the counts do not depend on the thread count.
+     *
+     * @param circuit The circuit to simulate.
+     * @param noise The error probabilities.
+     * @param options The number of trajectories (shots), the seed and whether to relabel qubits.
+     * @return The counts of the classical outcomes, with the errors drawn in stats.noiseEvents.
+     * @throws std::runtime_error If the state does not fit the supported size.
+     */
+    SimResult simulateNoisy(const Circuit &circuit, const NoiseModel &noise, const SimOptions &options);
+
+} // namespace qasmcpp
+
+#endif // QASM_NOISE_H
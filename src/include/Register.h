@@ -36,6 +36,9 @@ namespace qasmcpp
 
         Register(const std::string &name, int size, BitType type);
         Bit getBit(int index);
+
+        // bounds check without the exception of getBit
+        inline bool hasBit(int index) const { return index >= 0 && index < static_cast<int>(bits.size()); }
     };
 
     // Class representing a gate that user defines
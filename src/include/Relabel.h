@@ -0,0 +1,39 @@
+#ifndef QASM_RELABEL_H
+#define QASM_RELABEL_H
+
+#include <vector>
+#include "Lowering.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @brief Picks a bit position for every qubit of a circuit by usage and interaction.
+     *
+     * Positions are filled from the lowest, where gates have short strides
+     * and fall into cache-resident blocks. Each takes the qubit with the
+     * most gates, where the CX gates shared with the qubits already placed
+     * count twice, so frequent CX partners end up next to each other. Ties
+     * keep declaration order.
+     *
+     * @param circuit The circuit to analyze.
+     * @return The new bit position of each current bit position.
+     */
+    std::vector<int> chooseQubitOrder(const Circuit &circuit);
+
+    /**
+     * @brief Rewrites the qubit operands of a circuit with a permutation.
+     *
+     * The permutation is recorded in Circuit::physicalQubits so results can
+     * be mapped back to the declared qubits. Classical bits are unchanged,
+     * so measurement outcomes need no translation.
+     *
+     * @param circuit The circuit to rewrite.
+     * @param order The new bit position of each current bit position.
+     * @return The number of qubits that moved.
+     */
+    size_t relabelQubits(Circuit &circuit, const std::vector<int> &order);
+
+} // namespace qasmcpp
+
+#endif // QASM_RELABEL_H
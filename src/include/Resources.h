@@ -0,0 +1,147 @@
+#ifndef QASM_RESOURCES_H
+#define QASM_RESOURCES_H
+
+#include <cstddef>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct GateResources
+     * @brief Resources of one application of a gate, expanded down to U and CX.
+     */
+    struct GateResources
+    {
+        size_t numParams = 0; /**< Number of parameters. */
+        size_t numQubits = 0; /**< Number of qubit arguments. */
+        size_t uCount = 0;    /**< U gates in the expansion. */
+        size_t cxCount = 0;   /**< CX gates in the expansion. */
+        size_t tCount = 0;    /**< t and tdg gates in the expansion. */
+        size_t depth = 0;     /**< Depth of the expansion in U and CX layers. */
+        int nesting = 0;      /**< Levels of gate definitions down to U and CX. */
+    };
+
+    /**
+     * @struct ResourceCounts
+     * @brief Resource estimate of a whole program.
+     *
+     * Depths count U and CX layers of the expanded circuit, measure and reset
+     * one layer each. A gate call is placed as one block: all its qubits wait
+     * for the latest of them and then advance by the depth of the gate.
+     */
+    struct ResourceCounts
+    {
+        std::map<std::string, size_t> gateCounts;    /**< Applications per operation name, after broadcasting. */
+        std::map<std::string, size_t> registerDepth; /**< Depth of each qreg by name. */
+
+        size_t uCount = 0;          /**< U gates after expansion. */
+        size_t cxCount = 0;         /**< CX gates after expansion. */
+        size_t tCount = 0;          /**< t and tdg gates after expansion. */
+        size_t depth = 0;           /**< Depth over all qubits. */
+        size_t numQubits = 0;       /**< Declared qubits. */
+        size_t numCbits = 0;        /**< Declared classical bits. */
+        int maxNesting = 0;         /**< Deepest gate nesting of an applied gate. */
+        size_t statements = 0;      /**< Top-level statements read, includes not counted. */
+        size_t gateDefinitions = 0; /**< Gates defined, including included libraries. */
+
+        /**
+         * @brief Prints the estimate in human readable form.
+         *
+         * @param out The output stream.
+         */
+        void print(std::ostream &out) const;
+
+        /**
+         * @brief Prints the estimate as a single JSON object.
+         *
+         * @param out The output stream.
+         */
+        void printJson(std::ostream &out) const;
+    };
+
+    /**
+     * @class ResourceEstimator
+     * @brief Estimates the resources of a QASM2 program in one streaming pass.
+     *
+     * Statements are read one at a time and parsed on their own, and no AST is
+     * built. Each gate definition is reduced to its GateResources when it is
+     * declared, so applying a gate never expands its body again. Memory grows
+     * with the registers, qubits and gate definitions but not with the number
+     * of statements.
+     */
+    class ResourceEstimator
+    {
+    public:
+        /**
+         * @brief Estimates the resources of a QASM2 file.
+         *
+         * @param path The path of the file.
+         * @return The resource estimate.
+         * @throws std::runtime_error If the file cannot be read or is invalid.
+         */
+        ResourceCounts estimateFile(const std::string &path);
+
+        /**
+         * @brief Estimates the resources of QASM2 source code held in memory.
+         */
+        ResourceCounts estimateString(const std::string &source);
+
+        /**
+         * @brief Estimates the resources of a QASM2 stream.
+         */
+        ResourceCounts estimate(std::istream &input);
+
+        /**
+         * @brief Selects how include "qelib1.inc" is resolved.
+         *
+         * @param enable True to use the built-in standard library (default),
+         *               false to read the file from disk.
+         */
+        inline void setUseBuiltinStdlib(bool enable) { useBuiltinStdlib = enable; }
+
+        // inline get methods
+        // memoized resources of every gate defined by the last estimate
+        inline const std::unordered_map<std::string, GateResources> &getGateResources() const { return gates; }
+
+    private:
+        struct Register
+        {
+            size_t offset;
+            size_t size;
+        };
+
+        struct Call
+        {
+            std::string gate;
+            size_t numParams;
+            std::vector<int> qubits;
+        };
+
+        void reset();
+        void read(std::istream &input, const std::string &source, bool topLevel);
+        void statement(const std::string &text);
+        void include(const std::string &filename);
+        void defineGate(const std::string &name, size_t numParams, size_t numQubits, const std::vector<Call> &body);
+        const GateResources &lookup(const std::string &name, size_t numParams, size_t numQubits) const;
+        std::vector<size_t> resolve(const std::string &name, int index, bool quantum) const;
+        void apply(const std::string &name, const GateResources &gate, const std::vector<std::vector<size_t>> &args);
+
+        bool useBuiltinStdlib = true;
+        std::unordered_map<std::string, GateResources> gates;
+        std::unordered_map<std::string, Register> qregs;
+        std::unordered_map<std::string, Register> cregs;
+        std::unordered_set<std::string> includes; // files included so far, as in SymbolTable
+        std::vector<size_t> levels; // depth reached by each qubit
+        ResourceCounts counts;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_RESOURCES_H
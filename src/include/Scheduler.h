@@ -0,0 +1,42 @@
+#ifndef QASM_SCHEDULER_H
+#define QASM_SCHEDULER_H
+
+#include <cstddef>
+#include <vector>
+#include "Lowering.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct Layer
+     * @brief A run of consecutive instructions executed as one step.
+     *
+     * A gate layer holds U and CX instructions on pairwise disjoint qubits,
+     * which commute and can be applied in any order within one sweep over
+     * the state. Any other layer holds a single measure, reset or
+     * conditioned instruction.
+     */
+    struct Layer
+    {
+        size_t begin;   /**< Index of the first instruction of the layer. */
+        size_t end;     /**< One past the last instruction of the layer. */
+        bool gates;     /**< True for a layer of U and CX gates. */
+    };
+
+    /**
+     * @brief Groups the instructions of a circuit into layers.
+     *
+     * Consecutive gates join the current layer until one of them touches a
+     * qubit already used in it. A barrier closes the current layer and is
+     * not part of any layer. A conditioned instruction gets a layer of its
+     * own.
+     *
+     * @param circuit The circuit to schedule.
+     * @return The layers in execution order.
+     */
+    std::vector<Layer> scheduleLayers(const Circuit &circuit);
+
+} // namespace qasmcpp
+
+#endif // QASM_SCHEDULER_H
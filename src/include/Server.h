@@ -0,0 +1,84 @@
+#ifndef QASM_SERVER_H
+#define QASM_SERVER_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include "Driver.h"
+#include "Resources.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @class CompileServer
+     * @brief Long-running server that parses QASM2 jobs with a warm parser.
+     *
+     * The ATN of the generated lexer and parser is deserialized once per
+     * process and their prediction DFAs are shared by all parser instances,
+     * so after the warmup in the constructor a request only pays for its own
+     * tokens. Requests are framed as a header line "<command> <bytes>" followed
+     * by exactly that many bytes of QASM2 source. Each answer is framed the
+     * same way as "ok <bytes>" or "error <bytes>" followed by the payload.
+     *
+     * Commands:
+     * - parse:     the AST dump of the program
+     * - stats:     the parse statistics as JSON
+     * - resources: the resource estimate as JSON
+     * - validate:  every diagnostic, an error answer if there is any
+     * - quit:      ends the session, the source must be empty
+     *
+     * parse and stats answer a source with syntax errors with an error that
+     * lists the line, column and message of each one.
+     */
+    class CompileServer
+    {
+    public:
+        /**
+         * @brief Constructs a server and warms up the parser.
+         */
+        CompileServer();
+
+        /**
+         * @brief Answers framed requests until the end of the input or quit.
+         *
+         * @param in The framed requests.
+         * @param out Receives the framed answers, flushed after each one.
+         * @return False if the session ended with quit.
+         */
+        bool serve(std::istream &in, std::ostream &out);
+
+        /**
+         * @brief Listens on a Unix domain socket and serves one connection at a time.
+         *
+         * An existing socket file at the path is replaced, any other file is
+         * left alone. Returns once a client sends quit.
+         *
+         * @param path The file system path of the socket.
+         * @throws std::runtime_error If the socket cannot be created or the path is not a socket.
+         */
+        void serveSocket(const std::string &path);
+
+        /**
+         * @brief Runs one command on a source.
+         *
+         * @param command The command name.
+         * @param source The QASM2 source.
+         * @param response Set to the payload of the answer.
+         * @return True for an ok answer, false for an error answer.
+         */
+        bool handle(const std::string &command, const std::string &source, std::string &response);
+
+        // inline get methods
+        inline size_t getRequestCount() const { return requests; }
+
+    private:
+        QASM2Driver driver;
+        ResourceEstimator estimator;
+        size_t requests = 0;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_SERVER_H
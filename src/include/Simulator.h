@@ -0,0 +1,230 @@
+#ifndef QASM_SIMULATOR_H
+#define QASM_SIMULATOR_H
+
+#include <complex>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ClassicalState.h"
+#include "Lowering.h"
+#include "Scheduler.h"
+#include "Stats.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct SimOptions
+     * @brief Options of a simulation run.
+     */
+    struct SimOptions
+    {
+        size_t shots = 1024;        /**< Number of shots to sample. */
+        uint64_t seed = 1;          /**< Seed of measurement sampling, equal seeds give equal counts. */
+        bool sampleTerminal = true; /**< Simulate once and sample when all measurements are terminal. */
+        bool relabelQubits = true;  /**< Move the most used and most interacting qubits to the lowest bit positions. */
+        bool useStabilizer = true;  /**< Run Clifford-only circuits on the stabilizer tableau. */
+    };
+
+    /**
+     * @struct SimResult
+     * @brief Measurement counts of a simulation run.
+     *
+     * Keys are the classical registers in reverse declaration order, each
+     * written from its highest bit down and separated by spaces, as in
+     * "c1 c0".
+     */
+    struct SimResult
+    {
+        std::map<std::string, size_t> counts; /**< Number of shots per classical outcome. */
+        std::map<std::string, std::map<std::string, size_t>> registerCounts; /**< Histogram of each creg by name. */
+        size_t simulations = 0;               /**< Number of statevector or tableau runs performed. */
+        ExecStats stats;                      /**< Execution counters. */
+    };
+
+    /**
+     * @class StatevectorSimulator
+     * @brief Dense statevector simulator for lowered circuits.
+     *
+     * Amplitudes are kept in one vector of 2^n complex doubles, with qubit i
+     * as bit i of the index. The gate kernels use AVX2 when the library is
+     * built with it and split the amplitudes between OpenMP threads on large
+     * states. Circuits run layer by layer: the gates of a layer on low qubits
+     * are applied together in one blocked, cache-resident sweep, and those on
+     * high qubits in one sweep per group over gathered, cache-resident tiles.
+     */
+    class StatevectorSimulator
+    {
+    public:
+        typedef std::complex<double> Amplitude;
+
+        // Gates below this qubit are applied together in cache-resident blocks
+        static const int kBlockQubits = 12;
+
+        /**
+         * @brief Constructs a simulator in the all-zero state.
+         *
+         * @param numQubits The number of qubits.
+         * @param seed The seed of measurement sampling.
+         * @throws std::runtime_error If the state does not fit the supported size.
+         */
+        explicit StatevectorSimulator(int numQubits, uint64_t seed = 1);
+
+        /**
+         * @brief Sets every qubit back to |0>.
+         */
+        void initialize();
+
+        /**
+         * @brief Applies U(theta, phi, lambda) to a qubit.
+         */
+        void applyU(int qubit, double theta, double phi, double lambda);
+
+        /**
+         * @brief Applies a 2x2 unitary, given in row-major order, to a qubit.
+         */
+        void applyMatrix(int qubit, const Amplitude matrix[4]);
+
+        /**
+         * @brief Applies CX with the given control and target qubits.
+         */
+        void applyCX(int control, int target);
+
+        /**
+         * @brief Measures a qubit in the computational basis and collapses the state.
+         *
+         * @return The outcome, 0 or 1.
+         */
+        int measure(int qubit);
+
+        /**
+         * @brief Resets a qubit to |0>.
+         */
+        void reset(int qubit);
+
+        /**
+         * @brief Returns the probability of measuring 1 on a qubit, given by its bit position.
+         */
+        double qubitProbability(int qubit) const;
+
+        /**
+         * @brief Runs a circuit once from the all-zero state.
+         *
+         * @param circuit The circuit to execute.
+         * @param cbits Set to the classical bits after the run.
+         */
+        void run(const Circuit &circuit, std::vector<int> &cbits);
+
+        /**
+         * @brief Runs a circuit once from the all-zero state with a precomputed schedule.
+         *
+         * @param circuit The circuit to execute.
+         * @param layers The layers of the circuit from scheduleLayers.
+         * @param cbits Set to the classical bits after the run.
+         */
+        void run(const Circuit &circuit, const std::vector<Layer> &layers, std::vector<int> &cbits);
+
+        /**
+         * @brief Runs a circuit once from the all-zero state, keeping the classical bits packed.
+         *
+         * Conditioned instructions run only when their condition holds on
+         * the bits measured so far.
+         *
+         * @param circuit The circuit to execute.
+         * @param layers The layers of the circuit from scheduleLayers.
+         * @param classical Cleared and set to the classical bits after the run.
+         */
+        void run(const Circuit &circuit, const std::vector<Layer> &layers, ClassicalState &classical);
+
+        /**
+         * @brief Applies the gates of a circuit from the all-zero state, skipping measurements.
+         *
+         * @param circuit The circuit to execute, measurements must be terminal.
+         */
+        void evolve(const Circuit &circuit);
+
+        /**
+         * @brief Returns the amplitude of a basis state of the declared qubits.
+         *
+         * The index is mapped through the relabeling of the last circuit run.
+         */
+        Amplitude amplitude(uint64_t index) const;
+
+        /**
+         * @brief Returns the probability of measuring a basis state of the declared qubits.
+         */
+        double probability(uint64_t index) const;
+
+        // inline set methods
+        inline void setStats(ExecStats *execStats) { stats = execStats; }
+        // restarts the measurement sampling sequence
+        inline void setSeed(uint64_t seed) { rngState = seed; }
+
+        // inline get methods
+        inline int getNumQubits() const { return numQubits; }
+        // amplitudes in bit-position order, see amplitude() for the declared order
+        inline const std::vector<Amplitude> &getState() const { return state; }
+
+    private:
+        void execute(const Circuit &circuit, const std::vector<Layer> &layers, ClassicalState &classical, bool measureBits);
+        void applyLayer(const Circuit &circuit, const Layer &layer);
+        uint64_t physicalIndex(uint64_t index) const;
+        double nextUniform();
+
+        int numQubits;
+        std::vector<Amplitude> state;
+        uint64_t rngState;
+        std::vector<int> layout;
+        ExecStats *stats = nullptr;
+    };
+
+    /**
+     * @brief Formats classical bits as a SimResult key.
+     *
+     * @param circuit The circuit that defines the classical registers.
+     * @param cbits The classical bits, indexed by global cbit index.
+     * @return The outcome string.
+     */
+    std::string formatCbits(const Circuit &circuit, const std::vector<int> &cbits);
+
+    /**
+     * @brief Adds shots with the given classical bits to the joint and per-register counts.
+     *
+     * @param result The result to add to.
+     * @param circuit The circuit that defines the classical registers.
+     * @param cbits The classical bits, indexed by global cbit index.
+     * @param count The number of shots.
+     */
+    void recordOutcome(SimResult &result, const Circuit &circuit, const std::vector<int> &cbits, size_t count);
+
+    /**
+     * @brief Checks if every measurement comes after the last gate on its qubit.
+     *
+     * Such circuits can be simulated once and sampled for every shot.
+     * Circuits with reset or conditioned instructions are never terminal.
+     *
+     * @param circuit The circuit to check.
+     * @return True if the measurements are terminal.
+     */
+    bool hasTerminalMeasurements(const Circuit &circuit);
+
+    /**
+     * @brief Simulates a circuit and samples measurement counts.
+     *
+     * Circuits with terminal measurements are simulated once and the shots
+     * are drawn from the final distribution with a counter-based generator,
+     * in parallel. Other circuits, such as those with if statements, are
+     * simulated once per shot. Circuits of
+     * Clifford gates only run on a stabilizer tableau instead, which has no
+     * limit on the number of qubits.
+     *
+     * @param circuit The circuit to simulate.
+     * @param options The number of shots and the seed.
+     * @return The counts of the classical outcomes.
+     */
+    SimResult simulate(const Circuit &circuit, const SimOptions &options);
+
+} // namespace qasmcpp
+
+#endif // QASM_SIMULATOR_H
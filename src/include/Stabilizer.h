@@ -0,0 +1,142 @@
+#ifndef QASM_STABILIZER_H
+#define QASM_STABILIZER_H
+
+#include <cstdint>
+#include <vector>
+#include "ClassicalState.h"
+#include "Lowering.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @brief Checks if a U gate is a Clifford gate.
+     *
+     * @return True if theta, phi and lambda are all multiples of pi/2.
+     */
+    bool isCliffordU(double theta, double phi, double lambda);
+
+    /**
+     * @brief Checks if every gate of a lowered circuit is a Clifford gate.
+     *
+     * h, s, sdg, x, y, z, cx, cz, swap and the other Clifford gates of
+     * qelib1.inc lower to CX and U gates with angles that are multiples of pi/2.
+     *
+     * @param circuit The circuit to check.
+     * @return True if the circuit can run on a stabilizer tableau.
+     */
+    bool isCliffordCircuit(const Circuit &circuit);
+
+    /**
+     * @class StabilizerSimulator
+     * @brief Stabilizer tableau simulator for Clifford circuits (Aaronson-Gottesman).
+     *
+     * The tableau holds n destabilizer rows, n stabilizer rows and a scratch
+     * row. Each row packs its X and Z bits into 64-bit words, so row products
+     * in measurements run a word at a time. Gates cost O(n) and measurements
+     * O(n^2 / 64), which makes circuits of thousands of qubits tractable.
+     */
+    class StabilizerSimulator
+    {
+    public:
+        /**
+         * @brief Constructs a simulator in the all-zero state.
+         *
+         * @param numQubits The number of qubits.
+         * @param seed The seed of measurement sampling.
+         */
+        explicit StabilizerSimulator(int numQubits, uint64_t seed = 1);
+
+        /**
+         * @brief Sets every qubit back to |0>.
+         */
+        void initialize();
+
+        // Clifford gates
+        void applyH(int qubit);
+        void applyS(int qubit);
+        void applyX(int qubit);
+        void applyZ(int qubit);
+        void applyCX(int control, int target);
+
+        /**
+         * @brief Applies U(theta, phi, lambda) as H and S gates, up to global phase.
+         *
+         * @throws std::runtime_error If the gate is not a Clifford gate.
+         */
+        void applyU(int qubit, double theta, double phi, double lambda);
+
+        /**
+         * @brief Measures a qubit in the computational basis.
+         *
+         * @return The outcome, 0 or 1.
+         */
+        int measure(int qubit);
+
+        /**
+         * @brief Measures a qubit, taking the given outcome if it is random.
+         *
+         * The random measurements of a sequence do not depend on the earlier
+         * outcomes, and the deterministic outcomes are affine in them.
+         *
+         * @param qubit The qubit to measure.
+         * @param outcome The outcome of a random measurement, or -1 to sample it.
+         * @param random Set to true if the outcome was random.
+         * @return The outcome, 0 or 1.
+         */
+        int measure(int qubit, int outcome, bool &random);
+
+        /**
+         * @brief Resets a qubit to |0>.
+         */
+        void reset(int qubit);
+
+        /**
+         * @brief Runs a circuit once from the all-zero state.
+         *
+         * @param circuit The circuit to execute, every gate must be a Clifford gate.
+         * @param cbits Set to the classical bits after the run.
+         */
+        void run(const Circuit &circuit, std::vector<int> &cbits);
+
+        /**
+         * @brief Runs a circuit once from the all-zero state, keeping the classical bits packed.
+         *
+         * @param circuit The circuit to execute, every gate must be a Clifford gate.
+         * @param classical Cleared and set to the classical bits after the run.
+         */
+        void run(const Circuit &circuit, ClassicalState &classical);
+
+        /**
+         * @brief Applies the gates of a circuit from the all-zero state, skipping measurements.
+         */
+        void evolve(const Circuit &circuit);
+
+        /**
+         * @brief Restarts the measurement sampling sequence.
+         */
+        inline void setSeed(uint64_t seed) { rngState = seed; }
+
+        // inline get methods
+        inline int getNumQubits() const { return numQubits; }
+
+    private:
+        void execute(const Circuit &circuit, ClassicalState &classical, bool measureBits);
+        void rowsum(size_t target, size_t source);
+        void rowcopy(size_t target, size_t source);
+        void rowclear(size_t row);
+        int nextBit();
+
+        inline uint64_t *xRow(size_t row) { return bits.data() + row * 2 * words; }
+        inline uint64_t *zRow(size_t row) { return bits.data() + row * 2 * words + words; }
+
+        int numQubits;
+        size_t words;
+        std::vector<uint64_t> bits;  // rows of X words followed by Z words
+        std::vector<uint8_t> phases; // sign bit of each row
+        uint64_t rngState;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_STABILIZER_H
@@ -0,0 +1,51 @@
+#ifndef QASM_STATEMENT_READER_H
+#define QASM_STATEMENT_READER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+
+namespace qasmcpp
+{
+
+    /**
+     * @class StatementReader
+     * @brief Splits a QASM2 stream into top-level statements without reading it whole.
+     *
+     * A statement ends at a semicolon outside of braces, or at the brace that
+     * closes a gate body. Comments are dropped and string literals are kept
+     * intact. Only the current statement is held in memory, so the reader can
+     * go through inputs of any length.
+     */
+    class StatementReader
+    {
+    public:
+        /**
+         * @brief Constructs a reader over a stream.
+         *
+         * @param input The QASM2 source, read from its current position.
+         */
+        explicit StatementReader(std::istream &input);
+
+        /**
+         * @brief Reads the next statement.
+         *
+         * @param statement Set to the text of the statement, without comments.
+         * @return False at the end of the input.
+         * @throws std::runtime_error If the input ends inside a statement.
+         */
+        bool next(std::string &statement);
+
+        // inline get methods
+        // line of the first character of the last statement read
+        inline size_t getLine() const { return line; }
+
+    private:
+        std::istream &input;
+        size_t currentLine = 1;
+        size_t line = 0;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_STATEMENT_READER_H
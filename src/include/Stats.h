@@ -0,0 +1,158 @@
+#ifndef QASM_STATS_H
+#define QASM_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include "AllocCounter.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct ParseStats
+     * @brief Per-phase timings and counters collected while parsing a circuit.
+     *
+     * Times are wall-clock milliseconds. Token and parse tree counts cover the
+     * main source only; included files are accounted by includeFiles,
+     * includeTime and bytesRead. visitTime excludes the time spent in includes,
+     * which is timed once at the outermost include.
+     */
+    struct ParseStats
+    {
+        double lexTime = 0;        /**< Time spent filling the token stream. */
+        double parseTime = 0;      /**< Time spent building the parse tree. */
+        double visitTime = 0;      /**< Time spent building the AST, excluding includes. */
+        double includeTime = 0;    /**< Time spent processing include statements. */
+        double totalTime = 0;      /**< Time spent in the whole parse. */
+
+        size_t bytesRead = 0;      /**< Bytes read from the source and included files. */
+        size_t tokens = 0;         /**< Number of tokens in the main source. */
+        size_t parseTreeNodes = 0; /**< Number of parse tree nodes of the main source, 0 in single-pass mode. */
+        size_t astNodes = 0;       /**< Number of AST nodes including expressions. */
+        size_t includeFiles = 0;   /**< Number of include statements processed. */
+        size_t predictions = 0;    /**< Adaptive predictions made by the parser (SLL), 0 unless profiled. */
+        size_t llFallbacks = 0;    /**< Predictions that fell back from SLL to full LL, 0 unless profiled. */
+        size_t dfaStates = 0;      /**< Prediction DFA states of the process after the parse. */
+
+        // Heap allocations per phase, only counted when AllocHooks.cpp is linked in
+        AllocCounts lexAllocations;   /**< Allocations made while lexing. */
+        AllocCounts parseAllocations; /**< Allocations made while parsing. */
+        AllocCounts visitAllocations; /**< Allocations made while visiting, including includes. */
+
+        /**
+         * @brief Resets every timing and counter to zero.
+         */
+        void reset();
+
+        /**
+         * @brief Prints the statistics in human readable form.
+         *
+         * @param out The output stream.
+         */
+        void print(std::ostream &out) const;
+
+        /**
+         * @brief Prints the statistics as a single JSON object.
+         *
+         * @param out The output stream.
+         */
+        void printJson(std::ostream &out) const;
+    };
+
+    /**
+     * @struct ExecStats
+     * @brief Counters of a simulation run.
+     *
+     * A sweep is one pass over the whole statevector. Gates on qubits below
+     * the cache block size share one blocked sweep per layer, gates above it
+     * ("high" gates) share one gathered sweep per group of up to 6 high qubits.
+     */
+    struct ExecStats
+    {
+        double simulateTime = 0;    /**< Time spent applying instructions. */
+        double sampleTime = 0;      /**< Time spent sampling shots from the final state. */
+
+        size_t layers = 0;          /**< Number of layers in the schedule. */
+        size_t sweeps = 0;          /**< Passes over the statevector. */
+        size_t blockedGates = 0;    /**< Gates applied within blocked sweeps. */
+        size_t relabeledQubits = 0; /**< Qubits moved by the relabeling pass. */
+        size_t highGatesBefore = 0; /**< Gates touching a high qubit before relabeling. */
+        size_t highGatesAfter = 0;  /**< Gates touching a high qubit after relabeling. */
+        bool stabilizer = false;    /**< True if the circuit ran on the Clifford stabilizer tableau. */
+        size_t noiseEvents = 0;     /**< Errors drawn by the noisy trajectories. */
+
+        /**
+         * @brief Prints the statistics in human readable form.
+         *
+         * @param out The output stream.
+         */
+        void print(std::ostream &out) const;
+
+        /**
+         * @brief Prints the statistics as a single JSON object.
+         *
+         * @param out The output stream.
+         */
+        void printJson(std::ostream &out) const;
+    };
+
+    /**
+     * @struct TranspileStats
+     * @brief Counters of a transpilation to a native basis.
+     */
+    struct TranspileStats
+    {
+        double transpileTime = 0;  /**< Time spent transpiling. */
+
+        size_t inputGates = 0;     /**< U and CX instructions of the lowered circuit. */
+        size_t outputGates = 0;    /**< Basis gates of the result. */
+        size_t fusedRuns = 0;      /**< Runs of single-qubit gates merged into one unitary. */
+        size_t decompositions = 0; /**< Single-qubit unitaries decomposed, not read from the table. */
+        size_t blocks = 0;         /**< Independent qubit blocks transpiled in parallel. */
+
+        /**
+         * @brief Prints the statistics in human readable form.
+         *
+         * @param out The output stream.
+         */
+        void print(std::ostream &out) const;
+
+        /**
+         * @brief Prints the statistics as a single JSON object.
+         *
+         * @param out The output stream.
+         */
+        void printJson(std::ostream &out) const;
+    };
+
+    /**
+     * @class PhaseTimer
+     * @brief Scoped wall-clock timer that adds the elapsed milliseconds to a counter.
+     *
+     * A null target disables the timer, so instrumentation costs a single
+     * branch when statistics are not collected.
+     */
+    class PhaseTimer
+    {
+    public:
+        explicit PhaseTimer(double *target) : target(target)
+        {
+            if (target != nullptr)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~PhaseTimer()
+        {
+            if (target != nullptr)
+                *target += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    private:
+        double *target;
+        std::chrono::steady_clock::time_point start;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_STATS_H
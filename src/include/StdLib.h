@@ -0,0 +1,87 @@
+#ifndef QASM_STDLIB_H
+#define QASM_STDLIB_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "SymbolTable.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @brief Built-in copy of the standard gate library qelib1.inc.
+     *
+     * The gates are compiled into the binary as static tables (name, parameter
+     * slots, qubit arity and body). Their Gate definitions are built once per
+     * process and shared, so including qelib1.inc only inserts the prebuilt
+     * definitions into the symbol table without any file I/O or ANTLR work.
+     */
+    namespace stdlib
+    {
+        /**
+         * @struct BuiltinGate
+         * @brief Static description of one gate of the standard library.
+         */
+        struct BuiltinGate
+        {
+            const char *name;   /**< Name of the gate. */
+            const char *params; /**< Comma separated parameter names. */
+            const char *qubits; /**< Comma separated qubit argument names. */
+            int bodyBegin;      /**< First body operation in the operation table. */
+            int bodyEnd;        /**< One past the last body operation. */
+        };
+
+        /**
+         * @struct BuiltinOp
+         * @brief Static description of one statement of a standard gate body.
+         */
+        struct BuiltinOp
+        {
+            const char *gate;   /**< U, CX or the name of a standard gate. */
+            const char *params; /**< Comma separated expressions over the parameter names. */
+            int qubits[4];      /**< Qubit argument slots of the enclosing gate, -1 terminated. */
+        };
+
+        /**
+         * @brief Checks if an include file name refers to the standard library.
+         *
+         * @param filename The file name of the include statement, without quotes.
+         * @return True if the base name of the file is qelib1.inc.
+         */
+        bool isQelib1(const std::string &filename);
+
+        /**
+         * @brief Returns the static gate table of qelib1.inc.
+         *
+         * @param count Set to the number of gates in the table.
+         * @return Pointer to the first gate of the table.
+         */
+        const BuiltinGate *qelib1Gates(size_t &count);
+
+        /**
+         * @brief Returns the static body operation table of qelib1.inc.
+         *
+         * @param count Set to the number of operations in the table.
+         * @return Pointer to the first operation of the table.
+         */
+        const BuiltinOp *qelib1Ops(size_t &count);
+
+        /**
+         * @brief Returns the shared gate definitions of qelib1.inc, built on first use.
+         *
+         * @return The gate definitions in library order.
+         */
+        const std::vector<std::shared_ptr<Gate>> &qelib1Definitions();
+
+        /**
+         * @brief Adds every gate of qelib1.inc to a symbol table.
+         *
+         * @param symbolTable The symbol table to populate.
+         */
+        void loadQelib1(SymbolTable &symbolTable);
+    } // namespace stdlib
+
+} // namespace qasmcpp
+
+#endif // QASM_STDLIB_H
@@ -0,0 +1,75 @@
+#ifndef QASM_STREAMING_PARSER_H
+#define QASM_STREAMING_PARSER_H
+
+#include <istream>
+#include <memory>
+#include <string>
+#include "AST.h"
+#include "ASTBuilder.h"
+#include "StatementReader.h"
+#include "Stats.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @class StreamingParser
+     * @brief Parses a QASM2 stream one top-level statement at a time.
+     *
+     * QASM2Driver fills a token stream with every token of the source before
+     * parsing. Here the StatementReader cuts the next statement out of the
+     * input, only its tokens are lexed and parsed, and the node is handed to
+     * the caller, so the live tokens and nodes are bounded by the longest
+     * statement. The symbol table and the expression pool grow with the
+     * declared registers, gates and unique parameter expressions, not with
+     * the length of the input.
+     */
+    class StreamingParser
+    {
+    public:
+        /**
+         * @brief Constructs a parser over a stream.
+         *
+         * @param input The QASM2 source, read from its current position.
+         */
+        explicit StreamingParser(std::istream &input);
+
+        /**
+         * @brief Parses the next statement.
+         *
+         * The version statement and statements with a syntax error produce
+         * no node and are skipped; syntax errors go to the error listeners.
+         *
+         * @param statement Set to the node of the statement.
+         * @return False at the end of the input.
+         * @throws std::runtime_error On a semantic error or if the input ends inside a statement.
+         */
+        bool next(std::shared_ptr<QASMNode> &statement);
+
+        // inline set methods
+        inline void setStats(ParseStats *parseStats)
+        {
+            stats = parseStats;
+            builder.setStats(parseStats);
+        }
+        inline void setUseBuiltinStdlib(bool enable) { builder.setUseBuiltinStdlib(enable); }
+
+        // inline get methods
+        // the program holds the version and the expression pool, not the statements
+        inline const std::shared_ptr<ProgramNode> &getProgram() const { return builder.getProgram(); }
+        inline const SymbolTable &getSymbolTable() const { return builder.getSymbolTable(); }
+        // line of the first character of the last statement read
+        inline size_t getLine() const { return reader.getLine(); }
+
+    private:
+        StatementReader reader;
+        ASTBuilder builder;
+        std::string text;
+
+        // parse statistics, null when not collected
+        ParseStats *stats = nullptr;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_STREAMING_PARSER_H
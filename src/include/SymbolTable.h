@@ -1,8 +1,9 @@
-#ifndef QASM_YMBOL_TABLE_H
+#ifndef QASM_SYMBOL_TABLE_H
 #define QASM_SYMBOL_TABLE_H
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 
 #include "Register.h"
@@ -14,12 +15,18 @@
  *
  * This class stores information about qubit and cbit registers.
  * It provides methods to add and retrieve qubit and cbit registers.
+ *
+ * A table can sit on top of a read-only base table shared by several
+ * programs, e.g. the gates of a common include set. Lookups fall back to the
+ * base and declarations go into this table, shadowing the base.
  */
 
 using namespace qasmcpp;
 namespace qasmcpp
 {
 
+    class ExprPool;
+
     class SymbolTable
     {
     public:
@@ -30,6 +37,10 @@ namespace qasmcpp
         // gate declaration
         std::unordered_map<std::string, std::shared_ptr<Register>> gates;
 
+        std::unordered_set<std::string> includes;  /**< Include files already loaded. */
+        std::shared_ptr<const SymbolTable> base;   /**< Shared read-only table consulted after this one. */
+        std::shared_ptr<const ExprPool> exprPool;  /**< Pool of the gate body expressions, kept alive with the table. */
+
         /**
          * @brief Adds a qubit register to the symbol table.
          *
@@ -56,6 +67,16 @@ namespace qasmcpp
 
         void addRegister(const std::string &name, int size, BitType type);
 
+        /**
+         * @brief Adds a register unless the name is already taken.
+         *
+         * @param name The name of the register.
+         * @param size The size of the register.
+         * @param type The type of the register bits.
+         * @return False if a register of that name exists, the table is unchanged then.
+         */
+        bool tryAddRegister(const std::string &name, int size, BitType type);
+
         /**
          * @brief Retrieves a cbit register from the symbol table.
          *
@@ -80,15 +101,39 @@ namespace qasmcpp
          */
         std::shared_ptr<Gate> getGateDef(const std::string &name);
 
+        /**
+         * @brief Looks up a gate definition without throwing.
+         *
+         * @param name The name of the gate.
+         * @return A shared pointer to the gate definition, or nullptr if not found.
+         */
+        std::shared_ptr<Gate> findGateDef(const std::string &name) const;
+
+        /**
+         * @brief Looks up a qubit register without throwing.
+         *
+         * @param name The name of the qubit register.
+         * @return A shared pointer to the qubit register, or nullptr if not found.
+         */
+        std::shared_ptr<Register> findQubitRegister(const std::string &name) const;
+
+        /**
+         * @brief Looks up a cbit register without throwing.
+         *
+         * @param name The name of the cbit register.
+         * @return A shared pointer to the cbit register, or nullptr if not found.
+         */
+        std::shared_ptr<Register> findCbitRegister(const std::string &name) const;
+
         /**
          * @brief Checks if a qubit register exists in the symbol table.
          *
          * @param name The name of the qubit register.
          * @return True if the qubit register exists, false otherwise.
          */
-        inline bool hasGateDef(const std::string &name)
+        inline bool hasGateDef(const std::string &name) const
         {
-            return gateDefines.find(name) != gateDefines.end();
+            return gateDefines.find(name) != gateDefines.end() || (base && base->hasGateDef(name));
         }
 
         /**
@@ -97,9 +142,9 @@ namespace qasmcpp
          * @param name The name of the qubit register.
          * @return True if the qubit register exists, false otherwise.
          */
-        inline bool isQubitRegister(const std::string &name)
+        inline bool isQubitRegister(const std::string &name) const
         {
-            return qubitRegisters.find(name) != qubitRegisters.end();
+            return qubitRegisters.find(name) != qubitRegisters.end() || (base && base->isQubitRegister(name));
         }
 
         /**
@@ -108,9 +153,9 @@ namespace qasmcpp
          * @param name The name of the cbit register.
          * @return True if the cbit register exists, false otherwise.
          */
-        inline bool isCbitRegister(const std::string &name)
+        inline bool isCbitRegister(const std::string &name) const
         {
-            return cbitRegisters.find(name) != cbitRegisters.end();
+            return cbitRegisters.find(name) != cbitRegisters.end() || (base && base->isCbitRegister(name));
         }
         
         /**
@@ -119,10 +164,21 @@ namespace qasmcpp
          * @param name The name of the register.
          * @return True if the register exists, false otherwise.
          */
-        inline bool isRegister(const std::string &name)
+        inline bool isRegister(const std::string &name) const
         {
             return isQubitRegister(name) || isCbitRegister(name);
         }
+
+        /**
+         * @brief Checks if an include file was already loaded into the table or its base.
+         *
+         * @param filename The file name as written in the include statement.
+         * @return True if the file was loaded, including it again adds nothing.
+         */
+        inline bool hasInclude(const std::string &filename) const
+        {
+            return includes.find(filename) != includes.end() || (base && base->hasInclude(filename));
+        }
     };
 } // namespace qasmcpp
 #endif // SYMBOL_TABLE_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef QASM_TEMPLATE_H
+#define QASM_TEMPLATE_H
+
+#include <string>
+#include <vector>
+#include "AST.h"
+#include "Expr.h"
+#include "Lowering.h"
+#include "SymbolTable.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @class CircuitTemplate
+     * @brief A parametric circuit that is parsed and lowered once and bound many times.
+     *
+     * The source uses free parameters as identifiers in top-level gate
+     * arguments, e.g. "rz(2*theta) q[0];". The program is lowered once with
+     * the gates expanded and the registers broadcast. The angles that depend
+     * on a free parameter are compiled into an ExprTape and their U
+     * instructions are kept as slots, so a binding only runs the tape and
+     * refills the slots, with no parsing, gate lookup or string work.
+     *
+     * bind() is const and can be called from several threads at once.
+     */
+    class CircuitTemplate
+    {
+    public:
+        /**
+         * @brief Lowers a parsed program into a template.
+         *
+         * @param program The program node of the parsed source.
+         * @param symbolTable The symbol table of the parsed program.
+         * @param params The names of the free parameters, in the order of the bound values.
+         * @throws std::runtime_error As Lowering::lower(), or if an expression
+         *         uses an identifier that is not a free parameter.
+         */
+        CircuitTemplate(const ProgramNode &program, const SymbolTable &symbolTable, std::vector<std::string> params);
+
+        /**
+         * @brief Binds the free parameters and returns an executable circuit.
+         *
+         * Copies the fixed instructions of the template once, see rebind()
+         * to reuse a circuit.
+         *
+         * @param values The value of each free parameter.
+         * @return The circuit with every U instruction resolved.
+         * @throws std::runtime_error If the number of values does not match the parameters.
+         */
+        Circuit bind(const std::vector<double> &values) const;
+
+        /**
+         * @brief Binds the free parameters again in a circuit returned by bind().
+         *
+         * Only the parameterized instructions and their matrices are
+         * rewritten, so the cost is linear in the number of slots.
+         *
+         * @param values The value of each free parameter.
+         * @param circuit A circuit bound from this template.
+         * @throws std::runtime_error If the number of values does not match the parameters.
+         */
+        void rebind(const std::vector<double> &values, Circuit &circuit) const;
+
+        // inline get methods
+        inline const std::vector<std::string> &getParams() const { return params; }
+        // number of U instructions that depend on a free parameter
+        inline size_t getNumSlots() const { return slots.size(); }
+
+    private:
+        std::vector<std::string> params;
+        ExprTape tape;
+        std::vector<ParamSlot> slots;
+        // the circuit with the slots unbound, and the number of its fixed matrices
+        Circuit circuit;
+        size_t fixedMatrices;
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_TEMPLATE_H
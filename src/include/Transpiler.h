@@ -0,0 +1,145 @@
+#ifndef QASM_TRANSPILER_H
+#define QASM_TRANSPILER_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Lowering.h"
+#include "MatrixCache.h"
+#include "Stats.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @struct BasisOp
+     * @brief One operation of a transpiled circuit, a basis gate or a non-unitary operation.
+     */
+    struct BasisOp
+    {
+        enum GateType
+        {
+            RZ,
+            RX,
+            RY,
+            SX,
+            X,
+            U3,
+            CX,
+            CZ,
+            MEASURE,
+            RESET,
+            BARRIER
+        };
+
+        int gate;          /**< Gate type, one of GateType. */
+        int qubits[2];     /**< Target qubit, or control and target of CX and CZ. */
+        int cbit;          /**< Classical bit written by MEASURE, -1 otherwise. */
+        double params[3];  /**< Angle of a rotation, or theta, phi and lambda of U3. */
+        int barrier = -1;  /**< Barrier statement of a BARRIER, shared by its qubits, -1 otherwise. */
+    };
+
+    /**
+     * @class Basis
+     * @brief A native gate set and the rules that rewrite U and CX into it.
+     *
+     * A basis is one two-qubit gate, cx or cz, and single-qubit gates that
+     * form an Euler decomposition: u3, rz and sx (optionally with x), rz and
+     * ry, or rz and rx. Every single-qubit unitary becomes at most three
+     * rotations and two sx. Bases are built once per gate set and shared,
+     * see get().
+     */
+    class Basis
+    {
+    public:
+        enum EulerType
+        {
+            EULER_U3,
+            EULER_ZSX,
+            EULER_ZYZ,
+            EULER_ZXZ
+        };
+
+        /**
+         * @brief Returns the shared basis of a gate set, building it on first use.
+         *
+         * The order of the names does not matter.
+         *
+         * @param gates The qelib1.inc names of the basis gates, e.g. {"rz", "sx", "cx"}.
+         * @return The basis.
+         * @throws std::runtime_error If the gates do not form a supported basis.
+         */
+        static std::shared_ptr<const Basis> get(const std::vector<std::string> &gates);
+
+        /**
+         * @brief Splits a comma-separated gate list such as "rz,sx,cx".
+         */
+        static std::vector<std::string> parseList(const std::string &list);
+
+        // inline get methods
+        inline EulerType getEuler() const { return euler; }
+        inline int getTwoQubitGate() const { return twoQubitGate; }
+        inline bool hasX() const { return useX; }
+        // the canonical gate list, sorted and comma-separated
+        inline const std::string &getName() const { return name; }
+
+    private:
+        Basis(const std::vector<std::string> &gates);
+
+        std::string name;
+        EulerType euler;
+        int twoQubitGate;
+        bool useX = false;
+    };
+
+    /**
+     * @struct TranspiledCircuit
+     * @brief A circuit rewritten into the gates of a basis.
+     */
+    struct TranspiledCircuit
+    {
+        int numQubits = 0;                  /**< Total number of qubits. */
+        int numCbits = 0;                   /**< Total number of classical bits. */
+        std::vector<RegisterLayout> qregs;  /**< Qubit registers in declaration order. */
+        std::vector<RegisterLayout> cregs;  /**< Cbit registers in declaration order. */
+        std::vector<BasisOp> ops;           /**< Operations on declared qubit indices. */
+        std::shared_ptr<const Basis> basis; /**< The basis of the gates. */
+
+        /**
+         * @brief Writes the circuit as a QASM2 program over qelib1.inc.
+         *
+         * sx is not part of qelib1.inc and gets a definition when used.
+         * Each barrier statement is written as one barrier over its qubits.
+         *
+         * @param out The output stream.
+         */
+        void write(std::ostream &out) const;
+    };
+
+    /**
+     * @brief Rewrites a lowered circuit into the gates of a basis.
+     *
+     * Runs of single-qubit gates are multiplied into one unitary, so
+     * adjacent rotations merge and gates that cancel disappear, and each
+     * run is decomposed into the Euler rotations of the basis; rotations by
+     * a multiple of 2*pi are dropped. The decomposition of a run of one U
+     * is looked up by its matrix id in a table of the block, so each
+     * distinct matrix is decomposed once per block and call; the table is
+     * not kept between calls. Qubits that never interact form independent
+     * blocks, which are transpiled on OpenMP threads; the operations of a
+     * block keep their order and blocks follow each other by first use.
+     * The qubits of one barrier statement stay in one block and their
+     * BARRIER operations are adjacent, after the gates that precede them.
+     *
+     * @param circuit The lowered circuit.
+     * @param basis The target basis.
+     * @param stats Filled with the transpilation counters, null to skip.
+     * @return The transpiled circuit, equal to the input up to a global phase.
+     * @throws std::runtime_error If the circuit has conditioned instructions.
+     */
+    TranspiledCircuit transpile(const Circuit &circuit, std::shared_ptr<const Basis> basis, TranspileStats *stats = nullptr);
+
+} // namespace qasmcpp
+
+#endif // QASM_TRANSPILER_H
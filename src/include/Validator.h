@@ -0,0 +1,108 @@
+#ifndef QASM_VALIDATOR_H
+#define QASM_VALIDATOR_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <antlr4-runtime.h>
+#include "QASM2Parser.h"
+#include "Diagnostics.h"
+
+namespace qasmcpp
+{
+
+    /**
+     * @class Validator
+     * @brief Checks QASM2 source for errors without building the AST or throwing.
+     *
+     * Syntax errors are forwarded from the lexer and parser, then one pass
+     * over the parse tree checks declarations, gate arity, register kinds,
+     * index bounds and broadcast sizes. Every error goes to the diagnostic
+     * sink with its location, so all errors of a source are reported in one
+     * run. Statements with syntax errors are skipped by the semantic checks.
+     */
+    class Validator
+    {
+    public:
+        /**
+         * @brief Constructs a validator that reports to a sink.
+         *
+         * @param sink Receives the diagnostics, it must outlive the validator.
+         */
+        explicit Validator(DiagnosticSink &sink);
+
+        /**
+         * @brief Validates a QASM2 file.
+         *
+         * @param path The path of the file.
+         * @return True if no error was found.
+         */
+        bool validateFile(const std::string &path);
+
+        /**
+         * @brief Validates QASM2 source code held in memory.
+         *
+         * @param source The QASM2 source code.
+         * @return True if no error was found.
+         */
+        bool validateString(const std::string &source);
+
+        /**
+         * @brief Selects how include "qelib1.inc" is resolved.
+         *
+         * @param enable True to use the built-in standard library (default),
+         *               false to read and validate the file from disk.
+         */
+        inline void setUseBuiltinStdlib(bool enable) { useBuiltinStdlib = enable; }
+
+    private:
+        struct RegisterInfo
+        {
+            size_t size;
+            bool quantum;
+        };
+
+        struct GateSignature
+        {
+            size_t numParams;
+            size_t numQubits;
+        };
+
+        // a checked register argument, index -1 for a whole register
+        struct Operand
+        {
+            std::string name;
+            int index;
+            size_t size;
+        };
+
+        void validate(const std::string &text, const std::string &sourceName, int depth);
+        void statement(QASM2Parser::StatementContext *ctx, int depth);
+        void include(QASM2Parser::IncludeDeclStmtContext *ctx, int depth);
+        void regDecl(QASM2Parser::RegDeclStmtContext *ctx);
+        void gateDecl(QASM2Parser::GateDeclStmtContext *ctx);
+        void opaqueDecl(QASM2Parser::OpaqueDeclStmtContext *ctx);
+        void ifDecl(QASM2Parser::IfDeclStmtContext *ctx);
+        void barrierDecl(QASM2Parser::BarrierDeclStmtContext *ctx);
+        void qop(QASM2Parser::QopStmtContext *ctx);
+        void gateBodyUop(QASM2Parser::UopContext *ctx, const std::vector<std::string> &params, const std::vector<std::string> &qubits);
+        void expression(QASM2Parser::ExpContext *ctx, const std::vector<std::string> &params);
+        void declareNames(const std::string &gate, const std::vector<antlr4::tree::TerminalNode *> &ids,
+                          const std::vector<std::string> &taken, std::vector<std::string> &names);
+        bool checkGate(antlr4::Token *at, const std::string &name, size_t numParams, size_t numQubits);
+        bool operand(QASM2Parser::ArgumentContext *arg, bool quantum, Operand &out);
+        void checkOperands(antlr4::Token *at, const std::vector<Operand> &operands);
+        void error(DiagCode code, antlr4::Token *at, const std::string &message);
+
+        DiagnosticSink &sink;
+        bool useBuiltinStdlib = true;
+        std::string source;
+        std::unordered_map<std::string, RegisterInfo> registers;
+        std::unordered_map<std::string, GateSignature> gates;
+        std::unordered_set<std::string> includes; // files included so far, as in SymbolTable
+    };
+
+} // namespace qasmcpp
+
+#endif // QASM_VALIDATOR_H
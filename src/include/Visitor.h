@@ -5,6 +5,8 @@
 #include <antlr4-runtime.h>
 #include "QASM2ParserBaseVisitor.h"
 #include "AST.h"
+#include "Expr.h"
+#include "Stats.h"
 
 /* base visitor postinclude section */
 
@@ -26,6 +28,18 @@ namespace qasmcpp
         // list of QASMNode
         std::shared_ptr<ProgramNode> program;
 
+        // expressions of the program and its includes, structurally equal ones are shared
+        std::shared_ptr<ExprPool> exprPool = std::make_shared<ExprPool>();
+
+        // parse statistics, null when not collected
+        ParseStats *stats = nullptr;
+
+        // include "qelib1.inc" loads the built-in standard library
+        bool useBuiltinStdlib = true;
+
+        // nesting of the include being built, 0 in the main source
+        int includeDepth = 0;
+
     public:
         /* base visitor public declarations/members section */
 
@@ -46,9 +60,33 @@ namespace qasmcpp
         Any visitMixedList(QASM2Parser::MixedListContext *ctx) override;
         Any visitOp(QASM2Parser::OpContext *ctx) override;
 
+        // inline set methods
+        inline void setStats(ParseStats *parseStats) { stats = parseStats; }
+        inline void setUseBuiltinStdlib(bool enable) { useBuiltinStdlib = enable; }
+        inline void setBaseSymbolTable(const std::shared_ptr<const SymbolTable> &base) { symbolTable.base = base; }
+
         // inline get methods
-        inline const std::shared_ptr<ProgramNode> getProgram() { return program; }
-        inline const SymbolTable getSymbolTable() { return symbolTable; }
+        inline const std::shared_ptr<ProgramNode> &getProgram() const { return program; }
+        inline const SymbolTable &getSymbolTable() const { return symbolTable; }
+
+    private:
+        // Typed builders over the generated contexts. The visit methods above
+        // box their results in Any for the visitor interface; the builders
+        // return them directly or append them to the destination, so building
+        // the AST does not box and unbox every list and argument.
+        std::shared_ptr<QASMNode> buildStatement(QASM2Parser::StatementContext *ctx);
+        std::shared_ptr<QASMNode> buildInclude(QASM2Parser::IncludeDeclStmtContext *ctx);
+        std::shared_ptr<QASMNode> buildRegDecl(QASM2Parser::RegDeclStmtContext *ctx);
+        std::shared_ptr<QASMNode> buildGateDecl(QASM2Parser::GateDeclStmtContext *ctx);
+        std::shared_ptr<QASMNode> buildQop(QASM2Parser::QopStmtContext *ctx);
+        std::shared_ptr<QASMNode> buildIf(QASM2Parser::IfDeclStmtContext *ctx);
+        std::shared_ptr<QASMNode> buildBarrier(QASM2Parser::BarrierDeclStmtContext *ctx);
+        std::shared_ptr<QASMNode> buildUop(QASM2Parser::UopContext *ctx);
+        std::shared_ptr<ExprNode> buildExp(QASM2Parser::ExpContext *ctx);
+        Bit buildArgument(QASM2Parser::ArgumentContext *ctx);
+        void buildExpList(QASM2Parser::ExpListContext *ctx, std::vector<std::shared_ptr<ExprNode>> &exps);
+        void buildIdList(QASM2Parser::IdListContext *ctx, std::vector<std::string> &ids);
+        void buildMixedList(QASM2Parser::MixedListContext *ctx, std::vector<std::shared_ptr<Bit>> &bits);
     };
 
 } // namespace qasmcpp
@@ -0,0 +1,69 @@
+#ifndef QASM_WARMUP_H
+#define QASM_WARMUP_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace qasmcpp
+{
+
+    /**
+     * @brief Prediction warmup of the generated parser.
+     *
+     * The prediction DFAs of the parser are built lazily by adaptive
+     * prediction and shared by every parser of the process, so the first
+     * parse pays for most of them. The ANTLR runtime cannot serialize DFA
+     * states, so a snapshot is stored as the statements that created them:
+     * writeSnapshot keeps each statement of a representative workload that
+     * added DFA states, and replaying the snapshot at startup rebuilds the
+     * same states before the first real parse.
+     */
+    namespace warmup
+    {
+        /**
+         * @brief Returns a small program that exercises every rule of the grammar.
+         */
+        const char *builtinCorpus();
+
+        /**
+         * @brief Parses each statement of a source without building the AST.
+         *
+         * Syntax and semantic errors are ignored, only the prediction state is kept.
+         *
+         * @param input The statements to replay.
+         * @return The number of statements parsed.
+         * @throws std::runtime_error If the input ends inside a statement.
+         */
+        size_t replay(std::istream &input);
+
+        /**
+         * @brief Replays a snapshot file.
+         *
+         * @param path The path of the snapshot.
+         * @return False if the file cannot be opened.
+         */
+        bool replayFile(const std::string &path);
+
+        /**
+         * @brief Writes the statements of a workload that add prediction DFA states.
+         *
+         * Run it in a process that has not parsed anything yet, otherwise
+         * statements covered by earlier parses are left out.
+         *
+         * @param input The representative workload, any number of programs.
+         * @param out Receives the snapshot.
+         * @return The number of statements kept.
+         */
+        size_t writeSnapshot(std::istream &input, std::ostream &out);
+
+        /**
+         * @brief Returns the number of prediction DFA states of the process.
+         */
+        size_t dfaStateCount();
+    } // namespace warmup
+
+} // namespace qasmcpp
+
+#endif // QASM_WARMUP_H
@@ -105,13 +105,12 @@ void ResetStmtNode::dump() const {
 }
 
 // IfStmtNode Implementation
-IfStmtNode::IfStmtNode(const Bit& classicalRegister, std::shared_ptr<QASMNode> statement)
-    : classicalRegister(classicalRegister), statement(std::move(statement)) {}
+IfStmtNode::IfStmtNode(const Bit& classicalRegister, uint64_t value, std::shared_ptr<QASMNode> statement)
+    : classicalRegister(classicalRegister), value(value), statement(std::move(statement)) {}
 
 void IfStmtNode::dump() const {
-    std::cout << "if (" << classicalRegister.name << "[" << classicalRegister.index << "]) {" << std::endl;
+    std::cout << "if (" << classicalRegister.name << " == " << value << ") ";
     statement->dump();
-    std::cout << "}" << std::endl;
 }
 
 // BarrierStmtNode Implementation
@@ -0,0 +1,468 @@
+#include <fstream>
+#include <sstream>
+#include "QASM2Lexer.h"
+#include "ASTBuilder.h"
+#include "StdLib.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+ASTBuilder::ASTBuilder() : program(std::make_shared<ProgramNode>())
+{
+    program->exprPool = exprPool;
+    // gate bodies point into the pool, the table must outlive the program
+    symbolTable.exprPool = exprPool;
+}
+
+std::shared_ptr<ProgramNode> ASTBuilder::build(QASM2Parser &parser)
+{
+    if (includeDepth == 0 && !program->statements.empty())
+    {
+        program = std::make_shared<ProgramNode>();
+        program->exprPool = exprPool;
+    }
+
+    parser.setBuildParseTree(false);
+    parser.addParseListener(this);
+    parser.main();
+    parser.removeParseListener(this);
+
+    rethrow();
+    return program;
+}
+
+std::shared_ptr<QASMNode> ASTBuilder::buildStatement(QASM2Parser &parser)
+{
+    keepStatements = false;
+    completed = nullptr;
+
+    parser.setBuildParseTree(false);
+    parser.addParseListener(this);
+    if (parser.getCurrentToken()->getType() == QASM2Parser::OPENQASM)
+        parser.version();
+    else
+        parser.statement();
+    parser.removeParseListener(this);
+
+    keepStatements = true;
+    rethrow();
+    return std::move(completed);
+}
+
+void ASTBuilder::rethrow()
+{
+    if (error)
+    {
+        auto first = error;
+        error = nullptr;
+        std::rethrow_exception(first);
+    }
+}
+
+void ASTBuilder::enterEveryRule(ParserRuleContext *ctx)
+{
+    if (error)
+        return;
+
+    switch (ctx->getRuleIndex())
+    {
+    case QASM2Parser::RuleStatement:
+        statement = nullptr;
+        malformed = false;
+        inGate = false;
+        bits.clear();
+        idLists.clear();
+        break;
+    case QASM2Parser::RuleGateDeclStmt:
+        inGate = true;
+        gateBody.clear();
+        break;
+    case QASM2Parser::RuleUop:
+        exprs.clear();
+        arithOps.clear();
+        unaryOps.clear();
+        bits.clear();
+        break;
+    case QASM2Parser::RuleOpaqueDeclStmt:
+        error = std::make_exception_ptr(std::runtime_error("Opaque statement not implemented yet"));
+        break;
+    }
+}
+
+void ASTBuilder::exitEveryRule(ParserRuleContext *ctx)
+{
+    if (error)
+        return;
+
+    if (ctx->getRuleIndex() == QASM2Parser::RuleStatement)
+    {
+        if (ctx->exception == nullptr && !malformed && statement != nullptr && includeDepth == 0)
+        {
+            if (keepStatements)
+                program->statements.push_back(std::move(statement));
+            else
+                completed = std::move(statement);
+        }
+        statement = nullptr;
+        return;
+    }
+
+    // a rule that failed to match leaves its statement incomplete
+    if (ctx->exception != nullptr)
+        malformed = true;
+    if (malformed)
+        return;
+
+    // this runs in the scope guard of the generated rule, which must not throw
+    try
+    {
+        switch (ctx->getRuleIndex())
+        {
+        case QASM2Parser::RuleVersion:
+            exitVersion(static_cast<QASM2Parser::VersionContext *>(ctx));
+            break;
+        case QASM2Parser::RuleIncludeDeclStmt:
+            exitInclude(static_cast<QASM2Parser::IncludeDeclStmtContext *>(ctx));
+            break;
+        case QASM2Parser::RuleRegDeclStmt:
+            exitRegDecl(static_cast<QASM2Parser::RegDeclStmtContext *>(ctx));
+            break;
+        case QASM2Parser::RuleGateDeclStmt:
+            exitGateDecl(static_cast<QASM2Parser::GateDeclStmtContext *>(ctx));
+            break;
+        case QASM2Parser::RuleQopStmt:
+            exitQop(static_cast<QASM2Parser::QopStmtContext *>(ctx));
+            break;
+        case QASM2Parser::RuleIfDeclStmt:
+            exitIf(static_cast<QASM2Parser::IfDeclStmtContext *>(ctx));
+            break;
+        case QASM2Parser::RuleBarrierDeclStmt:
+            exitBarrier(static_cast<QASM2Parser::BarrierDeclStmtContext *>(ctx));
+            break;
+        case QASM2Parser::RuleUop:
+            exitUop(static_cast<QASM2Parser::UopContext *>(ctx));
+            break;
+        case QASM2Parser::RuleIdList:
+            exitIdList(static_cast<QASM2Parser::IdListContext *>(ctx));
+            break;
+        case QASM2Parser::RuleArgument:
+            exitArgument(static_cast<QASM2Parser::ArgumentContext *>(ctx));
+            break;
+        case QASM2Parser::RuleExp:
+            exitExp(static_cast<QASM2Parser::ExpContext *>(ctx));
+            break;
+        case QASM2Parser::RuleOp:
+            arithOps.push_back(static_cast<QASM2Parser::OpContext *>(ctx)->opType);
+            break;
+        case QASM2Parser::RuleUnaryop:
+            unaryOps.push_back(static_cast<QASM2Parser::UnaryopContext *>(ctx)->opType);
+            break;
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+}
+
+void ASTBuilder::exitVersion(QASM2Parser::VersionContext *ctx)
+{
+    if (includeDepth == 0)
+        program->version = ctx->ver;
+}
+
+void ASTBuilder::exitInclude(QASM2Parser::IncludeDeclStmtContext *ctx)
+{
+    auto includeNode = std::make_shared<IncludeDeclNode>();
+    includeNode->filename = ctx->filename;
+
+    std::string name = ctx->filename.substr(1, ctx->filename.size() - 2);
+
+    // a file loaded before, here or into the base table, adds nothing new
+    if (symbolTable.hasInclude(name))
+    {
+        statement = includeNode;
+        return;
+    }
+    symbolTable.includes.insert(name);
+
+    // a nested include runs inside the timer of the outermost one
+    PhaseTimer timer(stats && includeDepth == 0 ? &stats->includeTime : nullptr);
+
+    if (useBuiltinStdlib && stdlib::isQelib1(name))
+    {
+        stdlib::loadQelib1(symbolTable);
+        if (stats)
+            stats->includeFiles++;
+        statement = includeNode;
+        return;
+    }
+
+    std::ifstream stream(name);
+    if (!stream.is_open())
+        std::cerr << "Could not open file: " << name << std::endl;
+
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    std::string source = buffer.str();
+
+    if (stats)
+    {
+        stats->includeFiles++;
+        stats->bytesRead += source.size();
+    }
+
+    ANTLRInputStream input(source);
+    QASM2Lexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    QASM2Parser parser(&tokens);
+
+    // the included statements reset the per-statement state of this one
+    includeDepth++;
+    build(parser);
+    includeDepth--;
+
+    statement = includeNode;
+    malformed = false;
+    inGate = false;
+}
+
+void ASTBuilder::exitRegDecl(QASM2Parser::RegDeclStmtContext *ctx)
+{
+    if (ctx->ID() == nullptr || ctx->NNINTEGER() == nullptr)
+    {
+        malformed = true;
+        return;
+    }
+
+    auto regDecl = std::make_shared<RegDeclNode>();
+    regDecl->regName = ctx->ID()->getText();
+    regDecl->size = std::stoi(ctx->NNINTEGER()->getText());
+
+    if (ctx->QREG() != nullptr)
+    {
+        regDecl->regType = RegDeclNode::RegType::QREG;
+        symbolTable.addQubitRegister(regDecl->regName, regDecl->size);
+    }
+    else
+    {
+        regDecl->regType = RegDeclNode::RegType::CREG;
+        symbolTable.addCbitRegister(regDecl->regName, regDecl->size);
+    }
+    statement = regDecl;
+}
+
+void ASTBuilder::exitGateDecl(QASM2Parser::GateDeclStmtContext *ctx)
+{
+    inGate = false;
+    size_t lists = ctx->hasParams ? 2 : 1;
+    if (ctx->ID() == nullptr || idLists.size() != lists)
+    {
+        malformed = true;
+        return;
+    }
+
+    auto gateDecl = std::make_shared<GateDeclNode>();
+    auto gateDef = std::make_shared<Gate>();
+    gateDecl->gateName = ctx->ID()->getText();
+    gateDef->name = gateDecl->gateName;
+    if (ctx->hasParams)
+        gateDef->params = std::move(idLists[0]);
+
+    for (const auto &qubit : idLists.back())
+    {
+        gateDef->qubits.push_back(std::make_shared<Bit>(qubit, -1, BitType::Qubit));
+    }
+    gateDecl->body = std::move(gateBody);
+    gateBody.clear();
+    gateDef->body = gateDecl->body;
+    gateDecl->qubits = gateDef->qubits;
+    symbolTable.addGateDef(gateDef->name, gateDef);
+
+    statement = gateDecl;
+}
+
+void ASTBuilder::exitQop(QASM2Parser::QopStmtContext *ctx)
+{
+    switch (ctx->type)
+    {
+    case QASM2Parser::MEASURE:
+        if (bits.size() != 2)
+            malformed = true;
+        else
+            statement = std::make_shared<MeasureStmtNode>(bits[0], bits[1]);
+        break;
+    case QASM2Parser::RESET:
+        if (bits.size() != 1)
+            malformed = true;
+        else
+            statement = std::make_shared<ResetStmtNode>(bits[0]);
+        break;
+    default:
+        statement = std::move(uop);
+        break;
+    }
+}
+
+void ASTBuilder::exitIf(QASM2Parser::IfDeclStmtContext *ctx)
+{
+    // the qop has already left its node in statement
+    if (ctx->ID() == nullptr || ctx->NNINTEGER() == nullptr || statement == nullptr)
+    {
+        malformed = true;
+        return;
+    }
+
+    Bit creg(ctx->ID()->getText(), -1, BitType::Cbit);
+    statement = std::make_shared<IfStmtNode>(creg, std::stoull(ctx->NNINTEGER()->getText()), std::move(statement));
+}
+
+void ASTBuilder::exitBarrier(QASM2Parser::BarrierDeclStmtContext *ctx)
+{
+    statement = std::make_shared<BarrierStmtNode>(bits);
+}
+
+void ASTBuilder::exitUop(QASM2Parser::UopContext *ctx)
+{
+    std::shared_ptr<QASMNode> node;
+    switch (ctx->type)
+    {
+    case QASM2Parser::U:
+        if (exprs.size() < 3 || bits.size() != 1)
+        {
+            malformed = true;
+            return;
+        }
+        node = std::make_shared<UStmtNode>(bits[0], exprs[0], exprs[1], exprs[2]);
+        break;
+    case QASM2Parser::CX:
+        if (bits.size() != 2)
+        {
+            malformed = true;
+            return;
+        }
+        node = std::make_shared<CXStmtNode>(bits[0], bits[1]);
+        break;
+    case QASM2Parser::ID:
+    {
+        auto gateStmt = std::make_shared<GateStmtNode>(ctx->gateName, exprs, std::vector<std::shared_ptr<Bit>>());
+        gateStmt->qubits.reserve(bits.size());
+        for (const auto &bit : bits)
+        {
+            gateStmt->qubits.push_back(std::make_shared<Bit>(bit));
+        }
+        node = gateStmt;
+        break;
+    }
+    default:
+        malformed = true;
+        return;
+    }
+
+    if (inGate)
+        gateBody.push_back(std::move(node));
+    else
+        uop = std::move(node);
+}
+
+void ASTBuilder::exitArgument(QASM2Parser::ArgumentContext *ctx)
+{
+    if (ctx->ID() == nullptr)
+    {
+        malformed = true;
+        return;
+    }
+
+    int index = -1;
+    if (ctx->NNINTEGER() != nullptr)
+        index = std::stoi(ctx->NNINTEGER()->getText());
+
+    bits.emplace_back(ctx->ID()->getText(), index, BitType::Unknown);
+}
+
+void ASTBuilder::exitIdList(QASM2Parser::IdListContext *ctx)
+{
+    std::vector<std::string> ids;
+    for (auto id : ctx->ID())
+    {
+        ids.push_back(id->getText());
+    }
+    idLists.push_back(std::move(ids));
+}
+
+std::shared_ptr<ExprNode> ASTBuilder::popExpr()
+{
+    if (exprs.empty())
+    {
+        malformed = true;
+        return nullptr;
+    }
+    auto expr = std::move(exprs.back());
+    exprs.pop_back();
+    return expr;
+}
+
+void ASTBuilder::exitExp(QASM2Parser::ExpContext *ctx)
+{
+    std::shared_ptr<ExprNode> expr;
+    switch (ctx->exprType)
+    {
+    case ExprNode::NNINTEGER:
+        if (ctx->NNINTEGER() != nullptr)
+            expr = exprPool->integer(std::stoi(ctx->NNINTEGER()->getText()));
+        break;
+    case ExprNode::REAL:
+        if (ctx->REAL() != nullptr)
+            expr = exprPool->real(std::stod(ctx->REAL()->getText()));
+        break;
+    case ExprNode::ID:
+        if (ctx->ID() != nullptr)
+            expr = exprPool->identifier(ctx->ID()->getText());
+        break;
+    case ExprNode::PI:
+    {
+        const double pi = 3.1415926535897932384626433;
+        expr = exprPool->real(pi);
+        break;
+    }
+    case ExprNode::UNARY:
+    {
+        auto operand = popExpr();
+        if (operand != nullptr && !unaryOps.empty())
+        {
+            expr = exprPool->unary(unaryOps.back(), operand);
+            unaryOps.pop_back();
+        }
+        break;
+    }
+    case ExprNode::BINARY:
+    {
+        // the right operand completed last
+        auto right = popExpr();
+        auto left = popExpr();
+        if (left != nullptr && right != nullptr && !arithOps.empty())
+        {
+            expr = exprPool->binary(arithOps.back(), left, right);
+            arithOps.pop_back();
+        }
+        break;
+    }
+    case ExprNode::NAG:
+    {
+        auto operand = popExpr();
+        if (operand != nullptr)
+            expr = exprPool->unary(ExprNode::UnaryOpType::NAGATIVE, operand);
+        break;
+    }
+    case ExprNode::EXPR:
+        // the parenthesized expression is already on the stack
+        return;
+    }
+
+    if (expr == nullptr)
+    {
+        malformed = true;
+        return;
+    }
+    exprs.push_back(std::move(expr));
+}
@@ -0,0 +1,30 @@
+#include "AllocCounter.h"
+
+using namespace qasmcpp;
+
+namespace {
+    // Plain counters so operator new never triggers dynamic initialization
+    bool installed = false;
+    thread_local size_t threadAllocations = 0;
+    thread_local size_t threadBytes = 0;
+}
+
+bool alloc::hooksInstalled() {
+    return installed;
+}
+
+AllocCounts alloc::current() {
+    AllocCounts counts;
+    counts.allocations = threadAllocations;
+    counts.bytes = threadBytes;
+    return counts;
+}
+
+void alloc::installHooks() {
+    installed = true;
+}
+
+void alloc::record(size_t bytes) {
+    threadAllocations++;
+    threadBytes += bytes;
+}
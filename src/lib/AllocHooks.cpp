@@ -0,0 +1,77 @@
+// Counting replacements of the global operator new and delete.
+// Link this file into a target to enable allocation accounting (see AllocCounter.h).
+#include <cstdlib>
+#include <new>
+#include "AllocCounter.h"
+
+using namespace qasmcpp;
+
+namespace {
+    const bool hooksRegistered = (alloc::installHooks(), true);
+
+    void *countedAlloc(std::size_t size) {
+        alloc::record(size);
+        if (size == 0) {
+            size = 1;
+        }
+        for (;;) {
+            void *ptr = std::malloc(size);
+            if (ptr != nullptr) {
+                return ptr;
+            }
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr) {
+                throw std::bad_alloc();
+            }
+            handler();
+        }
+    }
+}
+
+void *operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void *operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return countedAlloc(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,48 @@
+#include <stdexcept>
+#include "Batch.h"
+#include "Driver.h"
+
+using namespace qasmcpp;
+
+BatchParser::BatchParser(std::shared_ptr<const SymbolTable> base) : base(std::move(base)) {}
+
+std::shared_ptr<const SymbolTable> BatchParser::makeBase(const std::string &prelude, bool useBuiltinStdlib)
+{
+    QASM2Driver driver;
+    driver.setUseBuiltinStdlib(useBuiltinStdlib);
+    driver.parseString(prelude);
+    if (driver.getSyntaxErrors() > 0)
+        throw std::runtime_error("Syntax errors in the batch prelude: " + std::to_string(driver.getSyntaxErrors()));
+    return std::make_shared<const SymbolTable>(driver.getSymbolTable());
+}
+
+std::vector<BatchResult> BatchParser::parse(const std::vector<std::string> &sources) const
+{
+    std::vector<BatchResult> results(sources.size());
+    long count = static_cast<long>(sources.size());
+
+    // the base is only read, each circuit writes its own result slot
+#pragma omp parallel for schedule(dynamic, 1)
+    for (long i = 0; i < count; ++i)
+    {
+        BatchResult &result = results[i];
+        QASM2Driver driver;
+        driver.setSinglePass(singlePass);
+        driver.setUseBuiltinStdlib(useBuiltinStdlib);
+        driver.setBaseSymbolTable(base);
+        try
+        {
+            result.program = driver.parseString(sources[i]);
+            result.symbolTable = driver.getSymbolTable();
+            if (driver.getSyntaxErrors() > 0)
+                result.error = "Syntax errors: " + std::to_string(driver.getSyntaxErrors());
+            else
+                result.ok = true;
+        }
+        catch (const std::exception &e)
+        {
+            result.error = e.what();
+        }
+    }
+    return results;
+}
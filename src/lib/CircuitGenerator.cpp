@@ -0,0 +1,197 @@
+#include <cstdio>
+#include <stdexcept>
+#include "CircuitGenerator.h"
+
+using namespace qasmcpp;
+
+CircuitGenerator::CircuitGenerator(uint64_t seed, bool includeStdlib) : state(seed), includeStdlib(includeStdlib) {}
+
+// SplitMix64, so the sequence is identical on every platform and standard library
+uint64_t CircuitGenerator::next() {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int CircuitGenerator::nextQubit(int qubits) {
+    return static_cast<int>(next() % static_cast<uint64_t>(qubits));
+}
+
+double CircuitGenerator::nextAngle() {
+    const double twoPi = 6.283185307179586476925286766559;
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0) * twoPi;
+}
+
+// Angles are written in fixed notation since the lexer has no exponent-only REAL
+static void writeAngle(std::ostream& out, double angle) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.10f", angle);
+    out << buffer;
+}
+
+void CircuitGenerator::writeHeader(std::ostream& out) {
+    out << "OPENQASM 2.0;\n";
+    if (includeStdlib) {
+        out << "include \"qelib1.inc\";\n";
+    }
+}
+
+void CircuitGenerator::writeMeasure(std::ostream& out, const std::string& qreg, const std::string& creg) {
+    out << "measure " << qreg << " -> " << creg << ";\n";
+}
+
+void CircuitGenerator::cliffordT(std::ostream& out, int qubits, int64_t gates) {
+    static const char *singleQubitGates[] = {"h", "s", "sdg", "t", "tdg", "x"};
+
+    writeHeader(out);
+    out << "qreg q[" << qubits << "];\n";
+    out << "creg c[" << qubits << "];\n";
+
+    for (int64_t i = 0; i < gates; ++i) {
+        int choice = static_cast<int>(next() % 7);
+        int a = nextQubit(qubits);
+        if (choice == 6 && qubits > 1) {
+            int b = nextQubit(qubits - 1);
+            if (b >= a) {
+                b++;
+            }
+            out << "cx q[" << a << "],q[" << b << "];\n";
+        } else {
+            out << singleQubitGates[choice % 6] << " q[" << a << "];\n";
+        }
+    }
+    writeMeasure(out, "q", "c");
+}
+
+void CircuitGenerator::qft(std::ostream& out, int qubits, int64_t repetitions) {
+    writeHeader(out);
+    out << "qreg q[" << qubits << "];\n";
+    out << "creg c[" << qubits << "];\n";
+
+    for (int64_t r = 0; r < repetitions; ++r) {
+        for (int j = 0; j < qubits; ++j) {
+            out << "h q[" << j << "];\n";
+            for (int k = j + 1; k < qubits; ++k) {
+                int distance = k - j;
+                out << "cu1(pi/";
+                if (distance < 31) {
+                    out << (1L << distance);
+                } else {
+                    out << "(2^" << distance << ")";
+                }
+                out << ") q[" << k << "],q[" << j << "];\n";
+            }
+        }
+        for (int j = 0; j < qubits / 2; ++j) {
+            out << "swap q[" << j << "],q[" << qubits - 1 - j << "];\n";
+        }
+    }
+    writeMeasure(out, "q", "c");
+}
+
+void CircuitGenerator::adder(std::ostream& out, int width, int64_t repetitions) {
+    writeHeader(out);
+    out << "gate majority a,b,c { cx c,b; cx c,a; ccx a,b,c; }\n";
+    out << "gate unmaj a,b,c { ccx a,b,c; cx c,a; cx a,b; }\n";
+    out << "qreg cin[1];\n";
+    out << "qreg a[" << width << "];\n";
+    out << "qreg b[" << width << "];\n";
+    out << "qreg cout[1];\n";
+    out << "creg ans[" << width + 1 << "];\n";
+
+    // random addends
+    for (int i = 0; i < width; ++i) {
+        if (next() & 1) {
+            out << "x a[" << i << "];\n";
+        }
+        if (next() & 1) {
+            out << "x b[" << i << "];\n";
+        }
+    }
+
+    // Cuccaro ripple-carry adder, b <- a + b
+    for (int64_t r = 0; r < repetitions; ++r) {
+        out << "majority cin[0],b[0],a[0];\n";
+        for (int i = 1; i < width; ++i) {
+            out << "majority a[" << i - 1 << "],b[" << i << "],a[" << i << "];\n";
+        }
+        out << "cx a[" << width - 1 << "],cout[0];\n";
+        for (int i = width - 1; i > 0; --i) {
+            out << "unmaj a[" << i - 1 << "],b[" << i << "],a[" << i << "];\n";
+        }
+        out << "unmaj cin[0],b[0],a[0];\n";
+    }
+
+    for (int i = 0; i < width; ++i) {
+        out << "measure b[" << i << "] -> ans[" << i << "];\n";
+    }
+    out << "measure cout[0] -> ans[" << width << "];\n";
+}
+
+void CircuitGenerator::vqe(std::ostream& out, int qubits, int64_t layers) {
+    writeHeader(out);
+    out << "qreg q[" << qubits << "];\n";
+    out << "creg c[" << qubits << "];\n";
+
+    for (int64_t layer = 0; layer < layers; ++layer) {
+        for (int i = 0; i < qubits; ++i) {
+            out << "u3(";
+            writeAngle(out, nextAngle());
+            out << ",";
+            writeAngle(out, nextAngle());
+            out << ",";
+            writeAngle(out, nextAngle());
+            out << ") q[" << i << "];\n";
+        }
+        for (int i = 0; i + 1 < qubits; ++i) {
+            out << "cx q[" << i << "],q[" << i + 1 << "];\n";
+        }
+    }
+    writeMeasure(out, "q", "c");
+}
+
+void CircuitGenerator::nested(std::ostream& out, int qubits, int depth, int64_t gates) {
+    // every gate of the hierarchy acts on two distinct qubits
+    if (qubits < 2) {
+        throw std::invalid_argument("Nested circuits need at least 2 qubits");
+    }
+
+    writeHeader(out);
+    out << "gate g0(theta) a,b { u3(theta,0,0) a; cx a,b; u1(theta) b; }\n";
+    for (int level = 1; level <= depth; ++level) {
+        out << "gate g" << level << "(theta) a,b { "
+            << "g" << level - 1 << "(theta/2) a,b; "
+            << "g" << level - 1 << "(theta/2) b,a; }\n";
+    }
+    out << "qreg q[" << qubits << "];\n";
+    out << "creg c[" << qubits << "];\n";
+
+    for (int64_t i = 0; i < gates; ++i) {
+        int a = nextQubit(qubits);
+        int b = nextQubit(qubits - 1);
+        if (b >= a) {
+            b++;
+        }
+        out << "g" << depth << "(";
+        writeAngle(out, nextAngle());
+        out << ") q[" << a << "],q[" << b << "];\n";
+    }
+    writeMeasure(out, "q", "c");
+}
+
+void CircuitGenerator::generate(std::ostream& out, const std::string& kind, int qubits, int64_t size, int depth) {
+    if (kind == "clifford_t") {
+        cliffordT(out, qubits, size);
+    } else if (kind == "qft") {
+        qft(out, qubits, size);
+    } else if (kind == "adder") {
+        adder(out, qubits, size);
+    } else if (kind == "vqe") {
+        vqe(out, qubits, size);
+    } else if (kind == "nested") {
+        nested(out, qubits, depth, size);
+    } else {
+        throw std::invalid_argument("Unknown circuit kind: " + kind);
+    }
+}
@@ -0,0 +1,35 @@
+#include <algorithm>
+#include "ClassicalState.h"
+
+using namespace qasmcpp;
+
+ClassicalState::ClassicalState(const Circuit &circuit)
+    : wordOf(circuit.numCbits, 0), shiftOf(circuit.numCbits, 0)
+{
+    // each creg starts a new word, as the lowering lays out the conditions
+    int numWords = 0;
+    for (const auto &creg : circuit.cregs)
+    {
+        for (int i = 0; i < creg.size; ++i)
+        {
+            wordOf[creg.offset + i] = numWords + i / 64;
+            shiftOf[creg.offset + i] = i % 64;
+        }
+        numWords += (creg.size + 63) / 64;
+    }
+    words.assign(numWords, 0);
+}
+
+void ClassicalState::clear()
+{
+    std::fill(words.begin(), words.end(), 0);
+}
+
+void ClassicalState::toBits(std::vector<int> &cbits) const
+{
+    cbits.resize(wordOf.size());
+    for (size_t cbit = 0; cbit < wordOf.size(); ++cbit)
+    {
+        cbits[cbit] = get(static_cast<int>(cbit));
+    }
+}
@@ -0,0 +1,59 @@
+#include "Diagnostics.h"
+
+using namespace qasmcpp;
+
+void DiagnosticSink::report(DiagCode code, const std::string &source, size_t line, size_t column, const std::string &message)
+{
+    diagnostics.push_back(Diagnostic{code, source, line, column, message});
+}
+
+void DiagnosticSink::print(std::ostream &out) const
+{
+    for (const auto &diagnostic : diagnostics)
+    {
+        out << diagnostic.source << ":" << diagnostic.line << ":" << diagnostic.column
+            << ": error: " << diagnostic.message << " [" << codeName(diagnostic.code) << "]" << std::endl;
+    }
+}
+
+const char *DiagnosticSink::codeName(DiagCode code)
+{
+    switch (code)
+    {
+    case DiagCode::SyntaxError:
+        return "syntax-error";
+    case DiagCode::UnsupportedVersion:
+        return "unsupported-version";
+    case DiagCode::IncludeNotFound:
+        return "include-not-found";
+    case DiagCode::IncludeTooDeep:
+        return "include-too-deep";
+    case DiagCode::DuplicateRegister:
+        return "duplicate-register";
+    case DiagCode::DuplicateGate:
+        return "duplicate-gate";
+    case DiagCode::DuplicateArgument:
+        return "duplicate-argument";
+    case DiagCode::InvalidSize:
+        return "invalid-size";
+    case DiagCode::UndefinedRegister:
+        return "undefined-register";
+    case DiagCode::UndefinedGate:
+        return "undefined-gate";
+    case DiagCode::UndefinedIdentifier:
+        return "undefined-identifier";
+    case DiagCode::WrongRegisterKind:
+        return "wrong-register-kind";
+    case DiagCode::IndexOutOfRange:
+        return "index-out-of-range";
+    case DiagCode::WrongArgumentCount:
+        return "wrong-argument-count";
+    case DiagCode::RegisterSizeMismatch:
+        return "register-size-mismatch";
+    case DiagCode::DuplicateQubit:
+        return "duplicate-qubit";
+    case DiagCode::ValueOutOfRange:
+        return "value-out-of-range";
+    }
+    return "unknown";
+}
@@ -0,0 +1,190 @@
+#include <fstream>
+#include <sstream>
+#include <antlr4-runtime.h>
+#include "QASM2Lexer.h"
+#include "QASM2Parser.h"
+#include "Driver.h"
+#include "Visitor.h"
+#include "ASTBuilder.h"
+#include "Expr.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+namespace {
+    // Keeps the syntax errors of the lexer and parser as "line:column message"
+    class CollectingErrorListener : public BaseErrorListener {
+    public:
+        explicit CollectingErrorListener(std::vector<std::string>& messages) : messages(messages) {}
+
+        void syntaxError(Recognizer *recognizer, Token *offendingSymbol, size_t line, size_t charPositionInLine,
+                         const std::string& msg, std::exception_ptr e) override {
+            messages.push_back(std::to_string(line) + ":" + std::to_string(charPositionInLine + 1) + " " + msg);
+        }
+
+    private:
+        std::vector<std::string>& messages;
+    };
+}
+
+// Count the nodes of a parse tree without recursion
+static size_t countParseTreeNodes(tree::ParseTree *root) {
+    size_t count = 0;
+    std::vector<tree::ParseTree *> stack = {root};
+    while (!stack.empty()) {
+        tree::ParseTree *node = stack.back();
+        stack.pop_back();
+        count++;
+        for (auto child : node->children) {
+            stack.push_back(child);
+        }
+    }
+    return count;
+}
+
+// Count an expression node and its operands
+static size_t countExprNodes(const std::shared_ptr<ExprNode>& expr) {
+    if (expr == nullptr) {
+        return 0;
+    }
+    switch (expr->getExpType()) {
+    case ExprNode::UNARY:
+        return 1 + countExprNodes(std::static_pointer_cast<UnaryExprNode>(expr)->operand);
+    case ExprNode::BINARY: {
+        auto binary = std::static_pointer_cast<BinaryExprNode>(expr);
+        return 1 + countExprNodes(binary->left) + countExprNodes(binary->right);
+    }
+    default:
+        return 1;
+    }
+}
+
+// Count a statement node together with its nested statements and expressions
+static size_t countAstNodes(const std::shared_ptr<QASMNode>& node) {
+    size_t count = 1;
+    if (auto gateDecl = std::dynamic_pointer_cast<GateDeclNode>(node)) {
+        for (const auto& stmt : gateDecl->body) {
+            count += countAstNodes(stmt);
+        }
+    } else if (auto gateStmt = std::dynamic_pointer_cast<GateStmtNode>(node)) {
+        for (const auto& param : gateStmt->params) {
+            count += countExprNodes(param);
+        }
+    } else if (auto uStmt = std::dynamic_pointer_cast<UStmtNode>(node)) {
+        count += countExprNodes(uStmt->theta) + countExprNodes(uStmt->phi) + countExprNodes(uStmt->lambda);
+    } else if (auto ifStmt = std::dynamic_pointer_cast<IfStmtNode>(node)) {
+        count += countAstNodes(ifStmt->statement);
+    }
+    return count;
+}
+
+std::shared_ptr<ProgramNode> QASM2Driver::parseFile(const std::string& path) {
+    std::ifstream stream(path);
+    if (!stream.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    return parseString(buffer.str());
+}
+
+std::shared_ptr<ProgramNode> QASM2Driver::parseString(const std::string& source) {
+    ANTLRInputStream input(source);
+    return parse(input, source.size());
+}
+
+std::shared_ptr<ProgramNode> QASM2Driver::parse(ANTLRInputStream& input, size_t bytes) {
+    stats.reset();
+    syntaxErrors = 0;
+    syntaxErrorMessages.clear();
+    ParseStats *st = collectStats ? &stats : nullptr;
+    PhaseTimer totalTimer(st ? &stats.totalTime : nullptr);
+
+    CollectingErrorListener listener(syntaxErrorMessages);
+    QASM2Lexer lexer(&input);
+    if (collectSyntaxErrors) {
+        lexer.removeErrorListeners();
+        lexer.addErrorListener(&listener);
+    }
+    CommonTokenStream tokens(&lexer);
+    {
+        PhaseTimer timer(st ? &stats.lexTime : nullptr);
+        AllocScope allocs(st ? &stats.lexAllocations : nullptr);
+        tokens.fill();
+    }
+
+    QASM2Parser parser(&tokens);
+    if (collectSyntaxErrors) {
+        parser.removeErrorListeners();
+        parser.addErrorListener(&listener);
+    }
+    // setProfile swaps in a new simulator but leaves the replaced one to the caller
+    std::unique_ptr<atn::ParserATNSimulator> replaced;
+    if (st && profilePredictions) {
+        // The profiling simulator records SLL predictions and LL fallbacks
+        replaced.reset(parser.getInterpreter<atn::ParserATNSimulator>());
+        parser.setProfile(true);
+    }
+
+    QASM2Parser::MainContext *tree = nullptr;
+    std::shared_ptr<ProgramNode> program;
+    if (singlePass) {
+        // the AST is built while parsing, the parse and visit phases are one
+        ASTBuilder builder;
+        builder.setStats(st);
+        builder.setUseBuiltinStdlib(useBuiltinStdlib);
+        builder.setBaseSymbolTable(baseSymbolTable);
+        {
+            PhaseTimer timer(st ? &stats.parseTime : nullptr);
+            AllocScope allocs(st ? &stats.parseAllocations : nullptr);
+            program = builder.build(parser);
+        }
+        symbolTable = builder.getSymbolTable();
+    } else {
+        {
+            PhaseTimer timer(st ? &stats.parseTime : nullptr);
+            AllocScope allocs(st ? &stats.parseAllocations : nullptr);
+            tree = parser.main();
+        }
+
+        QASM2Visitor visitor;
+        visitor.setStats(st);
+        visitor.setUseBuiltinStdlib(useBuiltinStdlib);
+        visitor.setBaseSymbolTable(baseSymbolTable);
+        {
+            PhaseTimer timer(st ? &stats.visitTime : nullptr);
+            AllocScope allocs(st ? &stats.visitAllocations : nullptr);
+            visitor.visit(tree);
+        }
+
+        program = visitor.getProgram();
+        symbolTable = visitor.getSymbolTable();
+    }
+
+    syntaxErrors = parser.getNumberOfSyntaxErrors();
+
+    if (st) {
+        (singlePass ? stats.parseTime : stats.visitTime) -= stats.includeTime;
+        stats.bytesRead += bytes;
+        stats.tokens = tokens.size();
+        stats.parseTreeNodes = tree != nullptr ? countParseTreeNodes(tree) : 0;
+        for (const auto& statement : program->statements) {
+            stats.astNodes += countAstNodes(statement);
+        }
+
+        for (const auto& dfa : parser.getInterpreter<atn::ParserATNSimulator>()->decisionToDFA) {
+            stats.dfaStates += dfa.states.size();
+        }
+
+        auto profiler = dynamic_cast<atn::ProfilingATNSimulator *>(parser.getInterpreter<atn::ParserATNSimulator>());
+        if (profiler != nullptr) {
+            for (const auto& decision : profiler->getDecisionInfo()) {
+                stats.predictions += decision.invocations;
+                stats.llFallbacks += decision.LL_Fallback;
+            }
+        }
+    }
+
+    return program;
+}
@@ -1,4 +1,334 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 #include "Expr.h"
 
+using namespace qasmcpp;
 
-// Implement the Expr class hee
\ No newline at end of file
+static double applyUnary(int op, double operand)
+{
+    switch (op)
+    {
+    case ExprNode::UnaryOpType::SIN: return std::sin(operand);
+    case ExprNode::UnaryOpType::COS: return std::cos(operand);
+    case ExprNode::UnaryOpType::TAN: return std::tan(operand);
+    case ExprNode::UnaryOpType::EXP: return std::exp(operand);
+    case ExprNode::UnaryOpType::LN: return std::log(operand);
+    case ExprNode::UnaryOpType::SQRT: return std::sqrt(operand);
+    case ExprNode::UnaryOpType::NAGATIVE: return -operand;
+    }
+    throw std::runtime_error("Expression not implemented yet");
+}
+
+static double applyBinary(int op, double left, double right)
+{
+    switch (op)
+    {
+    case ExprNode::ArithOpType::PLUS: return left + right;
+    case ExprNode::ArithOpType::MINUS: return left - right;
+    case ExprNode::ArithOpType::TIMES: return left * right;
+    case ExprNode::ArithOpType::DIVIDE: return left / right;
+    case ExprNode::ArithOpType::POWER: return std::pow(left, right);
+    }
+    throw std::runtime_error("Expression not implemented yet");
+}
+
+ExprTape::ExprTape(size_t numParams) : numParams(numParams)
+{
+    for (size_t i = 0; i < numParams; ++i)
+    {
+        nodes.push_back(Node{ExprNode::ID, 0, static_cast<int>(i), -1, 0});
+    }
+}
+
+int ExprTape::constant(double value)
+{
+    nodes.push_back(Node{ExprNode::REAL, 0, -1, -1, value});
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+int ExprTape::unary(int op, int operand)
+{
+    nodes.push_back(Node{ExprNode::UNARY, op, operand, -1, 0});
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+int ExprTape::binary(int op, int left, int right)
+{
+    nodes.push_back(Node{ExprNode::BINARY, op, left, right, 0});
+    return static_cast<int>(nodes.size()) - 1;
+}
+
+void ExprTape::evaluate(const std::vector<double> &params, std::vector<double> &values) const
+{
+    if (params.size() != numParams)
+        throw std::runtime_error("Expected " + std::to_string(numParams) + " parameter values, got " + std::to_string(params.size()));
+
+    values.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const Node &node = nodes[i];
+        switch (node.type)
+        {
+        case ExprNode::ID: values[i] = params[node.left]; break;
+        case ExprNode::REAL: values[i] = node.value; break;
+        case ExprNode::UNARY: values[i] = applyUnary(node.op, values[node.left]); break;
+        case ExprNode::BINARY: values[i] = applyBinary(node.op, values[node.left], values[node.right]); break;
+        }
+    }
+}
+
+// Stamp of memoized constants, valid in every binding
+static const uint32_t kConstantStamp = UINT32_MAX;
+
+static void appendId(std::string &key, int id)
+{
+    key.append(reinterpret_cast<const char *>(&id), sizeof(id));
+}
+
+std::shared_ptr<ExprNode> ExprPool::integer(int value)
+{
+    std::string key = "i" + std::to_string(value);
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        reuses++;
+        return nodes[it->second];
+    }
+    return add(std::move(key), std::make_shared<NNIntegerLiteralNode>(value), true);
+}
+
+std::shared_ptr<ExprNode> ExprPool::real(double value)
+{
+    std::string key = "r";
+    key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        reuses++;
+        return nodes[it->second];
+    }
+    return add(std::move(key), std::make_shared<RealLiteralNode>(value), true);
+}
+
+std::shared_ptr<ExprNode> ExprPool::identifier(const std::string &name)
+{
+    std::string key = "n" + name;
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        reuses++;
+        return nodes[it->second];
+    }
+    return add(std::move(key), std::make_shared<IdentifierNode>(name), false);
+}
+
+std::shared_ptr<ExprNode> ExprPool::unary(int op, const std::shared_ptr<ExprNode> &operand)
+{
+    int operandId = childId(operand);
+    std::string key = "u";
+    key += static_cast<char>(op);
+    appendId(key, operandId);
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        reuses++;
+        return nodes[it->second];
+    }
+    const auto &child = nodes[operandId];
+    return add(std::move(key), std::make_shared<UnaryExprNode>(op, child), child->constant);
+}
+
+std::shared_ptr<ExprNode> ExprPool::binary(int op, const std::shared_ptr<ExprNode> &left, const std::shared_ptr<ExprNode> &right)
+{
+    int leftId = childId(left);
+    int rightId = childId(right);
+    std::string key = "b";
+    key += static_cast<char>(op);
+    appendId(key, leftId);
+    appendId(key, rightId);
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        reuses++;
+        return nodes[it->second];
+    }
+    const auto &l = nodes[leftId];
+    const auto &r = nodes[rightId];
+    return add(std::move(key), std::make_shared<BinaryExprNode>(op, l, r), l->constant && r->constant);
+}
+
+std::shared_ptr<ExprNode> ExprPool::intern(const std::shared_ptr<ExprNode> &expr)
+{
+    if (expr->pool == this)
+        return expr;
+
+    switch (expr->getExpType())
+    {
+    case ExprNode::NNINTEGER:
+        return integer(static_cast<const NNIntegerLiteralNode &>(*expr).value);
+    case ExprNode::REAL:
+        return real(static_cast<const RealLiteralNode &>(*expr).value);
+    case ExprNode::ID:
+        return identifier(static_cast<const IdentifierNode &>(*expr).name);
+    case ExprNode::UNARY:
+    {
+        const auto &node = static_cast<const UnaryExprNode &>(*expr);
+        return unary(node.op, node.operand);
+    }
+    case ExprNode::BINARY:
+    {
+        const auto &node = static_cast<const BinaryExprNode &>(*expr);
+        return binary(node.op, node.left, node.right);
+    }
+    }
+    throw std::runtime_error("Expression not implemented yet");
+}
+
+std::shared_ptr<ExprNode> ExprPool::add(std::string key, std::shared_ptr<ExprNode> node, bool constant)
+{
+    node->pool = this;
+    node->id = static_cast<int>(nodes.size());
+    node->constant = constant;
+    index.emplace(std::move(key), node->id);
+    nodes.push_back(node);
+    return node;
+}
+
+int ExprPool::childId(const std::shared_ptr<ExprNode> &child)
+{
+    return child->pool == this ? child->id : intern(child)->id;
+}
+
+void ExprEvaluator::bind(const std::vector<std::string> &params, const std::vector<double> &values)
+{
+    if (this->params == &params && this->values == values)
+        return;
+    this->params = &params;
+    this->values = values;
+    if (++generation == kConstantStamp)
+    {
+        // the stamps wrapped around, forget every non-constant result
+        for (auto &memo : memos)
+        {
+            for (auto &stamp : memo.stamps)
+            {
+                stamp = stamp == kConstantStamp ? kConstantStamp : 0;
+            }
+        }
+        generation = 1;
+    }
+}
+
+double ExprEvaluator::evaluate(const ExprNode &expr)
+{
+    if (expr.pool == nullptr)
+        return compute(expr);
+
+    uint32_t stamp = expr.constant ? kConstantStamp : generation;
+    Memo *memo = &memoFor(expr.pool);
+    if (static_cast<size_t>(expr.id) < memo->stamps.size() && memo->stamps[expr.id] == stamp)
+        return memo->values[expr.id];
+
+    double value = compute(expr);
+    memo = &memoFor(expr.pool);
+    if (static_cast<size_t>(expr.id) >= memo->stamps.size())
+    {
+        // the pool may have grown since the memo was sized
+        size_t size = std::max(expr.pool->size(), static_cast<size_t>(expr.id) + 1);
+        memo->values.resize(size);
+        memo->stamps.resize(size, 0);
+    }
+    memo->values[expr.id] = value;
+    memo->stamps[expr.id] = stamp;
+    return value;
+}
+
+ExprEvaluator::Memo &ExprEvaluator::memoFor(const ExprPool *pool)
+{
+    // a lowering sees a handful of pools, the program's and the standard library's
+    for (auto &memo : memos)
+    {
+        if (memo.pool == pool)
+            return memo;
+    }
+    memos.push_back(Memo{pool, {}, {}});
+    return memos.back();
+}
+
+double ExprEvaluator::compute(const ExprNode &expr)
+{
+    computed++;
+    switch (expr.getExpType())
+    {
+    case ExprNode::NNINTEGER:
+        return static_cast<const NNIntegerLiteralNode &>(expr).value;
+    case ExprNode::REAL:
+        return static_cast<const RealLiteralNode &>(expr).value;
+    case ExprNode::ID:
+    {
+        const std::string &name = static_cast<const IdentifierNode &>(expr).name;
+        for (size_t i = 0; params != nullptr && i < params->size(); ++i)
+        {
+            if ((*params)[i] == name)
+                return values[i];
+        }
+        throw std::runtime_error("Unknown parameter: " + name);
+    }
+    case ExprNode::UNARY:
+    {
+        const auto &unary = static_cast<const UnaryExprNode &>(expr);
+        double operand = evaluate(*unary.operand);
+        return applyUnary(unary.op, operand);
+    }
+    case ExprNode::BINARY:
+    {
+        const auto &binary = static_cast<const BinaryExprNode &>(expr);
+        double left = evaluate(*binary.left);
+        double right = evaluate(*binary.right);
+        return applyBinary(binary.op, left, right);
+    }
+    }
+    throw std::runtime_error("Expression not implemented yet");
+}
+
+int ExprEvaluator::compile(const ExprNode &expr, const std::vector<int> &symbols, ExprTape &tape)
+{
+    if (expr.pool != nullptr && expr.constant)
+        return -1;
+
+    switch (expr.getExpType())
+    {
+    case ExprNode::ID:
+    {
+        const std::string &name = static_cast<const IdentifierNode &>(expr).name;
+        for (size_t i = 0; params != nullptr && i < params->size(); ++i)
+        {
+            if ((*params)[i] == name)
+                return symbols[i];
+        }
+        throw std::runtime_error("Unknown parameter: " + name);
+    }
+    case ExprNode::UNARY:
+    {
+        const auto &unary = static_cast<const UnaryExprNode &>(expr);
+        int operand = compile(*unary.operand, symbols, tape);
+        return operand < 0 ? -1 : tape.unary(unary.op, operand);
+    }
+    case ExprNode::BINARY:
+    {
+        const auto &binary = static_cast<const BinaryExprNode &>(expr);
+        int left = compile(*binary.left, symbols, tape);
+        int right = compile(*binary.right, symbols, tape);
+        if (left < 0 && right < 0)
+            return -1;
+        // the fixed side is computed now, only the free side is left to the tape
+        if (left < 0)
+            left = tape.constant(evaluate(*binary.left));
+        if (right < 0)
+            right = tape.constant(evaluate(*binary.right));
+        return tape.binary(binary.op, left, right);
+    }
+    }
+    return -1;
+}
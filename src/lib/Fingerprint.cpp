@@ -0,0 +1,364 @@
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include "Fingerprint.h"
+#include "Expr.h"
+#include "StdLib.h"
+
+using namespace qasmcpp;
+
+// Tags that keep the hashes of different kinds of items apart
+enum Tag : uint64_t
+{
+    TAG_QREG = 1,
+    TAG_CREG,
+    TAG_INCLUDE,
+    TAG_U,
+    TAG_CX,
+    TAG_GATE,
+    TAG_MEASURE,
+    TAG_RESET,
+    TAG_BARRIER,
+    TAG_IF,
+    TAG_CONSTANT,
+    TAG_PARAM,
+    TAG_UNARY,
+    TAG_BINARY,
+    TAG_NAMED_GATE,
+};
+
+namespace
+{
+
+    // Finalizer of splitmix64, spreads every input bit over the output
+    uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    class Hasher
+    {
+    public:
+        inline void add(uint64_t value) { state = mix(state ^ (value + 0x9E3779B97F4A7C15ULL + (state << 6) + (state >> 2))); }
+
+        void add(const std::string &text)
+        {
+            add(static_cast<uint64_t>(text.size()));
+            for (unsigned char c : text)
+            {
+                add(static_cast<uint64_t>(c));
+            }
+        }
+
+        inline uint64_t value() const { return state; }
+
+    private:
+        uint64_t state = 0;
+    };
+
+    uint64_t constantHash(double value)
+    {
+        // adding zero folds -0.0 into 0.0
+        value += 0.0;
+        if (std::isfinite(value) && std::abs(value) < 1e9)
+            return static_cast<uint64_t>(std::llround(std::ldexp(value, 32)));
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    bool isConstant(const ExprNode &expr)
+    {
+        if (expr.pool != nullptr)
+            return expr.constant;
+        switch (expr.getExpType())
+        {
+        case ExprNode::ID:
+            return false;
+        case ExprNode::UNARY:
+            return isConstant(*static_cast<const UnaryExprNode &>(expr).operand);
+        case ExprNode::BINARY:
+        {
+            const auto &binary = static_cast<const BinaryExprNode &>(expr);
+            return isConstant(*binary.left) && isConstant(*binary.right);
+        }
+        }
+        return true;
+    }
+
+    class Fingerprinter
+    {
+    public:
+        explicit Fingerprinter(const SymbolTable &symbolTable) : symbolTable(symbolTable)
+        {
+            evaluator.bind(noParams, noValues);
+        }
+
+        void statement(const QASMNode &node, Fingerprint &result, Hasher &registers, Hasher &instructions)
+        {
+            if (auto regDecl = dynamic_cast<const RegDeclNode *>(&node))
+            {
+                bool quantum = regDecl->regType == RegDeclNode::RegType::QREG;
+                auto &indices = quantum ? qregs : cregs;
+                indices[regDecl->regName] = static_cast<uint64_t>(indices.size());
+                registers.add(quantum ? TAG_QREG : TAG_CREG);
+                registers.add(static_cast<uint64_t>(regDecl->size));
+            }
+            else if (auto gateDecl = dynamic_cast<const GateDeclNode *>(&node))
+            {
+                auto gate = symbolTable.findGateDef(gateDecl->gateName);
+                if (gate == nullptr)
+                    throw std::runtime_error("Undefined gate: " + gateDecl->gateName);
+                uint64_t hash = gateHash(*gate);
+                gateHashes[gateDecl->gateName] = hash;
+                // a sum does not depend on the order of the definitions
+                result.gates += mix(hash);
+            }
+            else if (auto include = dynamic_cast<const IncludeDeclNode *>(&node))
+            {
+                // the gates of the file are hashed by their bodies where they are applied
+                instructions.add(TAG_INCLUDE);
+                instructions.add(include->filename);
+            }
+            else if (auto ifStmt = dynamic_cast<const IfStmtNode *>(&node))
+            {
+                instructions.add(TAG_IF);
+                instructions.add(registerIndex(ifStmt->classicalRegister.name, false));
+                instructions.add(ifStmt->value);
+                if (ifStmt->statement)
+                    statement(*ifStmt->statement, result, registers, instructions);
+            }
+            else if (dynamic_cast<const VersionDeclNode *>(&node) == nullptr)
+            {
+                operation(node, nullptr, nullptr, instructions);
+            }
+        }
+
+    private:
+        // a gate application, with params and qubits set to the scope of a gate body
+        void operation(const QASMNode &node, const Gate *scope, const std::vector<std::string> *params, Hasher &hasher)
+        {
+            if (auto u = dynamic_cast<const UStmtNode *>(&node))
+            {
+                hasher.add(TAG_U);
+                hasher.add(exprHash(*u->theta, params));
+                hasher.add(exprHash(*u->phi, params));
+                hasher.add(exprHash(*u->lambda, params));
+                operand(u->qubit, scope, hasher);
+            }
+            else if (auto cx = dynamic_cast<const CXStmtNode *>(&node))
+            {
+                hasher.add(TAG_CX);
+                operand(cx->controlQubit, scope, hasher);
+                operand(cx->targetQubit, scope, hasher);
+            }
+            else if (auto gateStmt = dynamic_cast<const GateStmtNode *>(&node))
+            {
+                hasher.add(TAG_GATE);
+                hasher.add(calleeHash(gateStmt->gateName));
+                hasher.add(static_cast<uint64_t>(gateStmt->params.size()));
+                for (const auto &param : gateStmt->params)
+                {
+                    hasher.add(exprHash(*param, params));
+                }
+                for (const auto &qubit : gateStmt->qubits)
+                {
+                    operand(*qubit, scope, hasher);
+                }
+            }
+            else if (auto barrier = dynamic_cast<const BarrierStmtNode *>(&node))
+            {
+                hasher.add(TAG_BARRIER);
+                hasher.add(static_cast<uint64_t>(barrier->qubits.size()));
+                for (const auto &qubit : barrier->qubits)
+                {
+                    operand(qubit, scope, hasher);
+                }
+            }
+            else if (auto measure = dynamic_cast<const MeasureStmtNode *>(&node))
+            {
+                hasher.add(TAG_MEASURE);
+                operand(measure->qubit, scope, hasher);
+                hasher.add(registerIndex(measure->classicalRegister.name, false));
+                hasher.add(static_cast<uint64_t>(measure->classicalRegister.index));
+            }
+            else if (auto reset = dynamic_cast<const ResetStmtNode *>(&node))
+            {
+                hasher.add(TAG_RESET);
+                operand(reset->qubit, scope, hasher);
+            }
+        }
+
+        uint64_t gateHash(const Gate &gate)
+        {
+            Hasher hasher;
+            hasher.add(static_cast<uint64_t>(gate.params.size()));
+            hasher.add(static_cast<uint64_t>(gate.qubits.size()));
+            for (const auto &statement : gate.body)
+            {
+                operation(*statement, &gate, &gate.params, hasher);
+            }
+            return hasher.value();
+        }
+
+        uint64_t calleeHash(const std::string &name)
+        {
+            auto it = gateHashes.find(name);
+            if (it != gateHashes.end())
+                return it->second;
+
+            // a gate from an include or the base table is hashed by its body,
+            // only the fixed built-in qelib1 gates are identified by name
+            auto gate = symbolTable.findGateDef(name);
+            uint64_t hash;
+            if (gate != nullptr && !isBuiltin(*gate))
+            {
+                hash = gateHash(*gate);
+            }
+            else
+            {
+                Hasher hasher;
+                hasher.add(TAG_NAMED_GATE);
+                hasher.add(name);
+                hash = hasher.value();
+            }
+            gateHashes[name] = hash;
+            return hash;
+        }
+
+        static bool isBuiltin(const Gate &gate)
+        {
+            for (const auto &definition : stdlib::qelib1Definitions())
+            {
+                if (definition.get() == &gate)
+                    return true;
+            }
+            return false;
+        }
+
+        // a qubit argument of the enclosing gate, or a register and index at the top level
+        void operand(const Bit &bit, const Gate *scope, Hasher &hasher)
+        {
+            if (scope == nullptr)
+            {
+                hasher.add(registerIndex(bit.name, true));
+                hasher.add(static_cast<uint64_t>(bit.index));
+                return;
+            }
+            for (size_t i = 0; i < scope->qubits.size(); ++i)
+            {
+                if (scope->qubits[i]->name == bit.name)
+                {
+                    hasher.add(static_cast<uint64_t>(i));
+                    return;
+                }
+            }
+            throw std::runtime_error("Unknown qubit " + bit.name + " in gate: " + scope->name);
+        }
+
+        uint64_t registerIndex(const std::string &name, bool quantum) const
+        {
+            const auto &indices = quantum ? qregs : cregs;
+            auto it = indices.find(name);
+            if (it == indices.end())
+                throw std::runtime_error((quantum ? "Undefined qreg: " : "Undefined creg: ") + name);
+            return it->second;
+        }
+
+        uint64_t exprHash(const ExprNode &expr, const std::vector<std::string> *params)
+        {
+            Hasher hasher;
+            if (isConstant(expr))
+            {
+                // the evaluator memoizes pooled constants, so shared ones are computed once
+                hasher.add(TAG_CONSTANT);
+                hasher.add(constantHash(evaluator.evaluate(expr)));
+                return hasher.value();
+            }
+
+            switch (expr.getExpType())
+            {
+            case ExprNode::ID:
+            {
+                const std::string &name = static_cast<const IdentifierNode &>(expr).name;
+                hasher.add(TAG_PARAM);
+                for (size_t i = 0; params != nullptr && i < params->size(); ++i)
+                {
+                    if ((*params)[i] == name)
+                    {
+                        hasher.add(static_cast<uint64_t>(i));
+                        return hasher.value();
+                    }
+                }
+                // a free parameter of a template keeps its name
+                hasher.add(name);
+                return hasher.value();
+            }
+            case ExprNode::UNARY:
+            {
+                const auto &unary = static_cast<const UnaryExprNode &>(expr);
+                hasher.add(TAG_UNARY);
+                hasher.add(static_cast<uint64_t>(unary.op));
+                hasher.add(exprHash(*unary.operand, params));
+                return hasher.value();
+            }
+            case ExprNode::BINARY:
+            {
+                const auto &binary = static_cast<const BinaryExprNode &>(expr);
+                hasher.add(TAG_BINARY);
+                hasher.add(static_cast<uint64_t>(binary.op));
+                hasher.add(exprHash(*binary.left, params));
+                hasher.add(exprHash(*binary.right, params));
+                return hasher.value();
+            }
+            }
+            throw std::runtime_error("Expression not implemented yet");
+        }
+
+        const std::vector<std::string> noParams;
+        const std::vector<double> noValues;
+        const SymbolTable &symbolTable;
+        ExprEvaluator evaluator;
+        std::unordered_map<std::string, uint64_t> gateHashes;
+        std::unordered_map<std::string, uint64_t> qregs;
+        std::unordered_map<std::string, uint64_t> cregs;
+    };
+
+} // namespace
+
+std::string Fingerprint::toHex() const
+{
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 0; i < 16; ++i)
+    {
+        text[15 - i] = digits[(hash >> (4 * i)) & 0xF];
+    }
+    return text;
+}
+
+Fingerprint qasmcpp::fingerprint(const ProgramNode &program, const SymbolTable &symbolTable)
+{
+    Fingerprint result;
+    Hasher registers, instructions;
+    Fingerprinter fingerprinter(symbolTable);
+    for (const auto &statement : program.statements)
+    {
+        fingerprinter.statement(*statement, result, registers, instructions);
+    }
+
+    result.registers = registers.value();
+    result.instructions = instructions.value();
+    Hasher combined;
+    combined.add(result.registers);
+    combined.add(result.gates);
+    combined.add(result.instructions);
+    result.hash = combined.value();
+    return result;
+}
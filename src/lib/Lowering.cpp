@@ -0,0 +1,339 @@
+#include <algorithm>
+#include <stdexcept>
+#include "Lowering.h"
+#include "Expr.h"
+
+using namespace qasmcpp;
+
+// Deepest gate nesting expanded before a definition is considered recursive
+static const int kMaxGateDepth = 1000;
+
+static const std::vector<std::string> noParams;
+
+static Instruction makeInstruction(int op, int qubit, int target = -1, int cbit = -1)
+{
+    Instruction instruction;
+    instruction.op = op;
+    instruction.qubits[0] = qubit;
+    instruction.qubits[1] = target;
+    instruction.cbit = cbit;
+    instruction.matrixId = -1;
+    instruction.params[0] = instruction.params[1] = instruction.params[2] = 0;
+    instruction.condition = -1;
+    instruction.barrier = -1;
+    return instruction;
+}
+
+static Instruction makeU(Circuit &circuit, int qubit, double theta, double phi, double lambda)
+{
+    Instruction instruction = makeInstruction(Instruction::U, qubit);
+    instruction.matrixId = circuit.matrices.intern(theta, phi, lambda);
+    instruction.params[0] = theta;
+    instruction.params[1] = phi;
+    instruction.params[2] = lambda;
+    return instruction;
+}
+
+static Instruction makeCX(int control, int target)
+{
+    if (control == target)
+        throw std::runtime_error("CX control and target are the same qubit");
+    return makeInstruction(Instruction::CX, control, target);
+}
+
+Lowering::Lowering(const SymbolTable &symbolTable) : symbolTable(symbolTable) {}
+
+Circuit Lowering::lower(const ProgramNode &program)
+{
+    freeParams = &noParams;
+    freeValues.clear();
+    freeSymbols.clear();
+    tape = nullptr;
+    slots = nullptr;
+    return lowerProgram(program);
+}
+
+Circuit Lowering::lowerTemplate(const ProgramNode &program, const std::vector<std::string> &freeParams, ExprTape &tape, std::vector<ParamSlot> &slots)
+{
+    if (tape.getNumParams() != freeParams.size())
+        throw std::runtime_error("Tape does not match the free parameters");
+
+    this->freeParams = &freeParams;
+    // the placeholder values only steer the lowering, slots are filled when bound
+    freeValues.assign(freeParams.size(), 0);
+    freeSymbols.resize(freeParams.size());
+    for (size_t i = 0; i < freeSymbols.size(); ++i)
+    {
+        freeSymbols[i] = static_cast<int>(i);
+    }
+    this->tape = &tape;
+    this->slots = &slots;
+    Circuit circuit = lowerProgram(program);
+    this->tape = nullptr;
+    this->slots = nullptr;
+    return circuit;
+}
+
+Circuit Lowering::lowerProgram(const ProgramNode &program)
+{
+    qregs.clear();
+    cregs.clear();
+    cregWords.clear();
+    // memos are keyed by pool address, which a later program may reuse
+    evaluator = ExprEvaluator();
+
+    Circuit circuit;
+    for (const auto &statement : program.statements)
+    {
+        lowerStatement(*statement, circuit);
+    }
+    return circuit;
+}
+
+void Lowering::lowerStatement(const QASMNode &statement, Circuit &circuit)
+{
+    if (auto regDecl = dynamic_cast<const RegDeclNode *>(&statement))
+    {
+        bool quantum = regDecl->regType == RegDeclNode::RegType::QREG;
+        auto &layouts = quantum ? circuit.qregs : circuit.cregs;
+        int &total = quantum ? circuit.numQubits : circuit.numCbits;
+
+        RegisterLayout layout{regDecl->regName, total, regDecl->size};
+        layouts.push_back(layout);
+        (quantum ? qregs : cregs)[layout.name] = layout;
+        total += layout.size;
+        if (!quantum)
+        {
+            cregWords[layout.name] = circuit.numWords;
+            circuit.numWords += (layout.size + 63) / 64;
+        }
+    }
+    else if (auto u = dynamic_cast<const UStmtNode *>(&statement))
+    {
+        evaluator.bind(*freeParams, freeValues);
+        double angles[3];
+        int nodes[3];
+        compileAngles(*u, freeSymbols, angles, nodes);
+        for (int qubit : resolve(u->qubit, true))
+        {
+            pushU(circuit, qubit, angles, nodes);
+        }
+    }
+    else if (auto cx = dynamic_cast<const CXStmtNode *>(&statement))
+    {
+        std::vector<std::vector<int>> args{resolve(cx->controlQubit, true), resolve(cx->targetQubit, true)};
+        size_t size = broadcastSize(args);
+        for (size_t i = 0; i < size; ++i)
+        {
+            circuit.instructions.push_back(makeCX(args[0][args[0].size() == 1 ? 0 : i], args[1][args[1].size() == 1 ? 0 : i]));
+        }
+    }
+    else if (auto gateStmt = dynamic_cast<const GateStmtNode *>(&statement))
+    {
+        evaluator.bind(*freeParams, freeValues);
+        std::vector<double> values;
+        std::vector<int> symbols;
+        for (const auto &param : gateStmt->params)
+        {
+            values.push_back(evaluator.evaluate(*param));
+            if (tape != nullptr)
+                symbols.push_back(evaluator.compile(*param, freeSymbols, *tape));
+        }
+
+        std::vector<std::vector<int>> args;
+        for (const auto &qubit : gateStmt->qubits)
+        {
+            args.push_back(resolve(*qubit, true));
+        }
+
+        size_t size = broadcastSize(args);
+        std::vector<int> qubits(args.size());
+        for (size_t i = 0; i < size; ++i)
+        {
+            for (size_t j = 0; j < args.size(); ++j)
+            {
+                qubits[j] = args[j][args[j].size() == 1 ? 0 : i];
+            }
+            expandGate(gateStmt->gateName, values, symbols, qubits, circuit, 0);
+        }
+    }
+    else if (auto measure = dynamic_cast<const MeasureStmtNode *>(&statement))
+    {
+        auto qubits = resolve(measure->qubit, true);
+        auto cbits = resolve(measure->classicalRegister, false);
+        if (qubits.size() != cbits.size())
+            throw std::runtime_error("Measure of mismatched register sizes: " + measure->qubit.name + " -> " + measure->classicalRegister.name);
+
+        for (size_t i = 0; i < qubits.size(); ++i)
+        {
+            circuit.instructions.push_back(makeInstruction(Instruction::MEASURE, qubits[i], -1, cbits[i]));
+        }
+    }
+    else if (auto reset = dynamic_cast<const ResetStmtNode *>(&statement))
+    {
+        for (int qubit : resolve(reset->qubit, true))
+        {
+            circuit.instructions.push_back(makeInstruction(Instruction::RESET, qubit));
+        }
+    }
+    else if (auto barrier = dynamic_cast<const BarrierStmtNode *>(&statement))
+    {
+        // one instruction per qubit, numbered by the first so the statement stays one fence
+        int group = static_cast<int>(circuit.instructions.size());
+        for (const auto &bit : barrier->qubits)
+        {
+            for (int qubit : resolve(bit, true))
+            {
+                circuit.instructions.push_back(makeInstruction(Instruction::BARRIER, qubit));
+                circuit.instructions.back().barrier = group;
+            }
+        }
+    }
+    else if (auto ifStmt = dynamic_cast<const IfStmtNode *>(&statement))
+    {
+        const std::string &name = ifStmt->classicalRegister.name;
+        auto it = cregs.find(name);
+        if (it == cregs.end())
+            throw std::runtime_error("Undefined creg: " + name);
+        if (it->second.size < 64 && ifStmt->value >> it->second.size != 0)
+            throw std::runtime_error("Value " + std::to_string(ifStmt->value) + " does not fit creg " + name + "[" + std::to_string(it->second.size) + "]");
+
+        // the instructions of the operation all test the same condition
+        size_t first = circuit.instructions.size();
+        lowerStatement(*ifStmt->statement, circuit);
+        int condition = static_cast<int>(circuit.conditions.size());
+        circuit.conditions.push_back(Condition{cregWords[name], (it->second.size + 63) / 64, ifStmt->value});
+        for (size_t i = first; i < circuit.instructions.size(); ++i)
+        {
+            circuit.instructions[i].condition = condition;
+        }
+    }
+    // version, include and gate declarations have nothing to lower
+}
+
+void Lowering::expandGate(const std::string &name, const std::vector<double> &values, const std::vector<int> &symbols, const std::vector<int> &qubits, Circuit &circuit, int depth)
+{
+    auto definition = symbolTable.findGateDef(name);
+    if (definition == nullptr)
+        throw std::runtime_error("Undefined gate: " + name);
+    if (depth > kMaxGateDepth)
+        throw std::runtime_error("Gate definition is recursive: " + name);
+
+    const Gate &gate = *definition;
+    if (values.size() != gate.params.size() || qubits.size() != gate.qubits.size())
+        throw std::runtime_error("Wrong number of arguments for gate: " + name);
+
+    // gate bodies only refer to the qubit arguments of the gate by name
+    auto local = [&](const Bit &bit) {
+        for (size_t i = 0; i < gate.qubits.size(); ++i)
+        {
+            if (gate.qubits[i]->name == bit.name)
+                return qubits[i];
+        }
+        throw std::runtime_error("Unknown qubit " + bit.name + " in gate: " + name);
+    };
+
+    for (const auto &statement : gate.body)
+    {
+        // rebinding the same values keeps the memo, a nested expansion changes it
+        evaluator.bind(gate.params, values);
+        if (auto u = dynamic_cast<const UStmtNode *>(statement.get()))
+        {
+            double angles[3];
+            int nodes[3];
+            compileAngles(*u, symbols, angles, nodes);
+            pushU(circuit, local(u->qubit), angles, nodes);
+        }
+        else if (auto cx = dynamic_cast<const CXStmtNode *>(statement.get()))
+        {
+            circuit.instructions.push_back(makeCX(local(cx->controlQubit), local(cx->targetQubit)));
+        }
+        else if (auto gateStmt = dynamic_cast<const GateStmtNode *>(statement.get()))
+        {
+            std::vector<double> innerValues;
+            std::vector<int> innerSymbols;
+            for (const auto &param : gateStmt->params)
+            {
+                innerValues.push_back(evaluator.evaluate(*param));
+                if (tape != nullptr)
+                    innerSymbols.push_back(evaluator.compile(*param, symbols, *tape));
+            }
+            std::vector<int> innerQubits;
+            for (const auto &qubit : gateStmt->qubits)
+            {
+                innerQubits.push_back(local(*qubit));
+            }
+            expandGate(gateStmt->gateName, innerValues, innerSymbols, innerQubits, circuit, depth + 1);
+        }
+        else if (auto barrier = dynamic_cast<const BarrierStmtNode *>(statement.get()))
+        {
+            int group = static_cast<int>(circuit.instructions.size());
+            for (const auto &bit : barrier->qubits)
+            {
+                circuit.instructions.push_back(makeInstruction(Instruction::BARRIER, local(bit)));
+                circuit.instructions.back().barrier = group;
+            }
+        }
+    }
+}
+
+void Lowering::compileAngles(const UStmtNode &u, const std::vector<int> &symbols, double angles[3], int nodes[3])
+{
+    const ExprNode *exprs[3] = {u.theta.get(), u.phi.get(), u.lambda.get()};
+    for (int i = 0; i < 3; ++i)
+    {
+        angles[i] = evaluator.evaluate(*exprs[i]);
+        nodes[i] = tape != nullptr ? evaluator.compile(*exprs[i], symbols, *tape) : -1;
+    }
+}
+
+void Lowering::pushU(Circuit &circuit, int qubit, const double angles[3], const int nodes[3])
+{
+    if (nodes[0] < 0 && nodes[1] < 0 && nodes[2] < 0)
+    {
+        circuit.instructions.push_back(makeU(circuit, qubit, angles[0], angles[1], angles[2]));
+        return;
+    }
+
+    // the placeholder angles would only add a matrix that is never used
+    Instruction instruction = makeInstruction(Instruction::U, qubit);
+    std::copy(angles, angles + 3, instruction.params);
+    slots->push_back(ParamSlot{circuit.instructions.size(), {nodes[0], nodes[1], nodes[2]}});
+    circuit.instructions.push_back(instruction);
+}
+
+std::vector<int> Lowering::resolve(const Bit &bit, bool quantum) const
+{
+    const auto &layouts = quantum ? qregs : cregs;
+    auto it = layouts.find(bit.name);
+    if (it == layouts.end())
+        throw std::runtime_error((quantum ? "Undefined qreg: " : "Undefined creg: ") + bit.name);
+
+    const RegisterLayout &layout = it->second;
+    if (bit.index >= layout.size)
+        throw std::runtime_error("Index out of range: " + bit.name + "[" + std::to_string(bit.index) + "]");
+
+    if (bit.index >= 0)
+        return std::vector<int>{layout.offset + bit.index};
+
+    std::vector<int> indices(layout.size);
+    for (int i = 0; i < layout.size; ++i)
+    {
+        indices[i] = layout.offset + i;
+    }
+    return indices;
+}
+
+size_t Lowering::broadcastSize(const std::vector<std::vector<int>> &args) const
+{
+    size_t size = 1;
+    for (const auto &arg : args)
+    {
+        if (arg.size() == 1)
+            continue;
+        if (size != 1 && size != arg.size())
+            throw std::runtime_error("Register arguments of different sizes");
+        size = arg.size();
+    }
+    return size;
+}
@@ -0,0 +1,63 @@
+#include <cmath>
+#include <cstring>
+#include "MatrixCache.h"
+
+using namespace qasmcpp;
+
+static uint64_t bitPattern(double value)
+{
+    // adding zero folds -0.0 into 0.0, both give the same matrix
+    value += 0.0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+bool MatrixCache::Key::operator==(const Key &other) const
+{
+    return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+}
+
+size_t MatrixCache::KeyHash::operator()(const Key &key) const
+{
+    uint64_t hash = key.bits[0];
+    hash = (hash ^ (hash >> 32)) * 0x9E3779B97F4A7C15ULL + key.bits[1];
+    hash = (hash ^ (hash >> 32)) * 0x9E3779B97F4A7C15ULL + key.bits[2];
+    return static_cast<size_t>(hash ^ (hash >> 29));
+}
+
+int MatrixCache::intern(double theta, double phi, double lambda)
+{
+    Key key{{bitPattern(theta), bitPattern(phi), bitPattern(lambda)}};
+    auto it = ids.find(key);
+    if (it != ids.end())
+        return it->second;
+
+    int id = static_cast<int>(matrices.size());
+    matrices.push_back(uMatrix(theta, phi, lambda));
+    keys.push_back(key);
+    ids.emplace(key, id);
+    return id;
+}
+
+void MatrixCache::truncate(size_t size)
+{
+    while (matrices.size() > size)
+    {
+        ids.erase(keys.back());
+        keys.pop_back();
+        matrices.pop_back();
+    }
+}
+
+MatrixCache::Matrix MatrixCache::uMatrix(double theta, double phi, double lambda)
+{
+    const double c = std::cos(theta / 2);
+    const double s = std::sin(theta / 2);
+    return Matrix{{
+        c,
+        -std::polar(s, lambda),
+        std::polar(s, phi),
+        std::polar(c, phi + lambda),
+    }};
+}
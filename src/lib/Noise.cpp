@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include "Noise.h"
+#include "ClassicalState.h"
+#include "Relabel.h"
+
+using namespace qasmcpp;
+
+typedef StatevectorSimulator::Amplitude Amplitude;
+
+// Trajectories per chunk, the unit of work of a thread and of a histogram
+static const int64_t kChunkTrajectories = 64;
+
+namespace
+{
+
+    // SplitMix64 output function
+    uint64_t mix64(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Counter-based stream of one trajectory, draw i only depends on the key and i
+    class TrajectoryRng
+    {
+    public:
+        explicit TrajectoryRng(uint64_t key) : key(key) {}
+
+        inline double next()
+        {
+            return static_cast<double>(mix64(key + ++counter * 0x9E3779B97F4A7C15ULL) >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        uint64_t key;
+        uint64_t counter = 0;
+    };
+
+    // I, X, Y and Z in row-major order
+    const Amplitude kPaulis[4][4] = {
+        {1, 0, 0, 1},
+        {0, 1, 1, 0},
+        {0, Amplitude(0, -1), Amplitude(0, 1), 0},
+        {1, 0, 0, -1},
+    };
+
+    // The outcomes of one chunk of trajectories, written by a single thread
+    struct ChunkResult
+    {
+        std::map<std::vector<uint64_t>, size_t> histogram;
+        size_t noiseEvents = 0;
+        std::exception_ptr error;
+    };
+
+    // Runs trajectories on a statevector and classical state reused between them
+    class TrajectoryRunner
+    {
+    public:
+        TrajectoryRunner(const Circuit &circuit, const NoiseModel &noise)
+            : circuit(circuit), noise(noise), simulator(circuit.numQubits), classical(circuit) {}
+
+        void run(uint64_t key, ChunkResult &result)
+        {
+            TrajectoryRng rng(key);
+            simulator.setSeed(mix64(~key));
+            simulator.initialize();
+            classical.clear();
+
+            for (const auto &instruction : circuit.instructions)
+            {
+                if (instruction.condition >= 0 && !classical.test(circuit.conditions[instruction.condition]))
+                    continue;
+
+                const int qubit = instruction.qubits[0];
+                switch (instruction.op)
+                {
+                case Instruction::U:
+                    simulator.applyMatrix(qubit, circuit.matrices.get(instruction.matrixId).data());
+                    if (noise.depolarizing > 0 && rng.next() < noise.depolarizing)
+                    {
+                        simulator.applyMatrix(qubit, kPaulis[1 + std::min(2, static_cast<int>(rng.next() * 3))]);
+                        result.noiseEvents++;
+                    }
+                    damp(qubit, rng, result);
+                    break;
+                case Instruction::CX:
+                {
+                    const int target = instruction.qubits[1];
+                    simulator.applyCX(qubit, target);
+                    if (noise.depolarizing2 > 0 && rng.next() < noise.depolarizing2)
+                    {
+                        // one of the 15 Paulis other than II, two bits per qubit
+                        int pauli = 1 + std::min(14, static_cast<int>(rng.next() * 15));
+                        if (pauli & 3)
+                            simulator.applyMatrix(qubit, kPaulis[pauli & 3]);
+                        if (pauli >> 2)
+                            simulator.applyMatrix(target, kPaulis[pauli >> 2]);
+                        result.noiseEvents++;
+                    }
+                    damp(qubit, rng, result);
+                    damp(target, rng, result);
+                    break;
+                }
+                case Instruction::MEASURE:
+                {
+                    int bit = simulator.measure(qubit);
+                    if (noise.readout > 0 && rng.next() < noise.readout)
+                    {
+                        bit ^= 1;
+                        result.noiseEvents++;
+                    }
+                    classical.set(instruction.cbit, bit);
+                    break;
+                }
+                case Instruction::RESET:
+                    simulator.reset(qubit);
+                    break;
+                }
+            }
+            result.histogram[classical.getWords()]++;
+        }
+
+    private:
+        // Amplitude damping as a jump to |0> with probability gamma * P(1), or the renormalized no-jump branch
+        void damp(int qubit, TrajectoryRng &rng, ChunkResult &result)
+        {
+            const double gamma = noise.amplitudeDamping;
+            if (gamma <= 0)
+                return;
+
+            const double one = simulator.qubitProbability(qubit);
+            const double jump = gamma * one;
+            if (rng.next() < jump)
+            {
+                const Amplitude decay[4] = {0, 1 / std::sqrt(one), 0, 0};
+                simulator.applyMatrix(qubit, decay);
+                result.noiseEvents++;
+            }
+            else
+            {
+                const double scale = 1 / std::sqrt(1 - jump);
+                const Amplitude damped[4] = {scale, 0, 0, std::sqrt(1 - gamma) * scale};
+                simulator.applyMatrix(qubit, damped);
+            }
+        }
+
+        const Circuit &circuit;
+        const NoiseModel &noise;
+        StatevectorSimulator simulator;
+        ClassicalState classical;
+    };
+
+} // namespace
+
+NoiseModel NoiseModel::parse(const std::string &description)
+{
+    NoiseModel model;
+    std::stringstream stream(description);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+        if (item.empty())
+            continue;
+
+        size_t equals = item.find('=');
+        std::string name = item.substr(0, equals);
+        double *probability = name == "depolarizing"        ? &model.depolarizing
+                              : name == "depolarizing2"     ? &model.depolarizing2
+                              : name == "amplitude_damping" ? &model.amplitudeDamping
+                              : name == "readout"           ? &model.readout
+                                                            : nullptr;
+        if (probability == nullptr)
+            throw std::runtime_error("Unknown noise parameter: " + name);
+
+        std::string text = equals == std::string::npos ? std::string() : item.substr(equals + 1);
+        size_t used = 0;
+        double value = -1;
+        try
+        {
+            value = std::stod(text, &used);
+        }
+        catch (const std::exception &)
+        {
+        }
+        if (text.empty() || used != text.size() || !(value >= 0 && value <= 1))
+            throw std::runtime_error("Invalid probability for " + name + ": " + text);
+        *probability = value;
+    }
+    return model;
+}
+
+bool NoiseModel::isIdeal() const
+{
+    return depolarizing == 0 && depolarizing2 == 0 && amplitudeDamping == 0 && readout == 0;
+}
+
+SimResult qasmcpp::simulateNoisy(const Circuit &circuit, const NoiseModel &noise, const SimOptions &options)
+{
+    SimResult result;
+
+    // relabeling rewrites a copy, measured cbits are the same either way
+    Circuit relabeled;
+    const Circuit *target = &circuit;
+    if (options.relabelQubits)
+    {
+        relabeled = circuit;
+        result.stats.relabeledQubits = relabelQubits(relabeled, chooseQubitOrder(circuit));
+        target = &relabeled;
+    }
+
+    const int64_t shots = static_cast<int64_t>(options.shots);
+    const int64_t chunks = (shots + kChunkTrajectories - 1) / kChunkTrajectories;
+    std::vector<ChunkResult> results(chunks);
+    {
+        PhaseTimer timer(&result.stats.simulateTime);
+
+#pragma omp parallel
+        {
+            // allocated on the first chunk of the thread and reused for the rest
+            std::unique_ptr<TrajectoryRunner> runner;
+
+#pragma omp for schedule(dynamic, 1) nowait
+            for (int64_t chunk = 0; chunk < chunks; ++chunk)
+            {
+                // an exception must not leave the parallel region
+                try
+                {
+                    if (!runner)
+                        runner.reset(new TrajectoryRunner(*target, noise));
+                    const int64_t end = std::min(shots, (chunk + 1) * kChunkTrajectories);
+                    for (int64_t trajectory = chunk * kChunkTrajectories; trajectory < end; ++trajectory)
+                    {
+                        runner->run(mix64(options.seed + 0x9E3779B97F4A7C15ULL * (trajectory + 1)), results[chunk]);
+                    }
+                }
+                catch (...)
+                {
+                    results[chunk].error = std::current_exception();
+                }
+            }
+        }
+    }
+    result.simulations = options.shots;
+
+    // chunks are merged in order once the threads have joined
+    std::map<std::vector<uint64_t>, size_t> histogram;
+    for (const auto &chunk : results)
+    {
+        if (chunk.error)
+            std::rethrow_exception(chunk.error);
+        for (const auto &entry : chunk.histogram)
+        {
+            histogram[entry.first] += entry.second;
+        }
+        result.stats.noiseEvents += chunk.noiseEvents;
+    }
+
+    ClassicalState classical(*target);
+    std::vector<int> cbits;
+    for (const auto &outcome : histogram)
+    {
+        classical.setWords(outcome.first);
+        classical.toBits(cbits);
+        recordOutcome(result, *target, cbits, outcome.second);
+    }
+    return result;
+}
@@ -0,0 +1,80 @@
+#include <numeric>
+#include <stdexcept>
+#include "Relabel.h"
+
+using namespace qasmcpp;
+
+std::vector<int> qasmcpp::chooseQubitOrder(const Circuit &circuit)
+{
+    int numQubits = circuit.numQubits;
+    std::vector<size_t> uses(numQubits, 0);
+    std::vector<size_t> partners(static_cast<size_t>(numQubits) * numQubits, 0); // CX count of each pair
+    for (const auto &instruction : circuit.instructions)
+    {
+        if (instruction.op == Instruction::U)
+        {
+            uses[instruction.qubits[0]]++;
+        }
+        else if (instruction.op == Instruction::CX)
+        {
+            int a = instruction.qubits[0], b = instruction.qubits[1];
+            uses[a]++;
+            uses[b]++;
+            partners[static_cast<size_t>(a) * numQubits + b]++;
+            partners[static_cast<size_t>(b) * numQubits + a]++;
+        }
+    }
+
+    // each step places the qubit with the most gates, counting a second time
+    // the CX gates it shares with the qubits already placed, since those only
+    // stay in the low bit positions if it joins them
+    std::vector<size_t> score(uses);
+    std::vector<bool> placed(numQubits, false);
+    std::vector<int> order(numQubits);
+    for (int position = 0; position < numQubits; ++position)
+    {
+        int best = -1;
+        for (int qubit = 0; qubit < numQubits; ++qubit)
+        {
+            if (!placed[qubit] && (best < 0 || score[qubit] > score[best]))
+                best = qubit;
+        }
+        placed[best] = true;
+        order[best] = position;
+        for (int qubit = 0; qubit < numQubits; ++qubit)
+        {
+            score[qubit] += partners[static_cast<size_t>(best) * numQubits + qubit];
+        }
+    }
+    return order;
+}
+
+size_t qasmcpp::relabelQubits(Circuit &circuit, const std::vector<int> &order)
+{
+    if (order.size() != static_cast<size_t>(circuit.numQubits))
+        throw std::runtime_error("Qubit order does not match the circuit");
+
+    for (auto &instruction : circuit.instructions)
+    {
+        instruction.qubits[0] = order[instruction.qubits[0]];
+        if (instruction.op == Instruction::CX)
+            instruction.qubits[1] = order[instruction.qubits[1]];
+    }
+
+    // compose with an earlier relabeling
+    if (circuit.physicalQubits.empty())
+    {
+        circuit.physicalQubits.resize(circuit.numQubits);
+        std::iota(circuit.physicalQubits.begin(), circuit.physicalQubits.end(), 0);
+    }
+
+    size_t moved = 0;
+    for (int qubit = 0; qubit < circuit.numQubits; ++qubit)
+    {
+        int &position = circuit.physicalQubits[qubit];
+        position = order[position];
+        if (position != qubit)
+            moved++;
+    }
+    return moved;
+}
@@ -0,0 +1,454 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <antlr4-runtime.h>
+#include "QASM2Lexer.h"
+#include "QASM2Parser.h"
+#include "Resources.h"
+#include "StatementReader.h"
+#include "StdLib.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+// Primitive gates, one layer on their qubits
+static GateResources primitive(size_t numParams, size_t numQubits)
+{
+    GateResources gate;
+    gate.numParams = numParams;
+    gate.numQubits = numQubits;
+    gate.uCount = numQubits == 1 ? 1 : 0;
+    gate.cxCount = numQubits == 2 ? 1 : 0;
+    gate.depth = 1;
+    return gate;
+}
+
+static const GateResources kU = primitive(3, 1);
+static const GateResources kCX = primitive(0, 2);
+
+// Moves the qubits of a block to the latest of them plus the depth of the block
+template <typename Index>
+static void placeBlock(std::vector<size_t> &levels, const std::vector<Index> &qubits, size_t depth)
+{
+    size_t start = 0;
+    for (Index qubit : qubits)
+    {
+        start = std::max(start, levels[qubit]);
+    }
+    for (Index qubit : qubits)
+    {
+        levels[qubit] = start + depth;
+    }
+}
+
+static size_t countNames(const char *list)
+{
+    return *list ? std::count(list, list + std::strlen(list), ',') + 1 : 0;
+}
+
+static int localIndex(const std::vector<std::string> &names, const std::string &name, const std::string &gate)
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    if (it == names.end())
+        throw std::runtime_error("Unknown qubit " + name + " in gate: " + gate);
+    return static_cast<int>(it - names.begin());
+}
+
+static std::vector<std::string> idNames(QASM2Parser::IdListContext *ctx)
+{
+    std::vector<std::string> names;
+    for (auto id : ctx->ID())
+    {
+        names.push_back(id->getText());
+    }
+    return names;
+}
+
+ResourceCounts ResourceEstimator::estimateFile(const std::string &path)
+{
+    std::ifstream stream(path);
+    if (!stream.is_open())
+        throw std::runtime_error("Could not open file: " + path);
+    return estimate(stream);
+}
+
+ResourceCounts ResourceEstimator::estimateString(const std::string &source)
+{
+    std::istringstream stream(source);
+    return estimate(stream);
+}
+
+ResourceCounts ResourceEstimator::estimate(std::istream &input)
+{
+    reset();
+    read(input, "<input>", true);
+
+    for (const auto &qreg : qregs)
+    {
+        size_t depth = 0;
+        for (size_t i = 0; i < qreg.second.size; ++i)
+        {
+            depth = std::max(depth, levels[qreg.second.offset + i]);
+        }
+        counts.registerDepth[qreg.first] = depth;
+        counts.depth = std::max(counts.depth, depth);
+    }
+    return counts;
+}
+
+void ResourceEstimator::reset()
+{
+    gates.clear();
+    qregs.clear();
+    cregs.clear();
+    includes.clear();
+    levels.clear();
+    counts = ResourceCounts();
+}
+
+void ResourceEstimator::read(std::istream &input, const std::string &source, bool topLevel)
+{
+    StatementReader reader(input);
+    std::string text;
+    while (reader.next(text))
+    {
+        try
+        {
+            statement(text);
+        }
+        catch (const std::runtime_error &e)
+        {
+            throw std::runtime_error(source + ":" + std::to_string(reader.getLine()) + ": " + e.what());
+        }
+        if (topLevel)
+            counts.statements++;
+    }
+}
+
+// Parses a single statement with its own lexer and parser, so the parse
+// tree and tokens are released before the next statement is read
+void ResourceEstimator::statement(const std::string &text)
+{
+    ANTLRInputStream input(text);
+    QASM2Lexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    QASM2Parser parser(&tokens);
+    parser.removeErrorListeners();
+
+    if (text.compare(0, 8, "OPENQASM") == 0 || text.compare(0, 8, "openqasm") == 0)
+    {
+        parser.version();
+        if (parser.getNumberOfSyntaxErrors() > 0)
+            throw std::runtime_error("Syntax error in version");
+        return;
+    }
+
+    QASM2Parser::StatementContext *ctx = parser.statement();
+    if (parser.getNumberOfSyntaxErrors() > 0 || tokens.LA(1) != Token::EOF)
+        throw std::runtime_error("Syntax error: " + text);
+
+    if (auto includeDecl = ctx->includeDeclStmt())
+    {
+        include(includeDecl->filename.substr(1, includeDecl->filename.size() - 2));
+    }
+    else if (auto regDecl = ctx->regDeclStmt())
+    {
+        std::string name = regDecl->ID()->getText();
+        size_t size = std::stoul(regDecl->NNINTEGER()->getText());
+        bool quantum = regDecl->QREG() != nullptr;
+        auto &registers = quantum ? qregs : cregs;
+        size_t &total = quantum ? counts.numQubits : counts.numCbits;
+
+        if (!registers.insert({name, Register{total, size}}).second)
+            throw std::runtime_error("Register already declared: " + name);
+        total += size;
+        if (quantum)
+            levels.resize(total, 0);
+    }
+    else if (auto gateDecl = ctx->gateDeclStmt())
+    {
+        std::string name = gateDecl->ID()->getText();
+        auto idLists = gateDecl->idList();
+        std::vector<std::string> params = gateDecl->hasParams ? idNames(idLists[0]) : std::vector<std::string>();
+        std::vector<std::string> qubits = idNames(idLists.back());
+
+        std::vector<Call> body;
+        for (auto uop : gateDecl->uop())
+        {
+            Call call;
+            call.gate = uop->gateName;
+            call.numParams = uop->expList() ? uop->expList()->exp().size() : 0;
+            if (uop->type == QASM2Parser::ID)
+            {
+                for (auto arg : uop->mixedList()->argument())
+                {
+                    call.qubits.push_back(localIndex(qubits, arg->ID()->getText(), name));
+                }
+            }
+            else
+            {
+                for (auto arg : uop->argument())
+                {
+                    call.qubits.push_back(localIndex(qubits, arg->ID()->getText(), name));
+                }
+            }
+            body.push_back(call);
+        }
+        defineGate(name, params.size(), qubits.size(), body);
+    }
+    else if (auto opaqueDecl = ctx->opaqueDeclStmt())
+    {
+        // opaque gates have no body to expand, they count as a single layer
+        auto idLists = opaqueDecl->idList();
+        GateResources gate;
+        gate.numParams = idLists.size() > 1 ? idNames(idLists[0]).size() : 0;
+        gate.numQubits = idNames(idLists.back()).size();
+        gate.depth = 1;
+        gates[opaqueDecl->ID()->getText()] = gate;
+        counts.gateDefinitions++;
+    }
+    else if (auto barrier = ctx->barrierDeclStmt())
+    {
+        // barriers only order the circuit, they do not add depth
+        for (auto arg : barrier->mixedList()->argument())
+        {
+            resolve(arg->ID()->getText(), arg->NNINTEGER() ? std::stoi(arg->NNINTEGER()->getText()) : -1, true);
+        }
+        counts.gateCounts["barrier"]++;
+    }
+    else
+    {
+        QASM2Parser::QopStmtContext *qop = ctx->qopStmt();
+        if (auto ifDecl = ctx->ifDeclStmt())
+        {
+            if (cregs.find(ifDecl->ID()->getText()) == cregs.end())
+                throw std::runtime_error("Undefined creg: " + ifDecl->ID()->getText());
+            qop = ifDecl->qopStmt();
+        }
+
+        auto argBits = [this](QASM2Parser::ArgumentContext *arg, bool quantum) {
+            return resolve(arg->ID()->getText(), arg->NNINTEGER() ? std::stoi(arg->NNINTEGER()->getText()) : -1, quantum);
+        };
+
+        if (qop->type == QASM2Parser::MEASURE || qop->type == QASM2Parser::RESET)
+        {
+            bool measure = qop->type == QASM2Parser::MEASURE;
+            std::vector<size_t> qubits = argBits(qop->argument(0), true);
+            if (measure && argBits(qop->argument(1), false).size() != qubits.size())
+                throw std::runtime_error("Measure of mismatched register sizes");
+
+            for (size_t qubit : qubits)
+            {
+                levels[qubit]++;
+            }
+            counts.gateCounts[measure ? "measure" : "reset"] += qubits.size();
+            return;
+        }
+
+        QASM2Parser::UopContext *uop = qop->uop();
+        std::vector<std::vector<size_t>> args;
+        for (auto arg : uop->type == QASM2Parser::ID ? uop->mixedList()->argument() : uop->argument())
+        {
+            args.push_back(argBits(arg, true));
+        }
+        size_t numParams = uop->expList() ? uop->expList()->exp().size() : 0;
+        apply(uop->gateName, lookup(uop->gateName, numParams, args.size()), args);
+    }
+}
+
+void ResourceEstimator::include(const std::string &filename)
+{
+    // a file included before adds nothing, as in the parser
+    if (!includes.insert(filename).second)
+        return;
+
+    if (!useBuiltinStdlib || !stdlib::isQelib1(filename))
+    {
+        std::ifstream stream(filename);
+        if (!stream.is_open())
+            throw std::runtime_error("Could not open file: " + filename);
+        read(stream, filename, false);
+        return;
+    }
+
+    // the built-in tables describe the library without any parsing
+    size_t gateCount, opCount;
+    const stdlib::BuiltinGate *table = stdlib::qelib1Gates(gateCount);
+    const stdlib::BuiltinOp *ops = stdlib::qelib1Ops(opCount);
+    for (size_t i = 0; i < gateCount; ++i)
+    {
+        std::vector<Call> body;
+        for (int op = table[i].bodyBegin; op < table[i].bodyEnd; ++op)
+        {
+            Call call;
+            call.gate = ops[op].gate;
+            call.numParams = countNames(ops[op].params);
+            for (int k = 0; k < 4 && ops[op].qubits[k] >= 0; ++k)
+            {
+                call.qubits.push_back(ops[op].qubits[k]);
+            }
+            body.push_back(call);
+        }
+        defineGate(table[i].name, countNames(table[i].params), countNames(table[i].qubits), body);
+    }
+}
+
+void ResourceEstimator::defineGate(const std::string &name, size_t numParams, size_t numQubits, const std::vector<Call> &body)
+{
+    GateResources gate;
+    gate.numParams = numParams;
+    gate.numQubits = numQubits;
+
+    std::vector<size_t> local(numQubits, 0);
+    for (const auto &call : body)
+    {
+        const GateResources &inner = lookup(call.gate, call.numParams, call.qubits.size());
+        gate.uCount += inner.uCount;
+        gate.cxCount += inner.cxCount;
+        gate.tCount += inner.tCount;
+        gate.nesting = std::max(gate.nesting, inner.nesting);
+        placeBlock(local, call.qubits, inner.depth);
+    }
+
+    gate.nesting++;
+    for (size_t level : local)
+    {
+        gate.depth = std::max(gate.depth, level);
+    }
+    if (name == "t" || name == "tdg")
+        gate.tCount++;
+
+    gates[name] = gate;
+    counts.gateDefinitions++;
+}
+
+const GateResources &ResourceEstimator::lookup(const std::string &name, size_t numParams, size_t numQubits) const
+{
+    const GateResources *gate;
+    if (name == "U")
+    {
+        gate = &kU;
+    }
+    else if (name == "CX")
+    {
+        gate = &kCX;
+    }
+    else
+    {
+        auto it = gates.find(name);
+        if (it == gates.end())
+            throw std::runtime_error("Undefined gate: " + name);
+        gate = &it->second;
+    }
+
+    if (gate->numParams != numParams || gate->numQubits != numQubits)
+        throw std::runtime_error("Wrong number of arguments for gate: " + name);
+    return *gate;
+}
+
+std::vector<size_t> ResourceEstimator::resolve(const std::string &name, int index, bool quantum) const
+{
+    const auto &registers = quantum ? qregs : cregs;
+    auto it = registers.find(name);
+    if (it == registers.end())
+        throw std::runtime_error((quantum ? "Undefined qreg: " : "Undefined creg: ") + name);
+
+    const Register &reg = it->second;
+    if (index >= 0 && static_cast<size_t>(index) >= reg.size)
+        throw std::runtime_error("Index out of range: " + name + "[" + std::to_string(index) + "]");
+
+    if (index >= 0)
+        return std::vector<size_t>{reg.offset + index};
+
+    std::vector<size_t> bits(reg.size);
+    for (size_t i = 0; i < reg.size; ++i)
+    {
+        bits[i] = reg.offset + i;
+    }
+    return bits;
+}
+
+void ResourceEstimator::apply(const std::string &name, const GateResources &gate, const std::vector<std::vector<size_t>> &args)
+{
+    // register arguments broadcast, single qubits are repeated
+    size_t size = 1;
+    for (const auto &arg : args)
+    {
+        if (arg.size() == 1)
+            continue;
+        if (size != 1 && size != arg.size())
+            throw std::runtime_error("Register arguments of different sizes");
+        size = arg.size();
+    }
+
+    std::vector<size_t> qubits(args.size());
+    for (size_t i = 0; i < size; ++i)
+    {
+        for (size_t j = 0; j < args.size(); ++j)
+        {
+            qubits[j] = args[j][args[j].size() == 1 ? 0 : i];
+        }
+        placeBlock(levels, qubits, gate.depth);
+    }
+
+    counts.gateCounts[name] += size;
+    counts.uCount += size * gate.uCount;
+    counts.cxCount += size * gate.cxCount;
+    counts.tCount += size * gate.tCount;
+    counts.maxNesting = std::max(counts.maxNesting, gate.nesting);
+}
+
+void ResourceCounts::print(std::ostream &out) const
+{
+    out << "Resources:" << std::endl;
+    out << "  qubits           : " << numQubits << std::endl;
+    out << "  clbits           : " << numCbits << std::endl;
+    out << "  U gates          : " << uCount << std::endl;
+    out << "  CX gates         : " << cxCount << std::endl;
+    out << "  T count          : " << tCount << std::endl;
+    out << "  depth            : " << depth << std::endl;
+    out << "  max nesting      : " << maxNesting << std::endl;
+    out << "  statements       : " << statements << std::endl;
+    out << "  gate definitions : " << gateDefinitions << std::endl;
+    out << "Gate counts:" << std::endl;
+    for (const auto &count : gateCounts)
+    {
+        out << "  " << count.first << ": " << count.second << std::endl;
+    }
+    out << "Register depth:" << std::endl;
+    for (const auto &reg : registerDepth)
+    {
+        out << "  " << reg.first << ": " << reg.second << std::endl;
+    }
+}
+
+void ResourceCounts::printJson(std::ostream &out) const
+{
+    out << "{"
+        << "\"qubits\":" << numQubits << ","
+        << "\"clbits\":" << numCbits << ","
+        << "\"uCount\":" << uCount << ","
+        << "\"cxCount\":" << cxCount << ","
+        << "\"tCount\":" << tCount << ","
+        << "\"depth\":" << depth << ","
+        << "\"maxNesting\":" << maxNesting << ","
+        << "\"statements\":" << statements << ","
+        << "\"gateDefinitions\":" << gateDefinitions << ","
+        << "\"gateCounts\":{";
+    const char *separator = "";
+    for (const auto &count : gateCounts)
+    {
+        out << separator << "\"" << count.first << "\":" << count.second;
+        separator = ",";
+    }
+    out << "},\"registerDepth\":{";
+    separator = "";
+    for (const auto &reg : registerDepth)
+    {
+        out << separator << "\"" << reg.first << "\":" << reg.second;
+        separator = ",";
+    }
+    out << "}}" << std::endl;
+}
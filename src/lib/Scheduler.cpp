@@ -0,0 +1,51 @@
+#include "Scheduler.h"
+
+using namespace qasmcpp;
+
+std::vector<Layer> qasmcpp::scheduleLayers(const Circuit &circuit)
+{
+    std::vector<Layer> layers;
+    // layer that last used each qubit, so checking a gate is O(1)
+    std::vector<size_t> lastLayer(circuit.numQubits, size_t(-1));
+
+    bool open = false;
+    for (size_t i = 0; i < circuit.instructions.size(); ++i)
+    {
+        const Instruction &instruction = circuit.instructions[i];
+        if (instruction.condition >= 0)
+        {
+            // executed on its own, only when the condition holds
+            layers.push_back(Layer{i, i + 1, false});
+            open = false;
+            continue;
+        }
+
+        switch (instruction.op)
+        {
+        case Instruction::U:
+        case Instruction::CX:
+        {
+            int first = instruction.qubits[0];
+            int second = instruction.op == Instruction::CX ? instruction.qubits[1] : first;
+            size_t current = layers.size() - 1;
+            if (!open || lastLayer[first] == current || lastLayer[second] == current)
+            {
+                layers.push_back(Layer{i, i, true});
+                current = layers.size() - 1;
+                open = true;
+            }
+            layers.back().end = i + 1;
+            lastLayer[first] = lastLayer[second] = current;
+            break;
+        }
+        case Instruction::BARRIER:
+            open = false;
+            break;
+        default:
+            layers.push_back(Layer{i, i + 1, false});
+            open = false;
+            break;
+        }
+    }
+    return layers;
+}
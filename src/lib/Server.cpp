@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Server.h"
+#include "Validator.h"
+#include "Warmup.h"
+
+using namespace qasmcpp;
+
+// Requests above this size are refused before their source is read
+static const long long kMaxRequestBytes = 1LL << 30;
+
+// The source of a request is read in chunks of this size, so the buffer only
+// grows with the bytes that actually arrive, not with the size in the header
+static const size_t kReadChunkBytes = 1 << 20;
+
+namespace
+{
+    // Buffered stream over a file descriptor, for framed requests on a socket
+    class FdStreamBuf : public std::streambuf
+    {
+    public:
+        explicit FdStreamBuf(int fd) : fd(fd)
+        {
+            setg(input, input, input);
+            setp(output, output + sizeof(output));
+        }
+
+        ~FdStreamBuf() override { flush(); }
+
+    protected:
+        int_type underflow() override
+        {
+            ssize_t n;
+            do
+            {
+                n = ::read(fd, input, sizeof(input));
+            } while (n < 0 && errno == EINTR);
+            if (n <= 0)
+                return traits_type::eof();
+            setg(input, input, input + n);
+            return traits_type::to_int_type(*gptr());
+        }
+
+        int_type overflow(int_type ch) override
+        {
+            if (flush() < 0)
+                return traits_type::eof();
+            if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        int sync() override { return flush(); }
+
+    private:
+        int flush()
+        {
+            char *p = pbase();
+            while (p < pptr())
+            {
+                ssize_t n = ::write(fd, p, pptr() - p);
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return -1;
+                }
+                p += n;
+            }
+            setp(output, output + sizeof(output));
+            return 0;
+        }
+
+        int fd;
+        char input[1 << 16];
+        char output[1 << 16];
+    };
+
+    // Sends std::cout to a string while in scope, the AST dump writes to std::cout
+    class CoutCapture
+    {
+    public:
+        CoutCapture() : previous(std::cout.rdbuf(buffer.rdbuf())) {}
+        ~CoutCapture() { std::cout.rdbuf(previous); }
+        inline std::string str() const { return buffer.str(); }
+
+    private:
+        std::ostringstream buffer;
+        std::streambuf *previous;
+    };
+} // namespace
+
+static void reply(std::ostream &out, bool ok, const std::string &payload)
+{
+    out << (ok ? "ok " : "error ") << payload.size() << '\n'
+        << payload;
+    out.flush();
+}
+
+// Reads exactly bytes bytes, false if the input ends first
+static bool readSource(std::istream &in, size_t bytes, std::string &source)
+{
+    source.clear();
+    while (source.size() < bytes)
+    {
+        size_t offset = source.size();
+        size_t chunk = std::min(kReadChunkBytes, bytes - offset);
+        source.resize(offset + chunk);
+        if (!in.read(&source[offset], chunk))
+            return false;
+    }
+    return true;
+}
+
+// Turns the collected syntax errors of the last parse into an error payload
+static bool syntaxErrors(const QASM2Driver &driver, std::string &response)
+{
+    const std::vector<std::string> &messages = driver.getSyntaxErrorMessages();
+    if (messages.empty())
+        return false;
+
+    response = "Syntax errors: " + std::to_string(messages.size());
+    for (const auto &message : messages)
+    {
+        response += "\n" + message;
+    }
+    return true;
+}
+
+CompileServer::CompileServer()
+{
+    // syntax errors are answered to the client, not printed on the server's console
+    driver.setCollectSyntaxErrors(true);
+    driver.parseString(warmup::builtinCorpus());
+    estimator.estimateString(warmup::builtinCorpus());
+}
+
+bool CompileServer::serve(std::istream &in, std::ostream &out)
+{
+    std::string header;
+    while (std::getline(in, header))
+    {
+        if (header.empty())
+            continue;
+
+        std::istringstream fields(header);
+        std::string command, extra;
+        long long bytes = -1;
+        fields >> command >> bytes;
+        if (fields.fail() || bytes < 0 || (fields >> extra))
+        {
+            // the frame boundary is lost, so the session cannot continue
+            reply(out, false, "Malformed request header: " + header);
+            return true;
+        }
+        if (bytes > kMaxRequestBytes)
+        {
+            reply(out, false, "Request too large: " + std::to_string(bytes) + " bytes");
+            return true;
+        }
+
+        std::string source;
+        if (!readSource(in, static_cast<size_t>(bytes), source))
+        {
+            reply(out, false, "Truncated request: expected " + std::to_string(bytes) + " bytes");
+            return true;
+        }
+
+        if (command == "quit")
+        {
+            reply(out, true, "");
+            return false;
+        }
+        std::string response;
+        bool ok = handle(command, source, response);
+        reply(out, ok, response);
+    }
+    return true;
+}
+
+bool CompileServer::handle(const std::string &command, const std::string &source, std::string &response)
+{
+    requests++;
+    std::ostringstream out;
+    try
+    {
+        if (command == "parse")
+        {
+            driver.setCollectStats(false);
+            auto program = driver.parseString(source);
+            if (syntaxErrors(driver, response))
+                return false;
+            CoutCapture capture;
+            program->dump();
+            out << capture.str();
+        }
+        else if (command == "stats")
+        {
+            driver.setCollectStats(true);
+            driver.parseString(source);
+            if (syntaxErrors(driver, response))
+                return false;
+            driver.getStats().printJson(out);
+        }
+        else if (command == "resources")
+        {
+            estimator.estimateString(source).printJson(out);
+        }
+        else if (command == "validate")
+        {
+            DiagnosticSink sink;
+            Validator validator(sink);
+            bool valid = validator.validateString(source);
+            sink.print(out);
+            response = out.str();
+            return valid;
+        }
+        else
+        {
+            response = "Unknown command: " + command;
+            return false;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        response = e.what();
+        return false;
+    }
+    response = out.str();
+    return true;
+}
+
+void CompileServer::serveSocket(const std::string &path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("Socket path too long: " + path);
+    std::strcpy(address.sun_path, path.c_str());
+
+    // only a socket left by an earlier server is replaced, never another file
+    struct stat info;
+    if (::lstat(path.c_str(), &info) == 0)
+    {
+        if (!S_ISSOCK(info.st_mode))
+            throw std::runtime_error("Not a socket, refusing to replace: " + path);
+        ::unlink(path.c_str());
+    }
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 || ::listen(listener, 16) < 0)
+    {
+        std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Could not listen on " + path + ": " + reason);
+    }
+
+    // a client that disconnects early must not end the server
+    std::signal(SIGPIPE, SIG_IGN);
+
+    bool running = true;
+    while (running)
+    {
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        {
+            FdStreamBuf buffer(client);
+            std::istream in(&buffer);
+            std::ostream out(&buffer);
+            running = serve(in, out);
+        }
+        ::close(client);
+    }
+    ::close(listener);
+    ::unlink(path.c_str());
+}
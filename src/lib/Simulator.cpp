@@ -0,0 +1,886 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include "Simulator.h"
+#include "Relabel.h"
+#include "Stabilizer.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using namespace qasmcpp;
+
+typedef StatevectorSimulator::Amplitude Amplitude;
+
+// Largest supported state, 2^32 amplitudes take 64 GiB
+static const int kMaxQubits = 32;
+
+// States smaller than this many amplitudes are not worth splitting between threads
+static const int64_t kParallelThreshold = int64_t(1) << 14;
+
+// Blocks of 2^12 amplitudes (64 KiB) stay in the L2 cache. They are below
+// kParallelThreshold, so block kernels run single-threaded.
+const int StatevectorSimulator::kBlockQubits;
+
+// A tile of a high-gate group keeps runs of 2^6 contiguous amplitudes (1 KiB),
+// long enough for the prefetcher, the other bits of the tile are the group's
+// high qubits
+static const int kTileLowQubits = 6;
+static const int kTileHighQubits = StatevectorSimulator::kBlockQubits - kTileLowQubits;
+
+// SplitMix64 output function
+static inline uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline double toUniform(uint64_t bits)
+{
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Counter-based draw: shot i of a seed is the same on any thread and in any order
+static inline double counterUniform(uint64_t seed, uint64_t counter)
+{
+    return toUniform(mix64(seed + (counter + 1) * 0x9E3779B97F4A7C15ULL));
+}
+
+// Inserts a zero bit at position bit into index
+static inline uint64_t insertZero(uint64_t index, int bit)
+{
+    uint64_t low = index & ((uint64_t(1) << bit) - 1);
+    return ((index >> bit) << (bit + 1)) | low;
+}
+
+#ifdef __AVX2__
+// Multiplies two complex numbers packed in v by the complex numbers whose
+// real and imaginary parts are broadcast in re and im
+static inline __m256d complexMul(__m256d re, __m256d im, __m256d v)
+{
+    __m256d swapped = _mm256_permute_pd(v, 0x5);
+    return _mm256_addsub_pd(_mm256_mul_pd(re, v), _mm256_mul_pd(im, swapped));
+}
+#endif
+
+static void applyMatrixKernel(Amplitude *state, int64_t dim, int qubit, const Amplitude m[4])
+{
+    const int64_t half = dim / 2;
+    const uint64_t stride = uint64_t(1) << qubit;
+
+#ifdef __AVX2__
+    double *amps = reinterpret_cast<double *>(state);
+    if (qubit == 0)
+    {
+        // the pair (a0, a1) sits in one register, combine it with its halves swapped
+        const __m256d diagRe = _mm256_setr_pd(m[0].real(), m[0].real(), m[3].real(), m[3].real());
+        const __m256d diagIm = _mm256_setr_pd(m[0].imag(), m[0].imag(), m[3].imag(), m[3].imag());
+        const __m256d offRe = _mm256_setr_pd(m[1].real(), m[1].real(), m[2].real(), m[2].real());
+        const __m256d offIm = _mm256_setr_pd(m[1].imag(), m[1].imag(), m[2].imag(), m[2].imag());
+
+#pragma omp parallel for if (dim >= kParallelThreshold)
+        for (int64_t k = 0; k < half; ++k)
+        {
+            double *p = amps + 4 * k;
+            __m256d v = _mm256_loadu_pd(p);
+            __m256d swapped = _mm256_permute2f128_pd(v, v, 0x01);
+            __m256d result = _mm256_add_pd(complexMul(diagRe, diagIm, v), complexMul(offRe, offIm, swapped));
+            _mm256_storeu_pd(p, result);
+        }
+        return;
+    }
+
+    // two neighbouring pairs per iteration, both halves are contiguous for qubit >= 1
+    const __m256d m0Re = _mm256_set1_pd(m[0].real()), m0Im = _mm256_set1_pd(m[0].imag());
+    const __m256d m1Re = _mm256_set1_pd(m[1].real()), m1Im = _mm256_set1_pd(m[1].imag());
+    const __m256d m2Re = _mm256_set1_pd(m[2].real()), m2Im = _mm256_set1_pd(m[2].imag());
+    const __m256d m3Re = _mm256_set1_pd(m[3].real()), m3Im = _mm256_set1_pd(m[3].imag());
+
+#pragma omp parallel for if (dim >= kParallelThreshold)
+    for (int64_t k = 0; k < half; k += 2)
+    {
+        uint64_t i0 = insertZero(k, qubit);
+        double *p0 = amps + 2 * i0;
+        double *p1 = amps + 2 * (i0 | stride);
+        __m256d a0 = _mm256_loadu_pd(p0);
+        __m256d a1 = _mm256_loadu_pd(p1);
+        _mm256_storeu_pd(p0, _mm256_add_pd(complexMul(m0Re, m0Im, a0), complexMul(m1Re, m1Im, a1)));
+        _mm256_storeu_pd(p1, _mm256_add_pd(complexMul(m2Re, m2Im, a0), complexMul(m3Re, m3Im, a1)));
+    }
+#else
+#pragma omp parallel for if (dim >= kParallelThreshold)
+    for (int64_t k = 0; k < half; ++k)
+    {
+        uint64_t i0 = insertZero(k, qubit);
+        uint64_t i1 = i0 | stride;
+        Amplitude a0 = state[i0];
+        Amplitude a1 = state[i1];
+        state[i0] = m[0] * a0 + m[1] * a1;
+        state[i1] = m[2] * a0 + m[3] * a1;
+    }
+#endif
+}
+
+static void applyCXKernel(Amplitude *state, int64_t dim, int control, int target)
+{
+    const int64_t quarter = dim / 4;
+    const int low = control < target ? control : target;
+    const int high = control < target ? target : control;
+    const uint64_t controlMask = uint64_t(1) << control;
+    const uint64_t targetMask = uint64_t(1) << target;
+
+#ifdef __AVX2__
+    if (low >= 1)
+    {
+        // neighbouring indices share the control and target bits, swap them two at a time
+        double *amps = reinterpret_cast<double *>(state);
+
+#pragma omp parallel for if (dim >= kParallelThreshold)
+        for (int64_t k = 0; k < quarter; k += 2)
+        {
+            uint64_t i = insertZero(insertZero(k, low), high) | controlMask;
+            double *p0 = amps + 2 * i;
+            double *p1 = amps + 2 * (i | targetMask);
+            __m256d a0 = _mm256_loadu_pd(p0);
+            __m256d a1 = _mm256_loadu_pd(p1);
+            _mm256_storeu_pd(p0, a1);
+            _mm256_storeu_pd(p1, a0);
+        }
+        return;
+    }
+#endif
+
+#pragma omp parallel for if (dim >= kParallelThreshold)
+    for (int64_t k = 0; k < quarter; ++k)
+    {
+        uint64_t i = insertZero(insertZero(k, low), high) | controlMask;
+        std::swap(state[i], state[i | targetMask]);
+    }
+}
+
+StatevectorSimulator::StatevectorSimulator(int numQubits, uint64_t seed)
+    : numQubits(numQubits), rngState(seed)
+{
+    if (numQubits < 0 || numQubits > kMaxQubits)
+        throw std::runtime_error("Statevector simulation supports up to " + std::to_string(kMaxQubits) + " qubits");
+
+    state.resize(size_t(1) << numQubits);
+    initialize();
+}
+
+void StatevectorSimulator::initialize()
+{
+    if (stats)
+        stats->sweeps++;
+
+    const int64_t dim = static_cast<int64_t>(state.size());
+    Amplitude *amps = state.data();
+
+#pragma omp parallel for if (dim >= kParallelThreshold)
+    for (int64_t i = 0; i < dim; ++i)
+    {
+        amps[i] = 0;
+    }
+    amps[0] = 1;
+}
+
+void StatevectorSimulator::applyU(int qubit, double theta, double phi, double lambda)
+{
+    applyMatrix(qubit, MatrixCache::uMatrix(theta, phi, lambda).data());
+}
+
+void StatevectorSimulator::applyMatrix(int qubit, const Amplitude matrix[4])
+{
+    if (qubit < 0 || qubit >= numQubits)
+        throw std::runtime_error("Qubit out of range: " + std::to_string(qubit));
+    applyMatrixKernel(state.data(), static_cast<int64_t>(state.size()), qubit, matrix);
+}
+
+void StatevectorSimulator::applyCX(int control, int target)
+{
+    if (control < 0 || control >= numQubits || target < 0 || target >= numQubits || control == target)
+        throw std::runtime_error("Invalid CX qubits: " + std::to_string(control) + ", " + std::to_string(target));
+    applyCXKernel(state.data(), static_cast<int64_t>(state.size()), control, target);
+}
+
+double StatevectorSimulator::qubitProbability(int qubit) const
+{
+    if (qubit < 0 || qubit >= numQubits)
+        throw std::runtime_error("Qubit out of range: " + std::to_string(qubit));
+
+    const int64_t dim = static_cast<int64_t>(state.size());
+    const uint64_t mask = uint64_t(1) << qubit;
+    const Amplitude *amps = state.data();
+
+    double one = 0;
+#pragma omp parallel for reduction(+ : one) if (dim >= kParallelThreshold)
+    for (int64_t i = 0; i < dim; ++i)
+    {
+        if (i & mask)
+            one += std::norm(amps[i]);
+    }
+    return one;
+}
+
+int StatevectorSimulator::measure(int qubit)
+{
+    // one pass for the probability, one to collapse
+    if (stats)
+        stats->sweeps += 2;
+
+    const double one = qubitProbability(qubit);
+    const int64_t dim = static_cast<int64_t>(state.size());
+    const uint64_t mask = uint64_t(1) << qubit;
+    Amplitude *amps = state.data();
+
+    int outcome = nextUniform() < one ? 1 : 0;
+    const double scale = 1 / std::sqrt(outcome ? one : 1 - one);
+    const uint64_t kept = outcome ? mask : 0;
+
+#pragma omp parallel for if (dim >= kParallelThreshold)
+    for (int64_t i = 0; i < dim; ++i)
+    {
+        amps[i] = (uint64_t(i) & mask) == kept ? amps[i] * scale : Amplitude(0);
+    }
+    return outcome;
+}
+
+void StatevectorSimulator::reset(int qubit)
+{
+    if (measure(qubit) == 1)
+    {
+        const Amplitude x[4] = {0, 1, 1, 0};
+        applyMatrix(qubit, x);
+    }
+}
+
+void StatevectorSimulator::run(const Circuit &circuit, std::vector<int> &cbits)
+{
+    run(circuit, scheduleLayers(circuit), cbits);
+}
+
+void StatevectorSimulator::run(const Circuit &circuit, const std::vector<Layer> &layers, std::vector<int> &cbits)
+{
+    ClassicalState classical(circuit);
+    execute(circuit, layers, classical, true);
+    classical.toBits(cbits);
+}
+
+void StatevectorSimulator::run(const Circuit &circuit, const std::vector<Layer> &layers, ClassicalState &classical)
+{
+    execute(circuit, layers, classical, true);
+}
+
+void StatevectorSimulator::evolve(const Circuit &circuit)
+{
+    ClassicalState classical(circuit);
+    execute(circuit, scheduleLayers(circuit), classical, false);
+}
+
+void StatevectorSimulator::execute(const Circuit &circuit, const std::vector<Layer> &layers, ClassicalState &classical, bool measureBits)
+{
+    if (circuit.numQubits != numQubits)
+        throw std::runtime_error("Circuit does not match the number of simulated qubits");
+
+    layout = circuit.physicalQubits;
+    initialize();
+    classical.clear();
+
+    for (const auto &layer : layers)
+    {
+        const Instruction &instruction = circuit.instructions[layer.begin];
+        if (!layer.gates && instruction.condition >= 0 && !classical.test(circuit.conditions[instruction.condition]))
+            continue;
+
+        if (layer.gates || instruction.op == Instruction::U || instruction.op == Instruction::CX)
+        {
+            applyLayer(circuit, layer);
+        }
+        else if (instruction.op == Instruction::MEASURE)
+        {
+            if (measureBits)
+                classical.set(instruction.cbit, measure(instruction.qubits[0]));
+        }
+        else if (instruction.op == Instruction::RESET)
+        {
+            reset(instruction.qubits[0]);
+        }
+    }
+}
+
+// Applies a gate instruction to a range of amplitudes whose size is a power of two
+static void applyGate(Amplitude *amps, int64_t dim, const Circuit &circuit, const Instruction &instruction)
+{
+    if (instruction.op == Instruction::U)
+        applyMatrixKernel(amps, dim, instruction.qubits[0], circuit.matrices.get(instruction.matrixId).data());
+    else
+        applyCXKernel(amps, dim, instruction.qubits[0], instruction.qubits[1]);
+}
+
+// Applies gates whose qubits at or above kTileLowQubits are the given high
+// qubits in one pass: each tile of 2^kTileLowQubits contiguous amplitudes
+// times every value of the high qubits is gathered into a cache-resident
+// buffer, where the gates act on remapped qubits, and scattered back
+static void applyGroup(Amplitude *amps, int64_t dim, const Circuit &circuit,
+                       const std::vector<Instruction> &gates, const std::vector<int> &high)
+{
+    const int tileQubits = kTileLowQubits + static_cast<int>(high.size());
+    const int64_t tileSize = int64_t(1) << tileQubits;
+    const int64_t runSize = int64_t(1) << kTileLowQubits;
+    const int64_t runs = int64_t(1) << high.size();
+    const int64_t tiles = dim >> tileQubits;
+
+    // offset of every run from the start of its tile
+    std::vector<uint64_t> offsets(runs, 0);
+    for (int64_t j = 0; j < runs; ++j)
+    {
+        for (size_t i = 0; i < high.size(); ++i)
+        {
+            if (j >> i & 1)
+                offsets[j] |= uint64_t(1) << high[i];
+        }
+    }
+
+#pragma omp parallel if (dim >= kParallelThreshold)
+    {
+        std::vector<Amplitude> tile(tileSize);
+
+#pragma omp for
+        for (int64_t k = 0; k < tiles; ++k)
+        {
+            // the high qubits are sorted, so inserting their zero bits in order gives the tile start
+            uint64_t base = uint64_t(k) << kTileLowQubits;
+            for (int qubit : high)
+            {
+                base = insertZero(base, qubit);
+            }
+
+            for (int64_t j = 0; j < runs; ++j)
+            {
+                std::copy(amps + (base + offsets[j]), amps + (base + offsets[j] + runSize), tile.data() + j * runSize);
+            }
+            for (const Instruction &gate : gates)
+            {
+                applyGate(tile.data(), tileSize, circuit, gate);
+            }
+            for (int64_t j = 0; j < runs; ++j)
+            {
+                std::copy(tile.data() + j * runSize, tile.data() + (j + 1) * runSize, amps + (base + offsets[j]));
+            }
+        }
+    }
+}
+
+void StatevectorSimulator::applyLayer(const Circuit &circuit, const Layer &layer)
+{
+    const int blockQubits = numQubits < kBlockQubits ? numQubits : kBlockQubits;
+    const int64_t blockSize = int64_t(1) << blockQubits;
+    const int64_t blocks = static_cast<int64_t>(state.size()) >> blockQubits;
+
+    // gates below the block size act inside each block, the others span blocks
+    std::vector<const Instruction *> local;
+    std::vector<const Instruction *> global;
+    for (size_t i = layer.begin; i < layer.end; ++i)
+    {
+        const Instruction &instruction = circuit.instructions[i];
+        int first = instruction.qubits[0];
+        int second = instruction.op == Instruction::CX ? instruction.qubits[1] : first;
+        if (first < 0 || first >= numQubits || second < 0 || second >= numQubits)
+            throw std::runtime_error("Qubit out of range: " + std::to_string(first < 0 || first >= numQubits ? first : second));
+
+        (first < blockQubits && second < blockQubits ? local : global).push_back(&instruction);
+    }
+
+    // the gates of a layer act on disjoint qubits, so the global ones are
+    // split into groups of up to kTileHighQubits qubits above the tile runs
+    std::vector<std::vector<const Instruction *>> groups;
+    std::vector<std::vector<int>> groupQubits;
+    for (const Instruction *instruction : global)
+    {
+        std::vector<int> qubits;
+        for (int i = 0; i < (instruction->op == Instruction::CX ? 2 : 1); ++i)
+        {
+            if (instruction->qubits[i] >= kTileLowQubits)
+                qubits.push_back(instruction->qubits[i]);
+        }
+        if (groups.empty() || groupQubits.back().size() + qubits.size() > static_cast<size_t>(kTileHighQubits))
+        {
+            groups.emplace_back();
+            groupQubits.emplace_back();
+        }
+        groups.back().push_back(instruction);
+        groupQubits.back().insert(groupQubits.back().end(), qubits.begin(), qubits.end());
+    }
+
+    // one sweep for all local gates, each block stays in cache while they are applied,
+    // and one per group of global gates
+    if (stats)
+    {
+        stats->sweeps += groups.size() + (local.empty() ? 0 : 1);
+        stats->blockedGates += local.size();
+        for (const auto &group : groups)
+        {
+            stats->blockedGates += group.size() > 1 ? group.size() : 0;
+        }
+    }
+
+    Amplitude *amps = state.data();
+    const int64_t dim = static_cast<int64_t>(state.size());
+    if (!local.empty())
+    {
+#pragma omp parallel for if (dim >= kParallelThreshold)
+        for (int64_t b = 0; b < blocks; ++b)
+        {
+            for (const Instruction *instruction : local)
+            {
+                applyGate(amps + b * blockSize, blockSize, circuit, *instruction);
+            }
+        }
+    }
+
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        // a gate on its own gains nothing from the gather
+        if (groups[g].size() == 1)
+        {
+            applyGate(amps, dim, circuit, *groups[g][0]);
+            continue;
+        }
+
+        // the gates act on the tile, high qubit i is tile qubit kTileLowQubits + i
+        std::vector<int> &high = groupQubits[g];
+        std::sort(high.begin(), high.end());
+        std::vector<Instruction> gates;
+        gates.reserve(groups[g].size());
+        for (const Instruction *instruction : groups[g])
+        {
+            Instruction gate = *instruction;
+            for (int &qubit : gate.qubits)
+            {
+                if (qubit >= kTileLowQubits)
+                    qubit = kTileLowQubits + static_cast<int>(std::lower_bound(high.begin(), high.end(), qubit) - high.begin());
+            }
+            gates.push_back(gate);
+        }
+        applyGroup(amps, dim, circuit, gates, high);
+    }
+}
+
+uint64_t StatevectorSimulator::physicalIndex(uint64_t index) const
+{
+    if (layout.empty())
+        return index;
+
+    uint64_t physical = 0;
+    for (size_t qubit = 0; qubit < layout.size(); ++qubit)
+    {
+        if (index >> qubit & 1)
+            physical |= uint64_t(1) << layout[qubit];
+    }
+    return physical;
+}
+
+StatevectorSimulator::Amplitude StatevectorSimulator::amplitude(uint64_t index) const
+{
+    return state.at(physicalIndex(index));
+}
+
+double StatevectorSimulator::probability(uint64_t index) const
+{
+    return std::norm(amplitude(index));
+}
+
+// SplitMix64 mapped to [0, 1), so the samples only depend on the seed
+double StatevectorSimulator::nextUniform()
+{
+    return toUniform(mix64(rngState += 0x9E3779B97F4A7C15ULL));
+}
+
+std::string qasmcpp::formatCbits(const Circuit &circuit, const std::vector<int> &cbits)
+{
+    std::string outcome;
+    for (auto creg = circuit.cregs.rbegin(); creg != circuit.cregs.rend(); ++creg)
+    {
+        if (!outcome.empty())
+            outcome += ' ';
+        for (int i = creg->size - 1; i >= 0; --i)
+        {
+            outcome += cbits[creg->offset + i] ? '1' : '0';
+        }
+    }
+    return outcome;
+}
+
+bool qasmcpp::hasTerminalMeasurements(const Circuit &circuit)
+{
+    // a condition depends on the outcome of a measurement before it
+    if (!circuit.conditions.empty())
+        return false;
+
+    std::vector<char> measured(circuit.numQubits, 0);
+    for (const auto &instruction : circuit.instructions)
+    {
+        switch (instruction.op)
+        {
+        case Instruction::MEASURE:
+            measured[instruction.qubits[0]] = 1;
+            break;
+        case Instruction::U:
+            if (measured[instruction.qubits[0]])
+                return false;
+            break;
+        case Instruction::CX:
+            if (measured[instruction.qubits[0]] || measured[instruction.qubits[1]])
+                return false;
+            break;
+        case Instruction::RESET:
+            return false;
+        }
+    }
+    return true;
+}
+
+void qasmcpp::recordOutcome(SimResult &result, const Circuit &circuit, const std::vector<int> &cbits, size_t count)
+{
+    result.counts[formatCbits(circuit, cbits)] += count;
+    for (const auto &creg : circuit.cregs)
+    {
+        std::string bits;
+        for (int i = creg.size - 1; i >= 0; --i)
+        {
+            bits += cbits[creg.offset + i] ? '1' : '0';
+        }
+        result.registerCounts[creg.name][bits] += count;
+    }
+}
+
+// Simulates once and draws every shot from the final distribution
+static void sampleFinalState(const Circuit &circuit, const SimOptions &options, SimResult &result)
+{
+    StatevectorSimulator simulator(circuit.numQubits, options.seed);
+    simulator.setStats(&result.stats);
+    {
+        PhaseTimer timer(&result.stats.simulateTime);
+        simulator.evolve(circuit);
+    }
+    result.simulations = 1;
+
+    PhaseTimer timer(&result.stats.sampleTime);
+    const auto &state = simulator.getState();
+    const int numQubits = circuit.numQubits;
+
+    // bit position of each declared qubit and the reverse mapping
+    std::vector<int> position(numQubits), logical(numQubits);
+    for (int qubit = 0; qubit < numQubits; ++qubit)
+    {
+        position[qubit] = circuit.physicalQubits.empty() ? qubit : circuit.physicalQubits[qubit];
+        logical[position[qubit]] = qubit;
+    }
+
+    // the distribution is accumulated in declared qubit order, so the samples
+    // do not depend on relabeling. Going from i - 1 to i flips the qubits up to
+    // the lowest set bit of i, whose positions are in flips.
+    std::vector<uint64_t> flips(numQubits + 1, 0);
+    for (int qubit = 0; qubit < numQubits; ++qubit)
+    {
+        flips[qubit] = (qubit > 0 ? flips[qubit - 1] : 0) | (uint64_t(1) << position[qubit]);
+    }
+
+    std::vector<double> cumulative(state.size());
+    double total = 0;
+    uint64_t physical = 0;
+    for (uint64_t i = 0; i < state.size(); ++i)
+    {
+        if (i > 0)
+        {
+            int lowest = 0;
+            while (!(i >> lowest & 1))
+                lowest++;
+            physical ^= flips[lowest];
+        }
+        total += std::norm(state[physical]);
+        cumulative[i] = total;
+    }
+
+    // histogram of sampled basis states, one per thread and merged at the end
+    std::unordered_map<uint64_t, size_t> histogram;
+    const int64_t shots = static_cast<int64_t>(options.shots);
+
+#pragma omp parallel
+    {
+        std::unordered_map<uint64_t, size_t> local;
+
+#pragma omp for nowait
+        for (int64_t shot = 0; shot < shots; ++shot)
+        {
+            double r = counterUniform(options.seed, shot) * total;
+            auto it = std::upper_bound(cumulative.begin(), cumulative.end(), r);
+            if (it == cumulative.end())
+                --it;
+            local[it - cumulative.begin()]++;
+        }
+
+#pragma omp critical
+        for (const auto &entry : local)
+        {
+            histogram[entry.first] += entry.second;
+        }
+    }
+
+    // sorted so the outcomes are recorded in the same order on every run
+    std::vector<std::pair<uint64_t, size_t>> outcomes(histogram.begin(), histogram.end());
+    std::sort(outcomes.begin(), outcomes.end());
+
+    // measurements in program order, a later one wins on a shared cbit
+    std::vector<const Instruction *> measures;
+    for (const auto &instruction : circuit.instructions)
+    {
+        if (instruction.op == Instruction::MEASURE)
+            measures.push_back(&instruction);
+    }
+
+    std::vector<int> cbits(circuit.numCbits);
+    for (const auto &outcome : outcomes)
+    {
+        std::fill(cbits.begin(), cbits.end(), 0);
+        for (const Instruction *measure : measures)
+        {
+            cbits[measure->cbit] = (outcome.first >> logical[measure->qubits[0]]) & 1;
+        }
+        recordOutcome(result, circuit, cbits, outcome.second);
+    }
+}
+
+// Measures a copy of the tableau in program order. The i-th random
+// measurement takes outcome choices[i], and randomMeasures receives the
+// positions of the random measurements if given.
+static std::vector<uint8_t> measureCopy(const StabilizerSimulator &evolved, const std::vector<const Instruction *> &measures,
+                                        const std::vector<uint8_t> &choices, std::vector<size_t> *randomMeasures)
+{
+    StabilizerSimulator tableau = evolved;
+    std::vector<uint8_t> outcomes(measures.size());
+    size_t next = 0;
+    for (size_t i = 0; i < measures.size(); ++i)
+    {
+        bool random;
+        outcomes[i] = static_cast<uint8_t>(tableau.measure(measures[i]->qubits[0], next < choices.size() ? choices[next] : 0, random));
+        if (random)
+        {
+            next++;
+            if (randomMeasures)
+                randomMeasures->push_back(i);
+        }
+    }
+    return outcomes;
+}
+
+// Runs every shot on a stabilizer tableau. With terminal measurements the
+// gates are applied once. The outcomes are then affine in the choices of the
+// k random measurements, so k + 1 measurement passes give the map and each
+// shot only draws k bits.
+static void simulateStabilizer(const Circuit &circuit, const SimOptions &options, SimResult &result)
+{
+    result.stats.stabilizer = true;
+    const bool terminal = options.sampleTerminal && hasTerminalMeasurements(circuit);
+    const int64_t shots = static_cast<int64_t>(options.shots);
+
+    // shots draw from their own seed, so the counts do not depend on the thread count
+    std::map<std::vector<int>, size_t> histogram;
+    auto shotSeed = [&](int64_t shot) { return mix64(options.seed + 0x9E3779B97F4A7C15ULL * (shot + 1)); };
+
+    if (!terminal)
+    {
+        PhaseTimer timer(&result.stats.simulateTime);
+
+#pragma omp parallel
+        {
+            std::map<std::vector<uint64_t>, size_t> local;
+            StabilizerSimulator tableau(circuit.numQubits);
+            ClassicalState classical(circuit);
+            std::vector<int> cbits;
+
+#pragma omp for nowait
+            for (int64_t shot = 0; shot < shots; ++shot)
+            {
+                tableau.setSeed(shotSeed(shot));
+                tableau.run(circuit, classical);
+                local[classical.getWords()]++;
+            }
+
+#pragma omp critical
+            for (const auto &entry : local)
+            {
+                classical.setWords(entry.first);
+                classical.toBits(cbits);
+                histogram[cbits] += entry.second;
+            }
+        }
+        result.simulations = options.shots;
+    }
+    else
+    {
+        StabilizerSimulator evolved(circuit.numQubits);
+        {
+            PhaseTimer timer(&result.stats.simulateTime);
+            evolved.evolve(circuit);
+        }
+        result.simulations = 1;
+
+        PhaseTimer timer(&result.stats.sampleTime);
+        std::vector<const Instruction *> measures;
+        for (const auto &instruction : circuit.instructions)
+        {
+            if (instruction.op == Instruction::MEASURE)
+                measures.push_back(&instruction);
+        }
+
+        std::vector<size_t> randomMeasures;
+        const std::vector<uint8_t> base = measureCopy(evolved, measures, std::vector<uint8_t>(), &randomMeasures);
+        const int64_t k = static_cast<int64_t>(randomMeasures.size());
+
+        // outcome change of flipping each random choice, only worth it for more shots than passes
+        const bool affine = k < shots;
+        std::vector<std::vector<uint8_t>> columns(affine ? k : 0);
+
+#pragma omp parallel for if (affine)
+        for (int64_t j = 0; j < static_cast<int64_t>(columns.size()); ++j)
+        {
+            std::vector<uint8_t> choices(k, 0);
+            choices[j] = 1;
+            columns[j] = measureCopy(evolved, measures, choices, nullptr);
+            for (size_t i = 0; i < base.size(); ++i)
+            {
+                columns[j][i] ^= base[i];
+            }
+        }
+
+#pragma omp parallel
+        {
+            std::map<std::vector<int>, size_t> local;
+            std::vector<uint8_t> choices(k);
+            std::vector<int> cbits(circuit.numCbits);
+
+#pragma omp for nowait
+            for (int64_t shot = 0; shot < shots; ++shot)
+            {
+                uint64_t seed = shotSeed(shot);
+                for (int64_t j = 0; j < k; ++j)
+                {
+                    choices[j] = static_cast<uint8_t>(mix64(seed + 0x9E3779B97F4A7C15ULL * (j + 1)) >> 63);
+                }
+
+                std::vector<uint8_t> outcomes;
+                if (affine)
+                {
+                    outcomes = base;
+                    for (int64_t j = 0; j < k; ++j)
+                    {
+                        if (!choices[j])
+                            continue;
+                        for (size_t i = 0; i < outcomes.size(); ++i)
+                        {
+                            outcomes[i] ^= columns[j][i];
+                        }
+                    }
+                }
+                else
+                {
+                    outcomes = measureCopy(evolved, measures, choices, nullptr);
+                }
+
+                std::fill(cbits.begin(), cbits.end(), 0);
+                for (size_t i = 0; i < measures.size(); ++i)
+                {
+                    cbits[measures[i]->cbit] = outcomes[i];
+                }
+                local[cbits]++;
+            }
+
+#pragma omp critical
+            for (const auto &entry : local)
+            {
+                histogram[entry.first] += entry.second;
+            }
+        }
+    }
+
+    for (const auto &outcome : histogram)
+    {
+        recordOutcome(result, circuit, outcome.first, outcome.second);
+    }
+}
+
+// Gates touching a qubit above the cache block size take a full sweep of their own
+static size_t countHighGates(const Circuit &circuit)
+{
+    size_t count = 0;
+    for (const auto &instruction : circuit.instructions)
+    {
+        if ((instruction.op == Instruction::U && instruction.qubits[0] >= StatevectorSimulator::kBlockQubits) ||
+            (instruction.op == Instruction::CX && (instruction.qubits[0] >= StatevectorSimulator::kBlockQubits ||
+                                                   instruction.qubits[1] >= StatevectorSimulator::kBlockQubits)))
+            count++;
+    }
+    return count;
+}
+
+SimResult qasmcpp::simulate(const Circuit &circuit, const SimOptions &options)
+{
+    SimResult result;
+
+    if (options.useStabilizer && isCliffordCircuit(circuit))
+    {
+        simulateStabilizer(circuit, options, result);
+        return result;
+    }
+
+    // relabeling rewrites a copy, measured cbits are the same either way
+    Circuit relabeled;
+    const Circuit *target = &circuit;
+    result.stats.highGatesBefore = countHighGates(circuit);
+    if (options.relabelQubits)
+    {
+        relabeled = circuit;
+        result.stats.relabeledQubits = relabelQubits(relabeled, chooseQubitOrder(circuit));
+        target = &relabeled;
+    }
+    result.stats.highGatesAfter = countHighGates(*target);
+
+    std::vector<Layer> layers = scheduleLayers(*target);
+    result.stats.layers = layers.size();
+
+    if (options.sampleTerminal && options.shots > 0 && hasTerminalMeasurements(*target))
+    {
+        sampleFinalState(*target, options, result);
+        return result;
+    }
+
+    StatevectorSimulator simulator(target->numQubits, options.seed);
+    simulator.setStats(&result.stats);
+    ClassicalState classical(*target);
+
+    // shots are counted by their packed classical words and formatted once per outcome
+    std::map<std::vector<uint64_t>, size_t> histogram;
+    {
+        PhaseTimer timer(&result.stats.simulateTime);
+        for (size_t shot = 0; shot < options.shots; ++shot)
+        {
+            simulator.run(*target, layers, classical);
+            histogram[classical.getWords()]++;
+        }
+    }
+    result.simulations = options.shots;
+
+    std::vector<int> cbits;
+    for (const auto &outcome : histogram)
+    {
+        classical.setWords(outcome.first);
+        classical.toBits(cbits);
+        recordOutcome(result, *target, cbits, outcome.second);
+    }
+    return result;
+}
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include "Stabilizer.h"
+
+using namespace qasmcpp;
+
+// Multiple of pi/2 of an angle in [0, 4), or -1 if the angle is not one
+static int quarterTurns(double angle)
+{
+    const double halfPi = 1.5707963267948966;
+    double turns = angle / halfPi;
+    double rounded = std::round(turns);
+    if (std::fabs(turns - rounded) > 1e-9)
+        return -1;
+    return static_cast<int>(((static_cast<long long>(rounded) % 4) + 4) % 4);
+}
+
+static inline int popcount(uint64_t word)
+{
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+}
+
+bool qasmcpp::isCliffordU(double theta, double phi, double lambda)
+{
+    return quarterTurns(theta) >= 0 && quarterTurns(phi) >= 0 && quarterTurns(lambda) >= 0;
+}
+
+bool qasmcpp::isCliffordCircuit(const Circuit &circuit)
+{
+    for (const auto &instruction : circuit.instructions)
+    {
+        if (instruction.op == Instruction::U &&
+            !isCliffordU(instruction.params[0], instruction.params[1], instruction.params[2]))
+            return false;
+    }
+    return true;
+}
+
+StabilizerSimulator::StabilizerSimulator(int numQubits, uint64_t seed)
+    : numQubits(numQubits), words((numQubits + 63) / 64), rngState(seed)
+{
+    if (numQubits < 0)
+        throw std::runtime_error("Invalid number of qubits: " + std::to_string(numQubits));
+
+    bits.resize((2 * size_t(numQubits) + 1) * 2 * words);
+    phases.resize(2 * size_t(numQubits) + 1);
+    initialize();
+}
+
+void StabilizerSimulator::initialize()
+{
+    std::fill(bits.begin(), bits.end(), 0);
+    std::fill(phases.begin(), phases.end(), 0);
+
+    // destabilizer i is X_i, stabilizer i is Z_i
+    for (int i = 0; i < numQubits; ++i)
+    {
+        xRow(i)[i / 64] |= uint64_t(1) << (i % 64);
+        zRow(numQubits + i)[i / 64] |= uint64_t(1) << (i % 64);
+    }
+}
+
+void StabilizerSimulator::applyH(int qubit)
+{
+    const size_t word = qubit / 64;
+    const uint64_t mask = uint64_t(1) << (qubit % 64);
+    for (size_t row = 0; row < 2 * size_t(numQubits); ++row)
+    {
+        uint64_t &x = xRow(row)[word];
+        uint64_t &z = zRow(row)[word];
+        phases[row] ^= (x & z & mask) != 0;
+        uint64_t flip = (x ^ z) & mask;
+        x ^= flip;
+        z ^= flip;
+    }
+}
+
+void StabilizerSimulator::applyS(int qubit)
+{
+    const size_t word = qubit / 64;
+    const uint64_t mask = uint64_t(1) << (qubit % 64);
+    for (size_t row = 0; row < 2 * size_t(numQubits); ++row)
+    {
+        uint64_t x = xRow(row)[word];
+        uint64_t &z = zRow(row)[word];
+        phases[row] ^= (x & z & mask) != 0;
+        z ^= x & mask;
+    }
+}
+
+void StabilizerSimulator::applyX(int qubit)
+{
+    const size_t word = qubit / 64;
+    const uint64_t mask = uint64_t(1) << (qubit % 64);
+    for (size_t row = 0; row < 2 * size_t(numQubits); ++row)
+    {
+        phases[row] ^= (zRow(row)[word] & mask) != 0;
+    }
+}
+
+void StabilizerSimulator::applyZ(int qubit)
+{
+    const size_t word = qubit / 64;
+    const uint64_t mask = uint64_t(1) << (qubit % 64);
+    for (size_t row = 0; row < 2 * size_t(numQubits); ++row)
+    {
+        phases[row] ^= (xRow(row)[word] & mask) != 0;
+    }
+}
+
+void StabilizerSimulator::applyCX(int control, int target)
+{
+    if (control < 0 || control >= numQubits || target < 0 || target >= numQubits || control == target)
+        throw std::runtime_error("Invalid CX qubits: " + std::to_string(control) + ", " + std::to_string(target));
+
+    const size_t cw = control / 64, tw = target / 64;
+    const int cb = control % 64, tb = target % 64;
+    for (size_t row = 0; row < 2 * size_t(numQubits); ++row)
+    {
+        uint64_t *x = xRow(row);
+        uint64_t *z = zRow(row);
+        int xc = x[cw] >> cb & 1, zc = z[cw] >> cb & 1;
+        int xt = x[tw] >> tb & 1, zt = z[tw] >> tb & 1;
+        phases[row] ^= xc & zt & (xt ^ zc ^ 1);
+        x[tw] ^= uint64_t(xc) << tb;
+        z[cw] ^= uint64_t(zt) << cb;
+    }
+}
+
+// U(theta, phi, lambda) = Rz(phi) Ry(theta) Rz(lambda) up to global phase,
+// with Rz(pi/2) = S and Ry(pi/2) = H Z
+void StabilizerSimulator::applyU(int qubit, double theta, double phi, double lambda)
+{
+    if (qubit < 0 || qubit >= numQubits)
+        throw std::runtime_error("Qubit out of range: " + std::to_string(qubit));
+
+    int t = quarterTurns(theta), p = quarterTurns(phi), l = quarterTurns(lambda);
+    if (t < 0 || p < 0 || l < 0)
+        throw std::runtime_error("U gate is not a Clifford gate");
+
+    for (int i = 0; i < l; ++i)
+        applyS(qubit);
+    for (int i = 0; i < t; ++i)
+    {
+        applyZ(qubit);
+        applyH(qubit);
+    }
+    for (int i = 0; i < p; ++i)
+        applyS(qubit);
+}
+
+// Multiplies row source into row target, tracking the phase of the product
+void StabilizerSimulator::rowsum(size_t target, size_t source)
+{
+    const uint64_t *x1 = xRow(source);
+    const uint64_t *z1 = zRow(source);
+    uint64_t *x2 = xRow(target);
+    uint64_t *z2 = zRow(target);
+
+    // sum of the Pauli product phases, +1 and -1 per qubit counted a word at a time
+    int sum = 2 * phases[target] + 2 * phases[source];
+    for (size_t w = 0; w < words; ++w)
+    {
+        uint64_t a = x1[w], b = z1[w], c = x2[w], d = z2[w];
+        uint64_t positive = (a & b & d & ~c) | (a & ~b & c & d) | (~a & b & c & ~d);
+        uint64_t negative = (a & b & c & ~d) | (a & ~b & ~c & d) | (~a & b & c & d);
+        sum += popcount(positive) - popcount(negative);
+        x2[w] = c ^ a;
+        z2[w] = d ^ b;
+    }
+    phases[target] = ((sum % 4) + 4) % 4 == 2;
+}
+
+void StabilizerSimulator::rowcopy(size_t target, size_t source)
+{
+    std::copy(xRow(source), xRow(source) + 2 * words, xRow(target));
+    phases[target] = phases[source];
+}
+
+void StabilizerSimulator::rowclear(size_t row)
+{
+    std::fill(xRow(row), xRow(row) + 2 * words, 0);
+    phases[row] = 0;
+}
+
+int StabilizerSimulator::measure(int qubit)
+{
+    bool random;
+    return measure(qubit, -1, random);
+}
+
+int StabilizerSimulator::measure(int qubit, int outcome, bool &random)
+{
+    if (qubit < 0 || qubit >= numQubits)
+        throw std::runtime_error("Qubit out of range: " + std::to_string(qubit));
+
+    const size_t n = numQubits;
+    const size_t word = qubit / 64;
+    const uint64_t mask = uint64_t(1) << (qubit % 64);
+
+    // a stabilizer anticommuting with Z makes the outcome random
+    size_t pivot = 2 * n;
+    for (size_t row = n; row < 2 * n; ++row)
+    {
+        if (xRow(row)[word] & mask)
+        {
+            pivot = row;
+            break;
+        }
+    }
+
+    random = pivot < 2 * n;
+    if (random)
+    {
+        for (size_t row = 0; row < 2 * n; ++row)
+        {
+            if (row != pivot && (xRow(row)[word] & mask))
+                rowsum(row, pivot);
+        }
+        rowcopy(pivot - n, pivot);
+        rowclear(pivot);
+        zRow(pivot)[word] |= mask;
+        phases[pivot] = static_cast<uint8_t>(outcome < 0 ? nextBit() : outcome);
+        return phases[pivot];
+    }
+
+    // deterministic outcome, accumulated in the scratch row
+    const size_t scratch = 2 * n;
+    rowclear(scratch);
+    for (size_t row = 0; row < n; ++row)
+    {
+        if (xRow(row)[word] & mask)
+            rowsum(scratch, row + n);
+    }
+    return phases[scratch];
+}
+
+void StabilizerSimulator::reset(int qubit)
+{
+    if (measure(qubit) == 1)
+        applyX(qubit);
+}
+
+void StabilizerSimulator::run(const Circuit &circuit, std::vector<int> &cbits)
+{
+    ClassicalState classical(circuit);
+    execute(circuit, classical, true);
+    classical.toBits(cbits);
+}
+
+void StabilizerSimulator::run(const Circuit &circuit, ClassicalState &classical)
+{
+    execute(circuit, classical, true);
+}
+
+void StabilizerSimulator::evolve(const Circuit &circuit)
+{
+    ClassicalState classical(circuit);
+    execute(circuit, classical, false);
+}
+
+void StabilizerSimulator::execute(const Circuit &circuit, ClassicalState &classical, bool measureBits)
+{
+    if (circuit.numQubits != numQubits)
+        throw std::runtime_error("Circuit does not match the number of simulated qubits");
+
+    initialize();
+    classical.clear();
+
+    for (const auto &instruction : circuit.instructions)
+    {
+        if (instruction.condition >= 0 && !classical.test(circuit.conditions[instruction.condition]))
+            continue;
+
+        switch (instruction.op)
+        {
+        case Instruction::U:
+            applyU(instruction.qubits[0], instruction.params[0], instruction.params[1], instruction.params[2]);
+            break;
+        case Instruction::CX:
+            applyCX(instruction.qubits[0], instruction.qubits[1]);
+            break;
+        case Instruction::MEASURE:
+            if (measureBits)
+                classical.set(instruction.cbit, measure(instruction.qubits[0]));
+            break;
+        case Instruction::RESET:
+            reset(instruction.qubits[0]);
+            break;
+        case Instruction::BARRIER:
+            break;
+        }
+    }
+}
+
+// SplitMix64, one bit per random measurement
+int StabilizerSimulator::nextBit()
+{
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<int>((z ^ (z >> 31)) >> 63);
+}
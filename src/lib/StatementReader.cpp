@@ -0,0 +1,77 @@
+#include <cctype>
+#include <stdexcept>
+#include "StatementReader.h"
+
+using namespace qasmcpp;
+
+StatementReader::StatementReader(std::istream &input) : input(input) {}
+
+bool StatementReader::next(std::string &statement)
+{
+    typedef std::char_traits<char> traits;
+    std::streambuf *buffer = input.rdbuf();
+
+    statement.clear();
+    bool started = false;
+    bool inString = false;
+    int depth = 0;
+
+    for (int c = buffer->sbumpc(); c != traits::eof(); c = buffer->sbumpc())
+    {
+        if (c == '\n')
+            currentLine++;
+
+        if (inString)
+        {
+            statement += static_cast<char>(c);
+            if (c == '"')
+                inString = false;
+            continue;
+        }
+
+        // "//" and "#" comments run to the end of the line
+        if (c == '#' || (c == '/' && buffer->sgetc() == '/'))
+        {
+            while (c != traits::eof() && c != '\n')
+                c = buffer->sbumpc();
+            if (c == '\n')
+                currentLine++;
+            if (started)
+                statement += ' ';
+            continue;
+        }
+
+        if (!started)
+        {
+            if (std::isspace(c))
+                continue;
+            started = true;
+            line = currentLine;
+        }
+
+        statement += static_cast<char>(c);
+        if (c == '"')
+        {
+            inString = true;
+        }
+        else if (c == '{')
+        {
+            depth++;
+        }
+        else if (c == '}')
+        {
+            if (--depth < 0)
+                throw std::runtime_error("Unmatched '}' at line " + std::to_string(currentLine));
+            if (depth == 0)
+                return true;
+        }
+        else if (c == ';' && depth == 0)
+        {
+            return true;
+        }
+    }
+
+    if (started)
+        throw std::runtime_error("Unterminated statement at line " + std::to_string(line));
+    return false;
+}
@@ -0,0 +1,100 @@
+#include "Stats.h"
+
+using namespace qasmcpp;
+
+void ParseStats::reset() {
+    *this = ParseStats();
+}
+
+void ParseStats::print(std::ostream& out) const {
+    out << "Parse statistics:" << std::endl;
+    out << "  lex time         : " << lexTime << " ms" << std::endl;
+    out << "  parse time       : " << parseTime << " ms" << std::endl;
+    out << "  visit time       : " << visitTime << " ms" << std::endl;
+    out << "  include time     : " << includeTime << " ms" << std::endl;
+    out << "  total time       : " << totalTime << " ms" << std::endl;
+    out << "  bytes read       : " << bytesRead << std::endl;
+    out << "  tokens           : " << tokens << std::endl;
+    out << "  parse tree nodes : " << parseTreeNodes << std::endl;
+    out << "  AST nodes        : " << astNodes << std::endl;
+    out << "  include files    : " << includeFiles << std::endl;
+    out << "  predictions      : " << predictions << std::endl;
+    out << "  LL fallbacks     : " << llFallbacks << std::endl;
+    out << "  DFA states       : " << dfaStates << std::endl;
+    if (alloc::hooksInstalled()) {
+        out << "  lex allocations  : " << lexAllocations.allocations << " (" << lexAllocations.bytes << " bytes)" << std::endl;
+        out << "  parse allocations: " << parseAllocations.allocations << " (" << parseAllocations.bytes << " bytes)" << std::endl;
+        out << "  visit allocations: " << visitAllocations.allocations << " (" << visitAllocations.bytes << " bytes)" << std::endl;
+    }
+}
+
+void ParseStats::printJson(std::ostream& out) const {
+    out << "{"
+        << "\"lexTimeMs\":" << lexTime << ","
+        << "\"parseTimeMs\":" << parseTime << ","
+        << "\"visitTimeMs\":" << visitTime << ","
+        << "\"includeTimeMs\":" << includeTime << ","
+        << "\"totalTimeMs\":" << totalTime << ","
+        << "\"bytesRead\":" << bytesRead << ","
+        << "\"tokens\":" << tokens << ","
+        << "\"parseTreeNodes\":" << parseTreeNodes << ","
+        << "\"astNodes\":" << astNodes << ","
+        << "\"includeFiles\":" << includeFiles << ","
+        << "\"predictions\":" << predictions << ","
+        << "\"llFallbacks\":" << llFallbacks << ","
+        << "\"dfaStates\":" << dfaStates;
+    if (alloc::hooksInstalled()) {
+        out << ",\"lexAllocations\":" << lexAllocations.allocations
+            << ",\"parseAllocations\":" << parseAllocations.allocations
+            << ",\"visitAllocations\":" << visitAllocations.allocations;
+    }
+    out << "}" << std::endl;
+}
+
+void ExecStats::print(std::ostream& out) const {
+    out << "Simulation statistics:" << std::endl;
+    out << "  simulate time    : " << simulateTime << " ms" << std::endl;
+    out << "  sample time      : " << sampleTime << " ms" << std::endl;
+    out << "  layers           : " << layers << std::endl;
+    out << "  sweeps           : " << sweeps << std::endl;
+    out << "  blocked gates    : " << blockedGates << std::endl;
+    out << "  relabeled qubits : " << relabeledQubits << std::endl;
+    out << "  high gates       : " << highGatesBefore << " -> " << highGatesAfter << std::endl;
+    out << "  stabilizer       : " << (stabilizer ? "yes" : "no") << std::endl;
+    out << "  noise events     : " << noiseEvents << std::endl;
+}
+
+void ExecStats::printJson(std::ostream& out) const {
+    out << "{"
+        << "\"simulateTimeMs\":" << simulateTime << ","
+        << "\"sampleTimeMs\":" << sampleTime << ","
+        << "\"layers\":" << layers << ","
+        << "\"sweeps\":" << sweeps << ","
+        << "\"blockedGates\":" << blockedGates << ","
+        << "\"relabeledQubits\":" << relabeledQubits << ","
+        << "\"highGatesBefore\":" << highGatesBefore << ","
+        << "\"highGatesAfter\":" << highGatesAfter << ","
+        << "\"stabilizer\":" << (stabilizer ? "true" : "false") << ","
+        << "\"noiseEvents\":" << noiseEvents
+        << "}" << std::endl;
+}
+
+void TranspileStats::print(std::ostream& out) const {
+    out << "Transpile statistics:" << std::endl;
+    out << "  transpile time   : " << transpileTime << " ms" << std::endl;
+    out << "  gates            : " << inputGates << " -> " << outputGates << std::endl;
+    out << "  fused runs       : " << fusedRuns << std::endl;
+    out << "  decompositions   : " << decompositions << std::endl;
+    out << "  blocks           : " << blocks << std::endl;
+}
+
+void TranspileStats::printJson(std::ostream& out) const {
+    out << "{"
+        << "\"transpileTimeMs\":" << transpileTime << ","
+        << "\"inputGates\":" << inputGates << ","
+        << "\"outputGates\":" << outputGates << ","
+        << "\"fusedRuns\":" << fusedRuns << ","
+        << "\"decompositions\":" << decompositions << ","
+        << "\"blocks\":" << blocks
+        << "}" << std::endl;
+}
@@ -0,0 +1,496 @@
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "StdLib.h"
+#include "AST.h"
+#include "Expr.h"
+
+using namespace qasmcpp;
+
+namespace {
+
+    // Gate table of qelib1.inc, in library order
+    const stdlib::BuiltinGate qelib1GateTable[] = {
+        {"u3", "theta,phi,lambda", "q", 0, 1},
+        {"u2", "phi,lambda", "q", 1, 2},
+        {"u1", "lambda", "q", 2, 3},
+        {"cx", "", "c,t", 3, 4},
+        {"id", "", "a", 4, 5},
+        {"u0", "gamma", "q", 5, 6},
+        {"x", "", "a", 6, 7},
+        {"y", "", "a", 7, 8},
+        {"z", "", "a", 8, 9},
+        {"h", "", "a", 9, 10},
+        {"s", "", "a", 10, 11},
+        {"sdg", "", "a", 11, 12},
+        {"t", "", "a", 12, 13},
+        {"tdg", "", "a", 13, 14},
+        {"rx", "theta", "a", 14, 15},
+        {"ry", "theta", "a", 15, 16},
+        {"rz", "phi", "a", 16, 17},
+        {"cz", "", "a,b", 17, 20},
+        {"cy", "", "a,b", 20, 23},
+        {"swap", "", "a,b", 23, 26},
+        {"ch", "", "a,b", 26, 37},
+        {"ccx", "", "a,b,c", 37, 52},
+        {"cswap", "", "a,b,c", 52, 55},
+        {"crx", "lambda", "a,b", 55, 60},
+        {"cry", "lambda", "a,b", 60, 64},
+        {"crz", "lambda", "a,b", 64, 68},
+        {"cu1", "lambda", "a,b", 68, 73},
+        {"cu3", "theta,phi,lambda", "c,t", 73, 79},
+        {"rxx", "theta", "a,b", 79, 86},
+        {"rzz", "theta", "a,b", 86, 89},
+        {"rccx", "", "a,b,c", 89, 98},
+        {"rc3x", "", "a,b,c,d", 98, 116},
+        {"c3x", "", "a,b,c,d", 116, 143},
+        {"c3sqrtx", "", "a,b,c,d", 143, 170},
+        {"c4x", "", "a,b,c,d,e", 170, 179},
+    };
+
+    // Body statements of the gates above, as written in qelib1.inc
+    const stdlib::BuiltinOp qelib1OpTable[] = {
+        // u3
+        {"U", "theta,phi,lambda", {0, -1, -1, -1}},
+        // u2
+        {"U", "pi/2,phi,lambda", {0, -1, -1, -1}},
+        // u1
+        {"U", "0,0,lambda", {0, -1, -1, -1}},
+        // cx
+        {"CX", "", {0, 1, -1, -1}},
+        // id
+        {"U", "0,0,0", {0, -1, -1, -1}},
+        // u0
+        {"U", "0,0,0", {0, -1, -1, -1}},
+        // x
+        {"u3", "pi,0,pi", {0, -1, -1, -1}},
+        // y
+        {"u3", "pi,pi/2,pi/2", {0, -1, -1, -1}},
+        // z
+        {"u1", "pi", {0, -1, -1, -1}},
+        // h
+        {"u2", "0,pi", {0, -1, -1, -1}},
+        // s
+        {"u1", "pi/2", {0, -1, -1, -1}},
+        // sdg
+        {"u1", "-pi/2", {0, -1, -1, -1}},
+        // t
+        {"u1", "pi/4", {0, -1, -1, -1}},
+        // tdg
+        {"u1", "-pi/4", {0, -1, -1, -1}},
+        // rx
+        {"u3", "theta,-pi/2,pi/2", {0, -1, -1, -1}},
+        // ry
+        {"u3", "theta,0,0", {0, -1, -1, -1}},
+        // rz
+        {"u1", "phi", {0, -1, -1, -1}},
+        // cz
+        {"h", "", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {1, -1, -1, -1}},
+        // cy
+        {"sdg", "", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"s", "", {1, -1, -1, -1}},
+        // swap
+        {"cx", "", {0, 1, -1, -1}},
+        {"cx", "", {1, 0, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        // ch
+        {"h", "", {1, -1, -1, -1}},
+        {"sdg", "", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {1, -1, -1, -1}},
+        {"t", "", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"t", "", {1, -1, -1, -1}},
+        {"h", "", {1, -1, -1, -1}},
+        {"s", "", {1, -1, -1, -1}},
+        {"x", "", {1, -1, -1, -1}},
+        {"s", "", {0, -1, -1, -1}},
+        // ccx
+        {"h", "", {2, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"tdg", "", {2, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"t", "", {2, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"tdg", "", {2, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"t", "", {1, -1, -1, -1}},
+        {"t", "", {2, -1, -1, -1}},
+        {"h", "", {2, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"t", "", {0, -1, -1, -1}},
+        {"tdg", "", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        // cswap
+        {"cx", "", {2, 1, -1, -1}},
+        {"ccx", "", {0, 1, 2, -1}},
+        {"cx", "", {2, 1, -1, -1}},
+        // crx
+        {"u1", "pi/2", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u3", "-lambda/2,0,0", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u3", "lambda/2,-pi/2,0", {1, -1, -1, -1}},
+        // cry
+        {"u3", "lambda/2,0,0", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u3", "-lambda/2,0,0", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        // crz
+        {"u1", "lambda/2", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u1", "-lambda/2", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        // cu1
+        {"u1", "lambda/2", {0, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u1", "-lambda/2", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u1", "lambda/2", {1, -1, -1, -1}},
+        // cu3
+        {"u1", "(lambda+phi)/2", {0, -1, -1, -1}},
+        {"u1", "(lambda-phi)/2", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u3", "-theta/2,0,-(phi+lambda)/2", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u3", "theta/2,phi,0", {1, -1, -1, -1}},
+        // rxx
+        {"u3", "pi/2,theta,0", {0, -1, -1, -1}},
+        {"h", "", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"u1", "-theta", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {1, -1, -1, -1}},
+        {"u2", "-pi,pi-theta", {0, -1, -1, -1}},
+        // rzz
+        {"cx", "", {0, 1, -1, -1}},
+        {"u1", "theta", {1, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        // rccx
+        {"u2", "0,pi", {2, -1, -1, -1}},
+        {"u1", "pi/4", {2, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"u1", "-pi/4", {2, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"u1", "pi/4", {2, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"u1", "-pi/4", {2, -1, -1, -1}},
+        {"u2", "0,pi", {2, -1, -1, -1}},
+        // rc3x
+        {"u2", "0,pi", {3, -1, -1, -1}},
+        {"u1", "pi/4", {3, -1, -1, -1}},
+        {"cx", "", {2, 3, -1, -1}},
+        {"u1", "-pi/4", {3, -1, -1, -1}},
+        {"u2", "0,pi", {3, -1, -1, -1}},
+        {"cx", "", {0, 3, -1, -1}},
+        {"u1", "pi/4", {3, -1, -1, -1}},
+        {"cx", "", {1, 3, -1, -1}},
+        {"u1", "-pi/4", {3, -1, -1, -1}},
+        {"cx", "", {0, 3, -1, -1}},
+        {"u1", "pi/4", {3, -1, -1, -1}},
+        {"cx", "", {1, 3, -1, -1}},
+        {"u1", "-pi/4", {3, -1, -1, -1}},
+        {"u2", "0,pi", {3, -1, -1, -1}},
+        {"u1", "pi/4", {3, -1, -1, -1}},
+        {"cx", "", {2, 3, -1, -1}},
+        {"u1", "-pi/4", {3, -1, -1, -1}},
+        {"u2", "0,pi", {3, -1, -1, -1}},
+        // c3x
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/4", {0, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/4", {1, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/4", {1, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/4", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/4", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/4", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/4", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        // c3sqrtx
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/8", {0, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/8", {1, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 1, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/8", {1, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/8", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/8", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {1, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/8", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cx", "", {0, 2, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "-pi/8", {2, 3, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        // c4x
+        {"h", "", {4, -1, -1, -1}},
+        {"cu1", "-pi/2", {3, 4, -1, -1}},
+        {"h", "", {4, -1, -1, -1}},
+        {"c3x", "", {0, 1, 2, 3}},
+        {"h", "", {3, -1, -1, -1}},
+        {"cu1", "pi/4", {3, 4, -1, -1}},
+        {"h", "", {3, -1, -1, -1}},
+        {"c3x", "", {0, 1, 2, 3}},
+        {"c3sqrtx", "", {0, 1, 2, 4}},
+    };
+
+    // Reads the parameter expressions of the tables into ExprNodes, with the
+    // same node types the visitor builds from the grammar's exp rule
+    class ExprReader
+    {
+    public:
+        explicit ExprReader(const char *text) : pos(text) {}
+
+        std::shared_ptr<ExprNode> readExp()
+        {
+            skipSpaces();
+            if (*pos == '-')
+            {
+                pos++;
+                return std::make_shared<UnaryExprNode>(ExprNode::UnaryOpType::NAGATIVE, readExp());
+            }
+
+            std::shared_ptr<ExprNode> left = readPrimary();
+            for (;;)
+            {
+                skipSpaces();
+                int op;
+                switch (*pos)
+                {
+                case '+': op = ExprNode::ArithOpType::PLUS; break;
+                case '-': op = ExprNode::ArithOpType::MINUS; break;
+                case '*': op = ExprNode::ArithOpType::TIMES; break;
+                case '/': op = ExprNode::ArithOpType::DIVIDE; break;
+                case '^': op = ExprNode::ArithOpType::POWER; break;
+                default: return left;
+                }
+                pos++;
+                skipSpaces();
+                auto right = *pos == '-' ? readExp() : readPrimary();
+                left = std::make_shared<BinaryExprNode>(op, left, right);
+            }
+        }
+
+        bool atEnd()
+        {
+            skipSpaces();
+            return *pos == '\0';
+        }
+
+    private:
+        std::shared_ptr<ExprNode> readPrimary()
+        {
+            skipSpaces();
+            if (*pos == '(')
+            {
+                pos++;
+                auto exp = readExp();
+                expect(')');
+                return exp;
+            }
+            if (*pos >= '0' && *pos <= '9')
+            {
+                char *end;
+                double value = std::strtod(pos, &end);
+                bool isReal = std::memchr(pos, '.', end - pos) != nullptr;
+                pos = end;
+                if (isReal)
+                    return std::make_shared<RealLiteralNode>(value);
+                return std::make_shared<NNIntegerLiteralNode>(static_cast<int>(value));
+            }
+
+            const char *begin = pos;
+            while ((*pos >= 'a' && *pos <= 'z') || (*pos >= 'A' && *pos <= 'Z') || (*pos >= '0' && *pos <= '9') || *pos == '_')
+                pos++;
+            std::string id(begin, pos);
+            if (id.empty())
+                throw std::runtime_error(std::string("Invalid builtin expression: ") + begin);
+
+            if (id == "pi")
+            {
+                const double pi = 3.1415926535897932384626433;
+                return std::make_shared<RealLiteralNode>(pi);
+            }
+
+            static const char *functions[] = {"sin", "cos", "tan", "exp", "ln", "sqrt"};
+            for (int op = ExprNode::UnaryOpType::SIN; op <= ExprNode::UnaryOpType::SQRT; ++op)
+            {
+                if (id == functions[op])
+                {
+                    expect('(');
+                    auto exp = readExp();
+                    expect(')');
+                    return std::make_shared<UnaryExprNode>(op, exp);
+                }
+            }
+            return std::make_shared<IdentifierNode>(id);
+        }
+
+        void expect(char c)
+        {
+            skipSpaces();
+            if (*pos != c)
+                throw std::runtime_error(std::string("Invalid builtin expression, expected ") + c);
+            pos++;
+        }
+
+        void skipSpaces()
+        {
+            while (*pos == ' ')
+                pos++;
+        }
+
+        const char *pos;
+    };
+
+    // Splits a comma separated list of the tables
+    std::vector<std::string> splitList(const char *text)
+    {
+        std::vector<std::string> items;
+        std::string item;
+        int depth = 0;
+        for (const char *c = text; *c != '\0'; ++c)
+        {
+            if (*c == ',' && depth == 0)
+            {
+                items.push_back(item);
+                item.clear();
+                continue;
+            }
+            if (*c == '(')
+                depth++;
+            else if (*c == ')')
+                depth--;
+            item += *c;
+        }
+        if (!item.empty())
+            items.push_back(item);
+        return items;
+    }
+
+    std::shared_ptr<ExprNode> readExpression(const std::string &text)
+    {
+        // the library is built once, its expressions stay pooled for the process
+        static ExprPool pool;
+
+        ExprReader reader(text.c_str());
+        auto exp = reader.readExp();
+        if (!reader.atEnd())
+            throw std::runtime_error("Invalid builtin expression: " + text);
+        return pool.intern(exp);
+    }
+
+    // Builds the body statement nodes of one builtin gate
+    std::shared_ptr<QASMNode> buildOp(const stdlib::BuiltinOp &op, const std::vector<std::string> &qubits)
+    {
+        std::vector<std::shared_ptr<ExprNode>> params;
+        for (const auto &param : splitList(op.params))
+        {
+            params.push_back(readExpression(param));
+        }
+
+        std::vector<std::shared_ptr<Bit>> args;
+        for (int slot : op.qubits)
+        {
+            if (slot < 0)
+                break;
+            args.push_back(std::make_shared<Bit>(qubits[slot], -1, BitType::Unknown));
+        }
+
+        if (std::strcmp(op.gate, "U") == 0)
+        {
+            return std::make_shared<UStmtNode>(*args[0], params[0], params[1], params[2]);
+        }
+        if (std::strcmp(op.gate, "CX") == 0)
+        {
+            return std::make_shared<CXStmtNode>(*args[0], *args[1]);
+        }
+        return std::make_shared<GateStmtNode>(op.gate, params, args);
+    }
+
+    std::vector<std::shared_ptr<Gate>> buildQelib1()
+    {
+        std::vector<std::shared_ptr<Gate>> gates;
+        for (const auto &entry : qelib1GateTable)
+        {
+            auto gate = std::make_shared<Gate>();
+            gate->name = entry.name;
+            gate->params = splitList(entry.params);
+
+            std::vector<std::string> qubits = splitList(entry.qubits);
+            for (const auto &qubit : qubits)
+            {
+                gate->qubits.push_back(std::make_shared<Bit>(qubit, -1, BitType::Qubit));
+            }
+            for (int i = entry.bodyBegin; i < entry.bodyEnd; ++i)
+            {
+                gate->body.push_back(buildOp(qelib1OpTable[i], qubits));
+            }
+            gates.push_back(gate);
+        }
+        return gates;
+    }
+
+} // namespace
+
+bool stdlib::isQelib1(const std::string& filename) {
+    const std::string base = "qelib1.inc";
+    if (filename.size() < base.size() || filename.compare(filename.size() - base.size(), base.size(), base) != 0) {
+        return false;
+    }
+    return filename.size() == base.size() || filename[filename.size() - base.size() - 1] == '/';
+}
+
+const stdlib::BuiltinGate *stdlib::qelib1Gates(size_t& count) {
+    count = sizeof(qelib1GateTable) / sizeof(qelib1GateTable[0]);
+    return qelib1GateTable;
+}
+
+const stdlib::BuiltinOp *stdlib::qelib1Ops(size_t& count) {
+    count = sizeof(qelib1OpTable) / sizeof(qelib1OpTable[0]);
+    return qelib1OpTable;
+}
+
+const std::vector<std::shared_ptr<Gate>>& stdlib::qelib1Definitions() {
+    // built once per process, the definitions are never modified afterwards
+    static const std::vector<std::shared_ptr<Gate>> definitions = buildQelib1();
+    return definitions;
+}
+
+void stdlib::loadQelib1(SymbolTable& symbolTable) {
+    for (const auto& gate : qelib1Definitions()) {
+        symbolTable.addGateDef(gate->name, gate);
+    }
+}
@@ -0,0 +1,47 @@
+#include <antlr4-runtime.h>
+#include "QASM2Lexer.h"
+#include "QASM2Parser.h"
+#include "AllocCounter.h"
+#include "StreamingParser.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+StreamingParser::StreamingParser(std::istream &input) : reader(input) {}
+
+bool StreamingParser::next(std::shared_ptr<QASMNode> &statement)
+{
+    while (reader.next(text))
+    {
+        ANTLRInputStream input(text);
+        QASM2Lexer lexer(&input);
+        // syntax errors report the line of the statement in the stream
+        lexer.setLine(reader.getLine());
+        CommonTokenStream tokens(&lexer);
+        {
+            PhaseTimer timer(stats ? &stats->lexTime : nullptr);
+            AllocScope allocs(stats ? &stats->lexAllocations : nullptr);
+            tokens.fill();
+        }
+
+        QASM2Parser parser(&tokens);
+        double includeTime = stats ? stats->includeTime : 0;
+        {
+            PhaseTimer timer(stats ? &stats->parseTime : nullptr);
+            AllocScope allocs(stats ? &stats->parseAllocations : nullptr);
+            statement = builder.buildStatement(parser);
+        }
+
+        if (stats)
+        {
+            stats->parseTime -= stats->includeTime - includeTime;
+            stats->bytesRead += text.size();
+            // the EOF that ends each statement is not a token of the source
+            stats->tokens += tokens.size() - 1;
+        }
+
+        if (statement != nullptr)
+            return true;
+    }
+    return false;
+}
@@ -14,19 +14,27 @@ void SymbolTable::addCbitRegister(const std::string& name, int size) {
 
 void SymbolTable::addRegister(const std::string& name, int size, BitType type) {
     // check if the register already exists and show the name and size and type of it
-    if (isQubitRegister(name) || isCbitRegister(name)) {
+    if (!tryAddRegister(name, size, type)) {
         std::string errorMsg = "Register already exists: " + name + " " + std::to_string(size) + " ";
         throw std::runtime_error(errorMsg);
     }
+}
+
+bool SymbolTable::tryAddRegister(const std::string& name, int size, BitType type) {
+    // a register of the base is shadowed, only the own ones conflict
+    if (qubitRegisters.count(name) != 0 || cbitRegisters.count(name) != 0) {
+        return false;
+    }
     if (type == BitType::Qubit) {
         qubitRegisters[name] = std::make_shared<Register>(name, size, BitType::Qubit);
     } else {
         cbitRegisters[name] = std::make_shared<Register>(name, size, BitType::Cbit);
     }
+    return true;
 }
 
 void SymbolTable::addGateDef(const std::string& name, std::shared_ptr<Gate> gate) {
-    if (hasGateDef(name)) {
+    if (gateDefines.count(name) != 0) {
         std::string errorMsg = "Gate definition already exists: " + name;
         throw std::runtime_error(errorMsg);
     }
@@ -35,27 +43,49 @@ void SymbolTable::addGateDef(const std::string& name, std::shared_ptr<Gate> gate
 
 
 std::shared_ptr<Gate> SymbolTable::getGateDef(const std::string& name) {
+    auto gate = findGateDef(name);
+    if (gate == nullptr) {
+        throw std::runtime_error("Gate definition not found");
+    }
+    return gate;
+}
+
+std::shared_ptr<Register> SymbolTable::getQubitRegister(const std::string& name) {
+    auto reg = findQubitRegister(name);
+    if (reg == nullptr) {
+        throw std::runtime_error("Qubit register not found");
+    }
+    return reg;
+}
+
+std::shared_ptr<Register> SymbolTable::getCbitRegister(const std::string& name) {
+    auto reg = findCbitRegister(name);
+    if (reg == nullptr) {
+        throw std::runtime_error("Cbit register not found");
+    }
+    return reg;
+}
+
+std::shared_ptr<Gate> SymbolTable::findGateDef(const std::string& name) const {
     auto it = gateDefines.find(name);
     if (it != gateDefines.end()) {
         return it->second;
-    } else {
-        throw std::runtime_error("Gate definition not found");
     }
+    return base ? base->findGateDef(name) : nullptr;
 }
 
-std::shared_ptr<Register> SymbolTable::getQubitRegister(const std::string& name) {
+std::shared_ptr<Register> SymbolTable::findQubitRegister(const std::string& name) const {
     auto it = qubitRegisters.find(name);
     if (it != qubitRegisters.end()) {
         return it->second;
-    } else {
-        throw std::runtime_error("Qubit register not found");
     }
+    return base ? base->findQubitRegister(name) : nullptr;
 }
-std::shared_ptr<Register> SymbolTable::getCbitRegister(const std::string& name) {
+
+std::shared_ptr<Register> SymbolTable::findCbitRegister(const std::string& name) const {
     auto it = cbitRegisters.find(name);
     if (it != cbitRegisters.end()) {
         return it->second;
-    } else {
-        throw std::runtime_error("Cbit register not found");
     }
+    return base ? base->findCbitRegister(name) : nullptr;
 }
\ No newline at end of file
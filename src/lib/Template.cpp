@@ -0,0 +1,37 @@
+#include "Template.h"
+
+using namespace qasmcpp;
+
+CircuitTemplate::CircuitTemplate(const ProgramNode &program, const SymbolTable &symbolTable, std::vector<std::string> params)
+    : params(std::move(params)), tape(this->params.size())
+{
+    Lowering lowering(symbolTable);
+    circuit = lowering.lowerTemplate(program, this->params, tape, slots);
+    fixedMatrices = circuit.matrices.size();
+}
+
+Circuit CircuitTemplate::bind(const std::vector<double> &values) const
+{
+    Circuit bound = circuit;
+    rebind(values, bound);
+    return bound;
+}
+
+void CircuitTemplate::rebind(const std::vector<double> &values, Circuit &bound) const
+{
+    std::vector<double> nodes;
+    tape.evaluate(values, nodes);
+
+    // the matrices of the previous binding are dropped, the fixed ones keep their ids
+    bound.matrices.truncate(fixedMatrices);
+    for (const ParamSlot &slot : slots)
+    {
+        Instruction &instruction = bound.instructions[slot.instruction];
+        for (int i = 0; i < 3; ++i)
+        {
+            if (slot.angles[i] >= 0)
+                instruction.params[i] = nodes[slot.angles[i]];
+        }
+        instruction.matrixId = bound.matrices.intern(instruction.params[0], instruction.params[1], instruction.params[2]);
+    }
+}
@@ -0,0 +1,596 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include "Transpiler.h"
+
+using namespace qasmcpp;
+
+typedef MatrixCache::Matrix Matrix;
+
+// Angles closer than this to a special value take the shorter decomposition
+static const double kTolerance = 1e-9;
+
+// Longest decomposition of a single-qubit unitary, rz sx rz sx rz
+static const int kMaxSequence = 5;
+
+static const Basis::EulerType kNoEuler = static_cast<Basis::EulerType>(-1);
+
+Basis::Basis(const std::vector<std::string> &gates) : euler(kNoEuler), twoQubitGate(-1)
+{
+    std::vector<std::string> sorted(gates);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    bool rz = false, rx = false, ry = false, sx = false, u3 = false;
+    for (const auto &gate : sorted)
+    {
+        name += (name.empty() ? "" : ",") + gate;
+        if (gate == "rz")
+            rz = true;
+        else if (gate == "rx")
+            rx = true;
+        else if (gate == "ry")
+            ry = true;
+        else if (gate == "sx")
+            sx = true;
+        else if (gate == "x")
+            useX = true;
+        else if (gate == "u3" || gate == "U")
+            u3 = true;
+        else if (gate == "cx" || gate == "CX")
+            twoQubitGate = twoQubitGate == -1 ? BasisOp::CX : twoQubitGate;
+        else if (gate == "cz")
+            twoQubitGate = twoQubitGate == -1 ? BasisOp::CZ : twoQubitGate;
+        else
+            throw std::runtime_error("Unsupported basis gate: " + gate);
+    }
+
+    // the most specific single-qubit set wins, the others stay unused
+    if (u3)
+        euler = EULER_U3;
+    else if (rz && sx)
+        euler = EULER_ZSX;
+    else if (rz && ry)
+        euler = EULER_ZYZ;
+    else if (rz && rx)
+        euler = EULER_ZXZ;
+
+    if (euler == kNoEuler || twoQubitGate == -1)
+        throw std::runtime_error("Basis is not universal: " + name);
+    useX = useX && euler == EULER_ZSX;
+}
+
+std::shared_ptr<const Basis> Basis::get(const std::vector<std::string> &gates)
+{
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const Basis>> bases;
+
+    std::shared_ptr<const Basis> basis(new Basis(gates));
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = bases.find(basis->name);
+    if (it != bases.end())
+        return it->second;
+    bases.emplace(basis->name, basis);
+    return basis;
+}
+
+std::vector<std::string> Basis::parseList(const std::string &list)
+{
+    std::vector<std::string> gates;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        if (end > start)
+            gates.push_back(list.substr(start, end - start));
+        start = end + 1;
+    }
+    return gates;
+}
+
+namespace
+{
+
+    // The basis gates of one single-qubit unitary, with the qubit left to fill in
+    struct Sequence
+    {
+        int size = -1; // -1 until decomposed
+        BasisOp ops[kMaxSequence];
+    };
+
+    double wrapAngle(double angle)
+    {
+        angle = std::remainder(angle, 2 * M_PI);
+        return angle <= -M_PI ? angle + 2 * M_PI : angle;
+    }
+
+    bool isZero(double angle)
+    {
+        return std::abs(wrapAngle(angle)) < kTolerance;
+    }
+
+    Matrix multiply(const Matrix &a, const Matrix &b)
+    {
+        return Matrix{{
+            a[0] * b[0] + a[1] * b[2],
+            a[0] * b[1] + a[1] * b[3],
+            a[2] * b[0] + a[3] * b[2],
+            a[2] * b[1] + a[3] * b[3],
+        }};
+    }
+
+    void push(Sequence &sequence, int gate, double angle)
+    {
+        BasisOp &op = sequence.ops[sequence.size++];
+        op.gate = gate;
+        op.qubits[0] = op.qubits[1] = -1;
+        op.cbit = -1;
+        op.params[0] = angle;
+        op.params[1] = op.params[2] = 0;
+    }
+
+    void pushRotation(Sequence &sequence, int gate, double angle)
+    {
+        if (!isZero(angle))
+            push(sequence, gate, wrapAngle(angle));
+    }
+
+    // Decomposes a unitary into the Euler rotations of a basis, up to a global phase
+    void decompose(const Matrix &m, const Basis &basis, Sequence &sequence)
+    {
+        // m = e^(i alpha) U(theta, phi, lambda)
+        double c = std::abs(m[0]);
+        double s = std::abs(m[2]);
+        double theta = 2 * std::atan2(s, c);
+        double phi, lambda;
+        if (s < kTolerance)
+        {
+            phi = 0;
+            lambda = std::arg(m[3]) - std::arg(m[0]);
+        }
+        else if (c < kTolerance)
+        {
+            phi = std::arg(m[2]) - std::arg(-m[1]);
+            lambda = 0;
+        }
+        else
+        {
+            phi = std::arg(m[2]) - std::arg(m[0]);
+            lambda = std::arg(-m[1]) - std::arg(m[0]);
+        }
+
+        sequence.size = 0;
+        bool diagonal = theta < kTolerance;
+        switch (basis.getEuler())
+        {
+        case Basis::EULER_U3:
+            if (diagonal && isZero(phi + lambda))
+                break;
+            push(sequence, BasisOp::U3, theta);
+            sequence.ops[0].params[1] = wrapAngle(phi);
+            sequence.ops[0].params[2] = wrapAngle(lambda);
+            break;
+        case Basis::EULER_ZSX:
+            if (diagonal)
+            {
+                pushRotation(sequence, BasisOp::RZ, phi + lambda);
+            }
+            else if (std::abs(theta - M_PI / 2) < kTolerance)
+            {
+                pushRotation(sequence, BasisOp::RZ, lambda - M_PI / 2);
+                push(sequence, BasisOp::SX, 0);
+                pushRotation(sequence, BasisOp::RZ, phi + M_PI / 2);
+            }
+            else if (basis.hasX() && std::abs(theta - M_PI) < kTolerance)
+            {
+                pushRotation(sequence, BasisOp::RZ, lambda - phi + M_PI);
+                push(sequence, BasisOp::X, 0);
+            }
+            else
+            {
+                pushRotation(sequence, BasisOp::RZ, lambda);
+                push(sequence, BasisOp::SX, 0);
+                pushRotation(sequence, BasisOp::RZ, theta + M_PI);
+                push(sequence, BasisOp::SX, 0);
+                pushRotation(sequence, BasisOp::RZ, phi + M_PI);
+            }
+            break;
+        case Basis::EULER_ZYZ:
+            pushRotation(sequence, BasisOp::RZ, diagonal ? phi + lambda : lambda);
+            if (!diagonal)
+            {
+                pushRotation(sequence, BasisOp::RY, theta);
+                pushRotation(sequence, BasisOp::RZ, phi);
+            }
+            break;
+        case Basis::EULER_ZXZ:
+            pushRotation(sequence, BasisOp::RZ, diagonal ? phi + lambda : lambda - M_PI / 2);
+            if (!diagonal)
+            {
+                pushRotation(sequence, BasisOp::RX, theta);
+                pushRotation(sequence, BasisOp::RZ, phi + M_PI / 2);
+            }
+            break;
+        }
+    }
+
+    /**
+     * Transpiles the instructions of one block of qubits. Each qubit keeps
+     * the product of its single-qubit gates since the last operation that
+     * involved another qubit or a non-unitary operation, which is emitted
+     * as one decomposition when the run ends.
+     */
+    class BlockTranspiler
+    {
+    public:
+        BlockTranspiler(const Circuit &circuit, const Basis &basis, const std::vector<int> &declared, std::vector<BasisOp> &ops)
+            : circuit(circuit), basis(basis), declared(declared), ops(ops), runs(circuit.numQubits) {}
+
+        void apply(const Instruction &instruction)
+        {
+            int qubit = declared.empty() ? instruction.qubits[0] : declared[instruction.qubits[0]];
+            switch (instruction.op)
+            {
+            case Instruction::U:
+            {
+                Run &run = runs[qubit];
+                const Matrix &m = circuit.matrices.get(instruction.matrixId);
+                run.matrix = run.gates == 0 ? m : multiply(m, run.matrix);
+                run.matrixId = run.gates == 0 ? instruction.matrixId : -1;
+                run.gates++;
+                stats.inputGates++;
+                break;
+            }
+            case Instruction::CX:
+            {
+                int target = declared.empty() ? instruction.qubits[1] : declared[instruction.qubits[1]];
+                flush(qubit);
+                if (basis.getTwoQubitGate() == BasisOp::CZ)
+                {
+                    // cx = h cz h on the target, the h merge with the gates around them
+                    multiplyInto(target, hadamard());
+                    flush(target);
+                    emit(BasisOp::CZ, qubit, target);
+                    multiplyInto(target, hadamard());
+                }
+                else
+                {
+                    flush(target);
+                    emit(BasisOp::CX, qubit, target);
+                }
+                stats.inputGates++;
+                break;
+            }
+            case Instruction::MEASURE:
+                flush(qubit);
+                emit(BasisOp::MEASURE, qubit, -1, instruction.cbit);
+                break;
+            case Instruction::RESET:
+                flush(qubit);
+                emit(BasisOp::RESET, qubit);
+                break;
+            case Instruction::BARRIER:
+            {
+                if (ops.empty() || ops.back().gate != BasisOp::BARRIER || ops.back().barrier != instruction.barrier)
+                    barrierStart = ops.size();
+                // the gates flushed here precede the whole barrier, not only this qubit of it
+                size_t flushed = ops.size();
+                flush(qubit);
+                std::rotate(ops.begin() + barrierStart, ops.begin() + flushed, ops.end());
+                barrierStart += ops.size() - flushed;
+                emit(BasisOp::BARRIER, qubit);
+                ops.back().barrier = instruction.barrier;
+                break;
+            }
+            }
+        }
+
+        void finish()
+        {
+            for (int qubit = 0; qubit < static_cast<int>(runs.size()); ++qubit)
+            {
+                flush(qubit);
+            }
+        }
+
+        TranspileStats stats;
+
+    private:
+        struct Run
+        {
+            Matrix matrix;
+            int gates = 0;     // single-qubit gates in the run, 0 for identity
+            int matrixId = -1; // matrix of a run of one U, for the table
+        };
+
+        static const Matrix &hadamard()
+        {
+            static const Matrix h = MatrixCache::uMatrix(M_PI / 2, 0, M_PI);
+            return h;
+        }
+
+        void multiplyInto(int qubit, const Matrix &m)
+        {
+            Run &run = runs[qubit];
+            run.matrix = run.gates == 0 ? m : multiply(m, run.matrix);
+            run.matrixId = -1;
+            run.gates++;
+        }
+
+        void flush(int qubit)
+        {
+            Run &run = runs[qubit];
+            if (run.gates == 0)
+                return;
+            if (run.gates > 1)
+                stats.fusedRuns++;
+
+            Sequence fused;
+            const Sequence *sequence = &fused;
+            if (run.matrixId >= 0)
+            {
+                // a single U, decomposed once per distinct matrix of the circuit
+                if (table.size() <= static_cast<size_t>(run.matrixId))
+                    table.resize(circuit.matrices.size());
+                Sequence &entry = table[run.matrixId];
+                if (entry.size < 0)
+                {
+                    decompose(run.matrix, basis, entry);
+                    stats.decompositions++;
+                }
+                sequence = &entry;
+            }
+            else
+            {
+                decompose(run.matrix, basis, fused);
+                stats.decompositions++;
+            }
+
+            for (int i = 0; i < sequence->size; ++i)
+            {
+                ops.push_back(sequence->ops[i]);
+                ops.back().qubits[0] = qubit;
+            }
+            stats.outputGates += sequence->size;
+            run.gates = 0;
+        }
+
+        void emit(int gate, int qubit, int target = -1, int cbit = -1)
+        {
+            BasisOp op{gate, {qubit, target}, cbit, {0, 0, 0}};
+            ops.push_back(op);
+            if (gate == BasisOp::CX || gate == BasisOp::CZ)
+                stats.outputGates++;
+        }
+
+        const Circuit &circuit;
+        const Basis &basis;
+        const std::vector<int> &declared;
+        std::vector<BasisOp> &ops;
+        std::vector<Run> runs;
+        std::vector<Sequence> table;
+        size_t barrierStart = 0; // first BARRIER operation of the barrier statement at the end of ops
+    };
+
+    int findRoot(std::vector<int> &parents, int qubit)
+    {
+        while (parents[qubit] != qubit)
+        {
+            parents[qubit] = parents[parents[qubit]];
+            qubit = parents[qubit];
+        }
+        return qubit;
+    }
+
+} // namespace
+
+TranspiledCircuit qasmcpp::transpile(const Circuit &circuit, std::shared_ptr<const Basis> basis, TranspileStats *stats)
+{
+    PhaseTimer timer(stats ? &stats->transpileTime : nullptr);
+
+    // a condition would tie the blocks of the measured and the conditioned qubits
+    if (!circuit.conditions.empty())
+        throw std::runtime_error("Conditioned instructions are not supported by the transpiler");
+
+    TranspiledCircuit result;
+    result.numQubits = circuit.numQubits;
+    result.numCbits = circuit.numCbits;
+    result.qregs = circuit.qregs;
+    result.cregs = circuit.cregs;
+    result.basis = basis;
+
+    // ops use declared qubits, undo a relabeling
+    std::vector<int> declared;
+    if (!circuit.physicalQubits.empty())
+    {
+        declared.resize(circuit.physicalQubits.size());
+        for (size_t i = 0; i < circuit.physicalQubits.size(); ++i)
+        {
+            declared[circuit.physicalQubits[i]] = static_cast<int>(i);
+        }
+    }
+
+    // qubits joined by a CX, by one barrier statement or by measuring into the same cbit belong to the same block
+    std::vector<int> parents(circuit.numQubits);
+    std::iota(parents.begin(), parents.end(), 0);
+    std::vector<int> measuredBy(circuit.numCbits, -1);
+    const auto &instructions = circuit.instructions;
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        const Instruction &instruction = instructions[i];
+        int other = -1;
+        if (instruction.op == Instruction::CX)
+        {
+            other = instruction.qubits[1];
+        }
+        else if (instruction.op == Instruction::BARRIER && i > 0 && instructions[i - 1].op == Instruction::BARRIER &&
+                 instructions[i - 1].barrier == instruction.barrier)
+        {
+            other = instructions[i - 1].qubits[0];
+        }
+        else if (instruction.op == Instruction::MEASURE)
+        {
+            other = measuredBy[instruction.cbit];
+            measuredBy[instruction.cbit] = instruction.qubits[0];
+        }
+        if (other >= 0)
+            parents[findRoot(parents, instruction.qubits[0])] = findRoot(parents, other);
+    }
+
+    // blocks are numbered by their first instruction, which fixes the output order
+    std::vector<int> blockOf(circuit.numQubits, -1);
+    std::vector<size_t> offsets(1, 0);
+    for (const Instruction &instruction : instructions)
+    {
+        int &block = blockOf[findRoot(parents, instruction.qubits[0])];
+        if (block < 0)
+        {
+            block = static_cast<int>(offsets.size()) - 1;
+            offsets.push_back(0);
+        }
+        offsets[block + 1]++;
+    }
+    long blocks = static_cast<long>(offsets.size()) - 1;
+
+    std::vector<std::vector<BasisOp>> blockOps(blocks);
+    std::vector<TranspileStats> blockStats(blocks);
+    if (blocks == 1)
+    {
+        // the common case of one connected circuit needs no index lists
+        blockOps[0].reserve(instructions.size());
+        BlockTranspiler transpiler(circuit, *basis, declared, blockOps[0]);
+        for (const Instruction &instruction : instructions)
+        {
+            transpiler.apply(instruction);
+        }
+        transpiler.finish();
+        blockStats[0] = transpiler.stats;
+    }
+    else if (blocks > 1)
+    {
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<size_t> indices(instructions.size());
+        std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < instructions.size(); ++i)
+        {
+            indices[next[blockOf[findRoot(parents, instructions[i].qubits[0])]]++] = i;
+        }
+
+#pragma omp parallel for schedule(dynamic, 1)
+        for (long block = 0; block < blocks; ++block)
+        {
+            blockOps[block].reserve(offsets[block + 1] - offsets[block]);
+            BlockTranspiler transpiler(circuit, *basis, declared, blockOps[block]);
+            for (size_t i = offsets[block]; i < offsets[block + 1]; ++i)
+            {
+                transpiler.apply(instructions[indices[i]]);
+            }
+            transpiler.finish();
+            blockStats[block] = transpiler.stats;
+        }
+    }
+
+    size_t total = 0;
+    for (const auto &ops : blockOps)
+    {
+        total += ops.size();
+    }
+    if (blocks == 1)
+        result.ops = std::move(blockOps[0]);
+    else
+        result.ops.reserve(total);
+    for (long block = 0; block < blocks; ++block)
+    {
+        if (blocks > 1)
+            result.ops.insert(result.ops.end(), blockOps[block].begin(), blockOps[block].end());
+        if (stats)
+        {
+            stats->inputGates += blockStats[block].inputGates;
+            stats->outputGates += blockStats[block].outputGates;
+            stats->fusedRuns += blockStats[block].fusedRuns;
+            stats->decompositions += blockStats[block].decompositions;
+        }
+    }
+    if (stats)
+        stats->blocks += blocks;
+    return result;
+}
+
+void TranspiledCircuit::write(std::ostream &out) const
+{
+    static const char *names[] = {"rz", "rx", "ry", "sx", "x", "u3", "cx", "cz"};
+
+    out << "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n";
+    if (basis && basis->getEuler() == Basis::EULER_ZSX)
+        out << "gate sx a { sdg a; h a; sdg a; }\n";
+    for (const auto &qreg : qregs)
+    {
+        out << "qreg " << qreg.name << "[" << qreg.size << "];\n";
+    }
+    for (const auto &creg : cregs)
+    {
+        out << "creg " << creg.name << "[" << creg.size << "];\n";
+    }
+
+    // register name and index of every global bit
+    auto bitName = [](const std::vector<RegisterLayout> &layouts, int bit) {
+        for (const auto &layout : layouts)
+        {
+            if (bit >= layout.offset && bit < layout.offset + layout.size)
+                return layout.name + "[" + std::to_string(bit - layout.offset) + "]";
+        }
+        throw std::runtime_error("Bit outside of every register: " + std::to_string(bit));
+    };
+    std::vector<std::string> qubitNames(numQubits);
+    for (int i = 0; i < numQubits; ++i)
+    {
+        qubitNames[i] = bitName(qregs, i);
+    }
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision(17);
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        const BasisOp &op = ops[i];
+        switch (op.gate)
+        {
+        case BasisOp::MEASURE:
+            out << "measure " << qubitNames[op.qubits[0]] << " -> " << bitName(cregs, op.cbit) << ";\n";
+            break;
+        case BasisOp::RESET:
+            out << "reset " << qubitNames[op.qubits[0]] << ";\n";
+            break;
+        case BasisOp::BARRIER:
+            // the adjacent operations of one barrier statement
+            out << "barrier " << qubitNames[op.qubits[0]];
+            while (i + 1 < ops.size() && ops[i + 1].gate == BasisOp::BARRIER && ops[i + 1].barrier == op.barrier)
+            {
+                out << "," << qubitNames[ops[++i].qubits[0]];
+            }
+            out << ";\n";
+            break;
+        case BasisOp::CX:
+        case BasisOp::CZ:
+            out << names[op.gate] << " " << qubitNames[op.qubits[0]] << "," << qubitNames[op.qubits[1]] << ";\n";
+            break;
+        case BasisOp::U3:
+            out << "u3(" << op.params[0] << "," << op.params[1] << "," << op.params[2] << ") " << qubitNames[op.qubits[0]] << ";\n";
+            break;
+        case BasisOp::SX:
+        case BasisOp::X:
+            out << names[op.gate] << " " << qubitNames[op.qubits[0]] << ";\n";
+            break;
+        default:
+            out << names[op.gate] << "(" << op.params[0] << ") " << qubitNames[op.qubits[0]] << ";\n";
+            break;
+        }
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
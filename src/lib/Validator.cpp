@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "QASM2Lexer.h"
+#include "StdLib.h"
+#include "Validator.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+// Nested includes deeper than this are reported instead of followed
+static const int kMaxIncludeDepth = 32;
+
+// Largest register size, the symbol table stores sizes as int
+static const unsigned long long kMaxRegisterSize = 0x7fffffff;
+
+namespace
+{
+    // Forwards the errors of the lexer and parser to the sink
+    class SinkErrorListener : public BaseErrorListener
+    {
+    public:
+        SinkErrorListener(DiagnosticSink &sink, const std::string &source) : sink(sink), source(source) {}
+
+        void syntaxError(Recognizer *recognizer, Token *offendingSymbol, size_t line, size_t charPositionInLine,
+                         const std::string &msg, std::exception_ptr e) override
+        {
+            sink.report(DiagCode::SyntaxError, source, line, charPositionInLine + 1, msg);
+        }
+
+    private:
+        DiagnosticSink &sink;
+        const std::string &source;
+    };
+} // namespace
+
+static size_t countNames(const char *list)
+{
+    return *list ? std::count(list, list + std::strlen(list), ',') + 1 : 0;
+}
+
+// Parses a decimal literal, false if it overflows 64 bits or exceeds the limit
+static bool parseInteger(const std::string &text, unsigned long long limit, unsigned long long &value)
+{
+    errno = 0;
+    value = std::strtoull(text.c_str(), nullptr, 10);
+    return errno != ERANGE && value <= limit;
+}
+
+// Checks if the parser recovered from an error inside a subtree
+static bool hasSyntaxError(tree::ParseTree *node)
+{
+    if (dynamic_cast<tree::ErrorNode *>(node))
+        return true;
+    auto ctx = dynamic_cast<ParserRuleContext *>(node);
+    if (ctx && ctx->exception)
+        return true;
+    for (auto child : node->children)
+    {
+        if (hasSyntaxError(child))
+            return true;
+    }
+    return false;
+}
+
+Validator::Validator(DiagnosticSink &sink) : sink(sink) {}
+
+bool Validator::validateFile(const std::string &path)
+{
+    size_t errors = sink.getErrorCount();
+    std::ifstream stream(path);
+    if (!stream.is_open())
+    {
+        sink.report(DiagCode::IncludeNotFound, path, 0, 0, "Could not open file: " + path);
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    registers.clear();
+    gates.clear();
+    includes.clear();
+    validate(buffer.str(), path, 0);
+    return sink.getErrorCount() == errors;
+}
+
+bool Validator::validateString(const std::string &source)
+{
+    size_t errors = sink.getErrorCount();
+    registers.clear();
+    gates.clear();
+    includes.clear();
+    validate(source, "<input>", 0);
+    return sink.getErrorCount() == errors;
+}
+
+void Validator::validate(const std::string &text, const std::string &sourceName, int depth)
+{
+    std::string outer = source;
+    source = sourceName;
+
+    ANTLRInputStream input(text);
+    QASM2Lexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    QASM2Parser parser(&tokens);
+    SinkErrorListener listener(sink, source);
+    lexer.removeErrorListeners();
+    lexer.addErrorListener(&listener);
+    parser.removeErrorListeners();
+    parser.addErrorListener(&listener);
+
+    QASM2Parser::MainContext *tree = parser.main();
+    QASM2Parser::VersionContext *version = tree->version();
+    if (version && !hasSyntaxError(version) && version->ver.compare(0, 2, "2.") != 0)
+        error(DiagCode::UnsupportedVersion, version->getStart(), "Unsupported OPENQASM version: " + version->ver);
+
+    for (auto stmt : tree->statement())
+    {
+        if (!hasSyntaxError(stmt))
+            statement(stmt, depth);
+    }
+    source = outer;
+}
+
+void Validator::statement(QASM2Parser::StatementContext *ctx, int depth)
+{
+    if (ctx->includeDeclStmt())
+        include(ctx->includeDeclStmt(), depth);
+    else if (ctx->regDeclStmt())
+        regDecl(ctx->regDeclStmt());
+    else if (ctx->gateDeclStmt())
+        gateDecl(ctx->gateDeclStmt());
+    else if (ctx->opaqueDeclStmt())
+        opaqueDecl(ctx->opaqueDeclStmt());
+    else if (ctx->qopStmt())
+        qop(ctx->qopStmt());
+    else if (ctx->ifDeclStmt())
+        ifDecl(ctx->ifDeclStmt());
+    else if (ctx->barrierDeclStmt())
+        barrierDecl(ctx->barrierDeclStmt());
+}
+
+void Validator::include(QASM2Parser::IncludeDeclStmtContext *ctx, int depth)
+{
+    std::string filename = ctx->filename.substr(1, ctx->filename.size() - 2);
+
+    // a file included before adds nothing, as in the parser
+    if (!includes.insert(filename).second)
+        return;
+
+    if (useBuiltinStdlib && stdlib::isQelib1(filename))
+    {
+        size_t count;
+        const stdlib::BuiltinGate *table = stdlib::qelib1Gates(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            GateSignature signature{countNames(table[i].params), countNames(table[i].qubits)};
+            if (!gates.insert({table[i].name, signature}).second)
+                error(DiagCode::DuplicateGate, ctx->getStart(), "Duplicate gate: " + std::string(table[i].name));
+        }
+        return;
+    }
+
+    if (depth >= kMaxIncludeDepth)
+    {
+        error(DiagCode::IncludeTooDeep, ctx->getStart(), "Includes nested too deeply: " + filename);
+        return;
+    }
+    std::ifstream stream(filename);
+    if (!stream.is_open())
+    {
+        error(DiagCode::IncludeNotFound, ctx->getStart(), "Could not open file: " + filename);
+        return;
+    }
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    validate(buffer.str(), filename, depth + 1);
+}
+
+void Validator::regDecl(QASM2Parser::RegDeclStmtContext *ctx)
+{
+    std::string name = ctx->ID()->getText();
+    bool quantum = ctx->QREG() != nullptr;
+
+    unsigned long long size;
+    if (!parseInteger(ctx->NNINTEGER()->getText(), kMaxRegisterSize, size) || size == 0)
+    {
+        error(DiagCode::InvalidSize, ctx->NNINTEGER()->getSymbol(), "Invalid size of register " + name + ": " + ctx->NNINTEGER()->getText());
+        size = 1; // keep the name declared to avoid follow-up errors
+    }
+    if (!registers.insert({name, RegisterInfo{size, quantum}}).second)
+        error(DiagCode::DuplicateRegister, ctx->ID()->getSymbol(), "Duplicate register: " + name);
+}
+
+void Validator::gateDecl(QASM2Parser::GateDeclStmtContext *ctx)
+{
+    std::string name = ctx->ID()->getText();
+    std::vector<QASM2Parser::IdListContext *> lists = ctx->idList();
+    std::vector<std::string> params, qubits;
+    if (ctx->hasParams)
+        declareNames(name, lists.front()->ID(), {}, params);
+    declareNames(name, lists.back()->ID(), params, qubits);
+
+    if (name == "U" || name == "CX" || gates.count(name))
+        error(DiagCode::DuplicateGate, ctx->ID()->getSymbol(), "Duplicate gate: " + name);
+
+    for (auto uop : ctx->uop())
+    {
+        gateBodyUop(uop, params, qubits);
+    }
+    // a gate with errors in its body is still declared, so its uses are checked
+    gates.insert({name, GateSignature{params.size(), qubits.size()}});
+}
+
+void Validator::opaqueDecl(QASM2Parser::OpaqueDeclStmtContext *ctx)
+{
+    std::string name = ctx->ID()->getText();
+    std::vector<QASM2Parser::IdListContext *> lists = ctx->idList();
+    std::vector<std::string> params, qubits;
+    if (lists.size() == 2)
+        declareNames(name, lists.front()->ID(), {}, params);
+    declareNames(name, lists.back()->ID(), params, qubits);
+
+    if (name == "U" || name == "CX" || !gates.insert({name, GateSignature{params.size(), qubits.size()}}).second)
+        error(DiagCode::DuplicateGate, ctx->ID()->getSymbol(), "Duplicate gate: " + name);
+}
+
+void Validator::ifDecl(QASM2Parser::IfDeclStmtContext *ctx)
+{
+    std::string name = ctx->ID()->getText();
+    auto it = registers.find(name);
+    if (it == registers.end())
+        error(DiagCode::UndefinedRegister, ctx->ID()->getSymbol(), "Undefined creg: " + name);
+    else if (it->second.quantum)
+        error(DiagCode::WrongRegisterKind, ctx->ID()->getSymbol(), name + " is a qreg, expected a creg");
+    else
+    {
+        // the value must be representable in the bits of the creg
+        unsigned long long limit = it->second.size >= 64 ? ~0ULL : (1ULL << it->second.size) - 1;
+        unsigned long long value;
+        if (!parseInteger(ctx->NNINTEGER()->getText(), limit, value))
+            error(DiagCode::ValueOutOfRange, ctx->NNINTEGER()->getSymbol(),
+                  "Value " + ctx->NNINTEGER()->getText() + " does not fit creg " + name + "[" + std::to_string(it->second.size) + "]");
+    }
+    qop(ctx->qopStmt());
+}
+
+void Validator::barrierDecl(QASM2Parser::BarrierDeclStmtContext *ctx)
+{
+    for (auto arg : ctx->mixedList()->argument())
+    {
+        Operand operand;
+        this->operand(arg, true, operand);
+    }
+}
+
+void Validator::qop(QASM2Parser::QopStmtContext *ctx)
+{
+    if (ctx->type == QASM2Parser::MEASURE)
+    {
+        std::vector<QASM2Parser::ArgumentContext *> args = ctx->argument();
+        Operand qubit, bit;
+        bool valid = operand(args[0], true, qubit);
+        valid = operand(args[1], false, bit) && valid;
+        if (valid && qubit.size != bit.size)
+            error(DiagCode::RegisterSizeMismatch, ctx->getStart(),
+                  "Measuring " + std::to_string(qubit.size) + " qubits into " + std::to_string(bit.size) + " bits");
+        return;
+    }
+    if (ctx->type == QASM2Parser::RESET)
+    {
+        Operand qubit;
+        operand(ctx->argument(0), true, qubit);
+        return;
+    }
+
+    QASM2Parser::UopContext *uop = ctx->uop();
+    std::vector<QASM2Parser::ArgumentContext *> args = uop->type == QASM2Parser::ID ? uop->mixedList()->argument() : uop->argument();
+    std::vector<Operand> operands;
+    bool valid = true;
+    for (auto arg : args)
+    {
+        Operand operand;
+        if (this->operand(arg, true, operand))
+            operands.push_back(operand);
+        else
+            valid = false;
+    }
+
+    size_t numParams = 0;
+    if (uop->expList())
+    {
+        for (auto exp : uop->expList()->exp())
+        {
+            expression(exp, {});
+        }
+        numParams = uop->expList()->exp().size();
+    }
+    if (checkGate(uop->getStart(), uop->gateName, numParams, args.size()) && valid)
+        checkOperands(uop->getStart(), operands);
+}
+
+void Validator::gateBodyUop(QASM2Parser::UopContext *ctx, const std::vector<std::string> &params, const std::vector<std::string> &qubits)
+{
+    std::vector<QASM2Parser::ArgumentContext *> args = ctx->type == QASM2Parser::ID ? ctx->mixedList()->argument() : ctx->argument();
+    std::vector<std::string> used;
+    for (auto arg : args)
+    {
+        std::string name = arg->ID()->getText();
+        if (arg->NNINTEGER())
+            error(DiagCode::UndefinedIdentifier, arg->getStart(), "Indexed qubit " + arg->getText() + " in gate body");
+        else if (std::find(qubits.begin(), qubits.end(), name) == qubits.end())
+            error(DiagCode::UndefinedIdentifier, arg->getStart(), "Unknown qubit " + name + " in gate body");
+        else if (std::find(used.begin(), used.end(), name) != used.end())
+            error(DiagCode::DuplicateQubit, arg->getStart(), "Qubit " + name + " is used twice in " + ctx->gateName);
+        used.push_back(name);
+    }
+
+    size_t numParams = 0;
+    if (ctx->expList())
+    {
+        for (auto exp : ctx->expList()->exp())
+        {
+            expression(exp, params);
+        }
+        numParams = ctx->expList()->exp().size();
+    }
+    checkGate(ctx->getStart(), ctx->gateName, numParams, args.size());
+}
+
+void Validator::expression(QASM2Parser::ExpContext *ctx, const std::vector<std::string> &params)
+{
+    if (ctx->exprType == ExprNode::ID)
+    {
+        std::string name = ctx->ID()->getText();
+        if (std::find(params.begin(), params.end(), name) == params.end())
+            error(DiagCode::UndefinedIdentifier, ctx->getStart(), "Unknown parameter " + name);
+        return;
+    }
+    for (auto exp : ctx->exp())
+    {
+        expression(exp, params);
+    }
+}
+
+void Validator::declareNames(const std::string &gate, const std::vector<tree::TerminalNode *> &ids,
+                             const std::vector<std::string> &taken, std::vector<std::string> &names)
+{
+    for (auto id : ids)
+    {
+        std::string name = id->getText();
+        if (std::find(names.begin(), names.end(), name) != names.end() || std::find(taken.begin(), taken.end(), name) != taken.end())
+            error(DiagCode::DuplicateArgument, id->getSymbol(), "Duplicate argument " + name + " in gate: " + gate);
+        names.push_back(name);
+    }
+}
+
+bool Validator::checkGate(Token *at, const std::string &name, size_t numParams, size_t numQubits)
+{
+    GateSignature signature;
+    if (name == "U")
+        signature = GateSignature{3, 1};
+    else if (name == "CX")
+        signature = GateSignature{0, 2};
+    else
+    {
+        auto it = gates.find(name);
+        if (it == gates.end())
+        {
+            error(DiagCode::UndefinedGate, at, "Undefined gate: " + name);
+            return false;
+        }
+        signature = it->second;
+    }
+
+    if (signature.numParams != numParams || signature.numQubits != numQubits)
+    {
+        error(DiagCode::WrongArgumentCount, at,
+              "Gate " + name + " takes " + std::to_string(signature.numParams) + " parameters and " + std::to_string(signature.numQubits) +
+                  " qubits, got " + std::to_string(numParams) + " and " + std::to_string(numQubits));
+        return false;
+    }
+    return true;
+}
+
+bool Validator::operand(QASM2Parser::ArgumentContext *arg, bool quantum, Operand &out)
+{
+    out.name = arg->ID()->getText();
+    auto it = registers.find(out.name);
+    if (it == registers.end())
+    {
+        error(DiagCode::UndefinedRegister, arg->getStart(), std::string(quantum ? "Undefined qreg: " : "Undefined creg: ") + out.name);
+        return false;
+    }
+    if (it->second.quantum != quantum)
+    {
+        error(DiagCode::WrongRegisterKind, arg->getStart(),
+              out.name + (quantum ? " is a creg, expected a qreg" : " is a qreg, expected a creg"));
+        return false;
+    }
+
+    if (!arg->NNINTEGER())
+    {
+        out.index = -1;
+        out.size = it->second.size;
+        return true;
+    }
+    unsigned long long index;
+    if (!parseInteger(arg->NNINTEGER()->getText(), it->second.size - 1, index))
+    {
+        error(DiagCode::IndexOutOfRange, arg->NNINTEGER()->getSymbol(),
+              "Index " + arg->NNINTEGER()->getText() + " out of range for " + out.name + "[" + std::to_string(it->second.size) + "]");
+        return false;
+    }
+    out.index = static_cast<int>(index);
+    out.size = 1;
+    return true;
+}
+
+void Validator::checkOperands(Token *at, const std::vector<Operand> &operands)
+{
+    // whole registers are broadcast, so they must all have the same size
+    size_t broadcast = 0;
+    for (const auto &operand : operands)
+    {
+        if (operand.index >= 0)
+            continue;
+        if (broadcast != 0 && operand.size != broadcast)
+        {
+            error(DiagCode::RegisterSizeMismatch, at, "Register " + operand.name + " of size " + std::to_string(operand.size) +
+                                                          " does not match size " + std::to_string(broadcast));
+            return;
+        }
+        broadcast = operand.size;
+    }
+
+    // and no qubit may appear twice
+    for (size_t i = 0; i < operands.size(); ++i)
+    {
+        for (size_t j = i + 1; j < operands.size(); ++j)
+        {
+            const Operand &a = operands[i], &b = operands[j];
+            if (a.name == b.name && (a.index < 0 || b.index < 0 || a.index == b.index))
+            {
+                std::string qubit = b.index < 0 ? b.name : b.name + "[" + std::to_string(b.index) + "]";
+                error(DiagCode::DuplicateQubit, at, "Qubit " + qubit + " is used twice");
+                return;
+            }
+        }
+    }
+}
+
+void Validator::error(DiagCode code, Token *at, const std::string &message)
+{
+    size_t line = at ? at->getLine() : 0;
+    size_t column = at ? at->getCharPositionInLine() + 1 : 0;
+    sink.report(code, source, line, column, message);
+}
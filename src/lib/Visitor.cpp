@@ -1,27 +1,31 @@
 
 #include <fstream>
+#include <sstream>
 #include <antlr4-runtime.h>
 #include "QASM2Lexer.h"
 #include "QASM2Parser.h"
 #include "Visitor.h"
 #include "Expr.h"
+#include "StdLib.h"
 
 using namespace antlr4;
 using namespace qasmcpp;
 
 Any QASM2Visitor::visitMain(QASM2Parser::MainContext *ctx)
 {
-
     program = std::make_shared<ProgramNode>();
-
-    visitVersion(ctx->version());
-
-    for (auto statement : ctx->statement())
+    program->exprPool = exprPool;
+    // gate bodies point into the pool, the table must outlive the program
+    symbolTable.exprPool = exprPool;
+    program->version = ctx->version()->ver;
+
+    auto statements = ctx->statement();
+    program->statements.reserve(statements.size());
+    for (auto statement : statements)
     {
-        // std::cout << "STATEMENT: " << statement->getText() << " " << std::endl;
-        auto stmt = visitStatement(statement);
-        auto gateStmt = stmt.as<std::shared_ptr<QASMNode>>();
-        program->statements.push_back(stmt);
+        auto node = buildStatement(statement);
+        if (node)
+            program->statements.push_back(std::move(node));
     }
 
     return program;
@@ -34,13 +38,126 @@ Any QASM2Visitor::visitVersion(QASM2Parser::VersionContext *ctx)
 };
 
 Any QASM2Visitor::visitIncludeDeclStmt(QASM2Parser::IncludeDeclStmtContext *ctx)
+{
+    return buildInclude(ctx);
+}
+
+Any QASM2Visitor::visitRegDeclStmt(QASM2Parser::RegDeclStmtContext *ctx)
+{
+    return buildRegDecl(ctx);
+}
+
+Any QASM2Visitor::visitGateDeclStmt(QASM2Parser::GateDeclStmtContext *ctx)
+{
+    return buildGateDecl(ctx);
+}
+
+Any QASM2Visitor::visitOpaqueDeclStmt(QASM2Parser::OpaqueDeclStmtContext *ctx)
+{
+    throw std::runtime_error("Opaque statement not implemented yet");
+    return visitChildren(ctx);
+}
+
+Any QASM2Visitor::visitQopStmt(QASM2Parser::QopStmtContext *ctx)
+{
+    return buildQop(ctx);
+}
+
+Any QASM2Visitor::visitIfDeclStmt(QASM2Parser::IfDeclStmtContext *ctx)
+{
+    return buildIf(ctx);
+}
+
+Any QASM2Visitor::visitBarrierDeclStmt(QASM2Parser::BarrierDeclStmtContext *ctx)
+{
+    return buildBarrier(ctx);
+}
+
+Any QASM2Visitor::visitUop(QASM2Parser::UopContext *ctx)
+{
+    return buildUop(ctx);
+}
+
+Any QASM2Visitor::visitArgument(QASM2Parser::ArgumentContext *ctx)
+{
+    return std::make_shared<Bit>(buildArgument(ctx));
+}
+
+Any QASM2Visitor::visitExpList(QASM2Parser::ExpListContext *ctx)
+{
+    std::vector<std::shared_ptr<ExprNode>> expList;
+    buildExpList(ctx, expList);
+    return expList;
+}
+
+Any QASM2Visitor::visitExp(QASM2Parser::ExpContext *ctx)
+{
+    return buildExp(ctx);
+}
+
+Any QASM2Visitor::visitOp(QASM2Parser::OpContext *ctx)
+{
+    return ctx->opType;
+}
+
+Any QASM2Visitor::visitIdList(QASM2Parser::IdListContext *ctx)
+{
+    std::vector<std::string> ids;
+    buildIdList(ctx, ids);
+    return ids;
+}
+
+Any QASM2Visitor::visitMixedList(QASM2Parser::MixedListContext *ctx)
+{
+    std::vector<std::shared_ptr<Bit>> ids;
+    buildMixedList(ctx, ids);
+    return ids;
+}
+
+std::shared_ptr<QASMNode> QASM2Visitor::buildStatement(QASM2Parser::StatementContext *ctx)
+{
+    if (auto qop = ctx->qopStmt())
+        return buildQop(qop);
+    if (auto gateDecl = ctx->gateDeclStmt())
+        return buildGateDecl(gateDecl);
+    if (auto regDecl = ctx->regDeclStmt())
+        return buildRegDecl(regDecl);
+    if (auto barrier = ctx->barrierDeclStmt())
+        return buildBarrier(barrier);
+    if (auto include = ctx->includeDeclStmt())
+        return buildInclude(include);
+    if (auto ifDecl = ctx->ifDeclStmt())
+        return buildIf(ifDecl);
+    if (auto opaque = ctx->opaqueDeclStmt())
+        visitOpaqueDeclStmt(opaque);
+    // a statement the parser could not recognize has no node
+    return nullptr;
+}
+
+std::shared_ptr<QASMNode> QASM2Visitor::buildInclude(QASM2Parser::IncludeDeclStmtContext *ctx)
 {
     auto includeNode = std::make_shared<IncludeDeclNode>();
     includeNode->filename = ctx->filename;
-    auto node = std::dynamic_pointer_cast<QASMNode>(includeNode);
 
     std::string name = ctx->filename.substr(1, ctx->filename.size() - 2);
 
+    // a file loaded before, here or into the base table, adds nothing new
+    if (symbolTable.hasInclude(name)) {
+        return includeNode;
+    }
+    symbolTable.includes.insert(name);
+
+    // a nested include runs inside the timer of the outermost one
+    PhaseTimer timer(stats && includeDepth == 0 ? &stats->includeTime : nullptr);
+
+    if (useBuiltinStdlib && stdlib::isQelib1(name)) {
+        stdlib::loadQelib1(symbolTable);
+        if (stats) {
+            stats->includeFiles++;
+        }
+        return includeNode;
+    }
+
     std::ifstream stream;
 
     stream.open(name);
@@ -48,309 +165,211 @@ Any QASM2Visitor::visitIncludeDeclStmt(QASM2Parser::IncludeDeclStmtContext *ctx)
         std::cerr << "Could not open file: " << name<< std::endl;
     }
 
-    ANTLRInputStream input(stream);
+    std::stringstream buffer;
+    buffer << stream.rdbuf();
+    std::string source = buffer.str();
+
+    if (stats) {
+        stats->includeFiles++;
+        stats->bytesRead += source.size();
+    }
+
+    ANTLRInputStream input(source);
     QASM2Lexer lexer(&input);
     CommonTokenStream tokens(&lexer);
     QASM2Parser parser(&tokens);
     QASM2Parser::MainContext *tree = parser.main();
-    visit(tree);
 
-    return node;
+    // only the declarations of the included file are kept, in the symbol table
+    includeDepth++;
+    for (auto statement : tree->statement())
+    {
+        buildStatement(statement);
+    }
+    includeDepth--;
+
+    return includeNode;
 }
 
-Any QASM2Visitor::visitRegDeclStmt(QASM2Parser::RegDeclStmtContext *ctx)
+std::shared_ptr<QASMNode> QASM2Visitor::buildRegDecl(QASM2Parser::RegDeclStmtContext *ctx)
 {
-
-    RegDeclNode::RegType regType = RegDeclNode::RegType::QREG;
+    auto regDecl = std::make_shared<RegDeclNode>();
+    regDecl->regName = ctx->ID()->getText();
+    regDecl->size = std::stoi(ctx->NNINTEGER()->getText());
 
     if (ctx->QREG() != nullptr)
     {
-        symbolTable.addQubitRegister(ctx->ID()->getText(), std::stoi(ctx->NNINTEGER()->getText()));
+        regDecl->regType = RegDeclNode::RegType::QREG;
+        symbolTable.addQubitRegister(regDecl->regName, regDecl->size);
     }
-    else if (ctx->CREG() != nullptr)
+    else
     {
-        regType = RegDeclNode::RegType::CREG;
-        symbolTable.addCbitRegister(ctx->ID()->getText(), std::stoi(ctx->NNINTEGER()->getText()));
+        regDecl->regType = RegDeclNode::RegType::CREG;
+        symbolTable.addCbitRegister(regDecl->regName, regDecl->size);
     }
-
-    auto regDecl = std::make_shared<RegDeclNode>();
-    regDecl->regName = ctx->ID()->getText();
-    regDecl->size = std::stoi(ctx->NNINTEGER()->getText());
-    regDecl->regType = regType;
-
-    auto node = std::dynamic_pointer_cast<QASMNode>(regDecl);
-    return node;
+    return regDecl;
 }
 
-Any QASM2Visitor::visitGateDeclStmt(QASM2Parser::GateDeclStmtContext *ctx)
+std::shared_ptr<QASMNode> QASM2Visitor::buildGateDecl(QASM2Parser::GateDeclStmtContext *ctx)
 {
     auto gateDecl = std::make_shared<GateDeclNode>();
     auto gateDef = std::make_shared<Gate>();
-
-    // check size of idList()
-    unsigned int size = ctx->idList().size();
-
-    // set gate name
     gateDecl->gateName = ctx->ID()->getText();
+    gateDef->name = gateDecl->gateName;
 
-    // handle params and qubits
-    std::vector<std::string> params;
+    // params and qubits go straight into the gate definition
     std::vector<std::string> qubits;
-
     if (ctx->hasParams)
     {
-        params = visitIdList(ctx->idList()[0]).as<std::vector<std::string>>();
-        qubits = visitIdList(ctx->idList()[1]).as<std::vector<std::string>>();
+        buildIdList(ctx->idList()[0], gateDef->params);
+        buildIdList(ctx->idList()[1], qubits);
     }
     else
     {
-        qubits = visitIdList(ctx->idList()[0]).as<std::vector<std::string>>();
+        buildIdList(ctx->idList()[0], qubits);
     }
 
-    // iterate over uop() and add to body
-    for (auto uop : ctx->uop())
+    auto uops = ctx->uop();
+    gateDecl->body.reserve(uops.size());
+    for (auto uop : uops)
     {
-        auto uopNode = visitUop(uop).as<std::shared_ptr<QASMNode>>();
-        gateDecl->body.push_back(uopNode);
+        gateDecl->body.push_back(buildUop(uop));
     }
 
-    // add gate to symbol table
-    gateDef->name = gateDecl->gateName;
-    gateDef->params = params;
-    for (auto qubit : qubits)
+    gateDef->qubits.reserve(qubits.size());
+    for (const auto &qubit : qubits)
     {
         gateDef->qubits.push_back(std::make_shared<Bit>(qubit, -1, BitType::Qubit));
     }
     gateDef->body = gateDecl->body;
-    symbolTable.addGateDef(gateDef->name, gateDef);
-
     gateDecl->qubits = gateDef->qubits;
+    symbolTable.addGateDef(gateDef->name, gateDef);
 
-    auto node = std::dynamic_pointer_cast<QASMNode>(gateDecl);
-
-    return node;
+    return gateDecl;
 }
 
-Any QASM2Visitor::visitOpaqueDeclStmt(QASM2Parser::OpaqueDeclStmtContext *ctx)
-{
-    throw std::runtime_error("Opaque statement not implemented yet");
-    return visitChildren(ctx);
-}
-
-Any QASM2Visitor::visitQopStmt(QASM2Parser::QopStmtContext *ctx)
+std::shared_ptr<QASMNode> QASM2Visitor::buildQop(QASM2Parser::QopStmtContext *ctx)
 {
     switch (ctx->type)
     {
     case QASM2Parser::MEASURE:
-    {
-        auto qubit = visitArgument(ctx->argument()[0]).as<std::shared_ptr<Bit>>();
-        auto cbit = visitArgument(ctx->argument()[1]).as<std::shared_ptr<Bit>>();
-
-        auto measureStmt = std::make_shared<MeasureStmtNode>(*qubit, *cbit);
-        auto node = std::dynamic_pointer_cast<QASMNode>(measureStmt);
-        return node;
-    }
+        return std::make_shared<MeasureStmtNode>(buildArgument(ctx->argument(0)), buildArgument(ctx->argument(1)));
     case QASM2Parser::RESET:
-    {
-        auto qubit = visitArgument(ctx->argument()[0]).as<std::shared_ptr<Bit>>();
-
-        auto resetStmt = std::make_shared<ResetStmtNode>(*qubit);
-        auto node = std::dynamic_pointer_cast<QASMNode>(resetStmt);
-        return node;
-    }
+        return std::make_shared<ResetStmtNode>(buildArgument(ctx->argument(0)));
     default:
-        return visitUop(ctx->uop());
-        break;
+        return buildUop(ctx->uop());
     }
-    return visitChildren(ctx);
 }
 
-Any QASM2Visitor::visitIfDeclStmt(QASM2Parser::IfDeclStmtContext *ctx)
+std::shared_ptr<QASMNode> QASM2Visitor::buildIf(QASM2Parser::IfDeclStmtContext *ctx)
 {
-    throw std::runtime_error("If statement not implemented yet");
-    return visitChildren(ctx);
+    Bit creg(ctx->ID()->getText(), -1, BitType::Cbit);
+    return std::make_shared<IfStmtNode>(creg, std::stoull(ctx->NNINTEGER()->getText()), buildQop(ctx->qopStmt()));
 }
 
-Any QASM2Visitor::visitBarrierDeclStmt(QASM2Parser::BarrierDeclStmtContext *ctx)
+std::shared_ptr<QASMNode> QASM2Visitor::buildBarrier(QASM2Parser::BarrierDeclStmtContext *ctx)
 {
-    // rise error if barrier is not implemented
-    throw std::runtime_error("Barrier statement not implemented yet");
-    return visitChildren(ctx);
+    auto barrierStmt = std::make_shared<BarrierStmtNode>(std::vector<Bit>());
+    auto args = ctx->mixedList()->argument();
+    barrierStmt->qubits.reserve(args.size());
+    for (auto arg : args)
+    {
+        barrierStmt->qubits.push_back(buildArgument(arg));
+    }
+    return barrierStmt;
 }
 
-Any QASM2Visitor::visitUop(QASM2Parser::UopContext *ctx)
+std::shared_ptr<QASMNode> QASM2Visitor::buildUop(QASM2Parser::UopContext *ctx)
 {
     switch (ctx->type)
     {
     case QASM2Parser::U:
     {
-        /* code */
-        auto qubit = visitArgument(ctx->argument()[0]).as<std::shared_ptr<Bit>>();
-        auto expList = visitExpList(ctx->expList()).as<std::vector<std::shared_ptr<ExprNode>>>();
-
-        auto theta = expList[0];
-        auto phi = expList[1];
-        auto lambda = expList[2];
-
-        auto uStmt = std::make_shared<UStmtNode>(*qubit, theta, phi, lambda);
-        auto node = std::dynamic_pointer_cast<QASMNode>(uStmt);
-
-        return node;
+        auto exps = ctx->expList()->exp();
+        return std::make_shared<UStmtNode>(buildArgument(ctx->argument(0)), buildExp(exps[0]), buildExp(exps[1]), buildExp(exps[2]));
     }
     case QASM2Parser::CX:
-    {
-        /* code */
-        auto control = visitArgument(ctx->argument()[0]).as<std::shared_ptr<Bit>>();
-        auto target = visitArgument(ctx->argument()[1]).as<std::shared_ptr<Bit>>();
-
-        auto cxStmt = std::make_shared<CXStmtNode>(*control, *target);
-        auto node = std::dynamic_pointer_cast<QASMNode>(cxStmt);
-
-        return node;
-    }
+        return std::make_shared<CXStmtNode>(buildArgument(ctx->argument(0)), buildArgument(ctx->argument(1)));
     case QASM2Parser::ID:
     {
-        std::string gateName = ctx->gateName;
-
-        // check if gate has params
-        std::vector<std::shared_ptr<ExprNode>> expList;
+        auto gateStmt = std::make_shared<GateStmtNode>(ctx->gateName, std::vector<std::shared_ptr<ExprNode>>(), std::vector<std::shared_ptr<Bit>>());
         if (ctx->expList() != nullptr)
         {
-            expList = visitExpList(ctx->expList()).as<std::vector<std::shared_ptr<ExprNode>>>();
+            buildExpList(ctx->expList(), gateStmt->params);
         }
-
-        // vitsit mixedList
-        auto qubits = visitMixedList(ctx->mixedList());
-
-        auto gateStmt = std::make_shared<GateStmtNode>(gateName, expList, qubits);
-        auto node = std::dynamic_pointer_cast<QASMNode>(gateStmt);
-
-        return node;
+        buildMixedList(ctx->mixedList(), gateStmt->qubits);
+        return gateStmt;
     }
     }
-    return visitChildren(ctx);
+    return nullptr;
 }
 
-Any QASM2Visitor::visitArgument(QASM2Parser::ArgumentContext *ctx)
+Bit QASM2Visitor::buildArgument(QASM2Parser::ArgumentContext *ctx)
 {
-
-    std::string id = ctx->ID()->getText();
-
     int index = -1;
-
     if (ctx->NNINTEGER() != nullptr)
         index = std::stoi(ctx->NNINTEGER()->getText());
 
-    return std::make_shared<Bit>(id, index, BitType::Unknown);
+    return Bit(ctx->ID()->getText(), index, BitType::Unknown);
 }
 
-Any QASM2Visitor::visitExpList(QASM2Parser::ExpListContext *ctx)
+void QASM2Visitor::buildExpList(QASM2Parser::ExpListContext *ctx, std::vector<std::shared_ptr<ExprNode>> &exps)
 {
-    // list of expressions node
-    std::vector<std::shared_ptr<ExprNode>> expList;
-
-    for (auto exp : ctx->exp())
+    auto items = ctx->exp();
+    exps.reserve(exps.size() + items.size());
+    for (auto exp : items)
     {
-        auto expNode = visitExp(exp).as<std::shared_ptr<ExprNode>>();
-        expList.push_back(expNode);
+        exps.push_back(buildExp(exp));
     }
-
-    return expList;
 }
 
-Any QASM2Visitor::visitExp(QASM2Parser::ExpContext *ctx)
+void QASM2Visitor::buildIdList(QASM2Parser::IdListContext *ctx, std::vector<std::string> &ids)
 {
+    auto items = ctx->ID();
+    ids.reserve(ids.size() + items.size());
+    for (auto id : items)
+    {
+        ids.push_back(id->getText());
+    }
+}
 
-    std::shared_ptr<ExprNode> expNode;
+void QASM2Visitor::buildMixedList(QASM2Parser::MixedListContext *ctx, std::vector<std::shared_ptr<Bit>> &bits)
+{
+    auto items = ctx->argument();
+    bits.reserve(bits.size() + items.size());
+    for (auto arg : items)
+    {
+        bits.push_back(std::make_shared<Bit>(buildArgument(arg)));
+    }
+}
 
-    // check if expression is a number
+std::shared_ptr<ExprNode> QASM2Visitor::buildExp(QASM2Parser::ExpContext *ctx)
+{
     switch (ctx->exprType)
     {
     case ExprNode::NNINTEGER:
-    {
-        expNode = std::make_shared<NNIntegerLiteralNode>(std::stoi(ctx->NNINTEGER()->getText()));
-        break;
-    }
+        return exprPool->integer(std::stoi(ctx->NNINTEGER()->getText()));
     case ExprNode::REAL:
-    {
-        expNode = std::make_shared<RealLiteralNode>(std::stod(ctx->REAL()->getText()));
-        break;
-    }
+        return exprPool->real(std::stod(ctx->REAL()->getText()));
     case ExprNode::ID:
-    {
-        expNode = std::make_shared<IdentifierNode>(ctx->ID()->getText());
-        break;
-    }
+        return exprPool->identifier(ctx->ID()->getText());
     case ExprNode::PI:
     {
         const double pi = 3.1415926535897932384626433;
-        expNode = std::make_shared<RealLiteralNode>(pi);
-        break;
+        return exprPool->real(pi);
     }
     case ExprNode::UNARY:
-    {
-        // unary expression
-        auto unary = ctx->unaryop()->opType;
-        auto exp = visitExp(ctx->exp()[0]).as<std::shared_ptr<ExprNode>>();
-        expNode = std::make_shared<UnaryExprNode>(unary, exp);
-        break;
-    }
+        return exprPool->unary(ctx->unaryop()->opType, buildExp(ctx->exp(0)));
     case ExprNode::BINARY:
     {
-        auto left = visitExp(ctx->exp()[0]).as<std::shared_ptr<ExprNode>>();
-        auto right = visitExp(ctx->exp()[1]).as<std::shared_ptr<ExprNode>>();
-        auto op = visitOp(ctx->op()).as<ExprNode::ArithOpType>();
-
-        expNode = std::make_shared<BinaryExprNode>(op, left, right);
-        break;
+        auto left = buildExp(ctx->exp(0));
+        auto right = buildExp(ctx->exp(1));
+        return exprPool->binary(ctx->op()->opType, left, right);
     }
     case ExprNode::NAG:
-    {
-        auto exp = visitExp(ctx->exp()[0]).as<std::shared_ptr<ExprNode>>();
-        expNode = std::make_shared<UnaryExprNode>(ExprNode::UnaryOpType::NAGATIVE, exp);
-        break;
-    }
-    case ExprNode::EXPR: 
-    {
-        expNode = visitExp(ctx->exp()[0]).as<std::shared_ptr<ExprNode>>();
-        break;
-    }
-    default:
-    {
-        throw std::runtime_error("Expression not implemented yet");
-        break;
-    }
+        return exprPool->unary(ExprNode::UnaryOpType::NAGATIVE, buildExp(ctx->exp(0)));
+    case ExprNode::EXPR:
+        return buildExp(ctx->exp(0));
     }
-    auto node = std::dynamic_pointer_cast<ExprNode>(expNode);
-
-    return node;
+    throw std::runtime_error("Expression not implemented yet");
 }
-
-Any QASM2Visitor::visitOp(QASM2Parser::OpContext *ctx)
-{
-    return ctx->opType;
-}
-
-Any QASM2Visitor::visitIdList(QASM2Parser::IdListContext *ctx)
-{
-    std::vector<std::string> ids;
-
-    for (auto id : ctx->ID())
-    {
-        ids.push_back(id->getText());
-    }
-    return ids;
-}
-
-Any QASM2Visitor::visitMixedList(QASM2Parser::MixedListContext *ctx)
-{
-    std::vector<std::shared_ptr<Bit>> ids;
-
-    for (auto id : ctx->argument())
-    {
-        auto bit = visitArgument(id).as<std::shared_ptr<Bit>>();
-        ids.push_back(bit);
-    }
-
-    return ids;
-}
\ No newline at end of file
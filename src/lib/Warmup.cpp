@@ -0,0 +1,102 @@
+#include <fstream>
+#include <antlr4-runtime.h>
+#include "QASM2Lexer.h"
+#include "QASM2Parser.h"
+#include "StatementReader.h"
+#include "Warmup.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+// Touches every rule and the common expression forms once
+static const char *kCorpus =
+    "OPENQASM 2.0;\n"
+    "include \"qelib1.inc\";\n"
+    "qreg q[3];\n"
+    "creg c[3];\n"
+    "gate g(a, b) x, y { U(a * pi / 2, -b, sin(a) + cos(b) ^ 2) x; CX x, y; rz((a - b) / 4) y; }\n"
+    "h q;\n"
+    "g(0.5, 2.5e-3) q[0], q[1];\n"
+    "ccx q[0], q[1], q[2];\n"
+    "u3(pi, sqrt(2), ln(3)) q[2];\n"
+    "barrier q;\n"
+    "measure q -> c;\n"
+    "reset q[0];\n";
+
+// Parses one statement with the rule matching it, errors are ignored
+static void parseStatement(const std::string &text)
+{
+    ANTLRInputStream input(text);
+    QASM2Lexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    QASM2Parser parser(&tokens);
+    lexer.removeErrorListeners();
+    parser.removeErrorListeners();
+
+    if (text.compare(0, 8, "OPENQASM") == 0 || text.compare(0, 8, "openqasm") == 0)
+        parser.version();
+    else
+        parser.statement();
+}
+
+const char *warmup::builtinCorpus()
+{
+    return kCorpus;
+}
+
+size_t warmup::replay(std::istream &input)
+{
+    StatementReader reader(input);
+    std::string text;
+    size_t count = 0;
+    while (reader.next(text))
+    {
+        parseStatement(text);
+        count++;
+    }
+    return count;
+}
+
+bool warmup::replayFile(const std::string &path)
+{
+    std::ifstream stream(path);
+    if (!stream.is_open())
+        return false;
+    replay(stream);
+    return true;
+}
+
+size_t warmup::writeSnapshot(std::istream &input, std::ostream &out)
+{
+    StatementReader reader(input);
+    std::string text;
+    size_t kept = 0;
+    out << "// Prediction warmup snapshot, replayed by run_qasm2 at startup" << std::endl;
+    while (reader.next(text))
+    {
+        size_t before = dfaStateCount();
+        parseStatement(text);
+        if (dfaStateCount() > before)
+        {
+            out << text << std::endl;
+            kept++;
+        }
+    }
+    return kept;
+}
+
+size_t warmup::dfaStateCount()
+{
+    // the DFAs are static members of the generated parser, any instance reaches them
+    ANTLRInputStream input("");
+    QASM2Lexer lexer(&input);
+    CommonTokenStream tokens(&lexer);
+    QASM2Parser parser(&tokens);
+
+    size_t count = 0;
+    for (const auto &dfa : parser.getInterpreter<atn::ParserATNSimulator>()->decisionToDFA)
+    {
+        count += dfa.states.size();
+    }
+    return count;
+}
@@ -0,0 +1,51 @@
+// test/ASTTests.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "Expr.h"
+
+using namespace qasmcpp;
+
+TEST(ASTTest, ExprPoolSharesNodes) {
+    ExprPool pool;
+    auto half = pool.binary(ExprNode::DIVIDE, pool.real(M_PI), pool.integer(2));
+    ASSERT_EQ(pool.binary(ExprNode::DIVIDE, pool.real(M_PI), pool.integer(2)), half);
+    ASSERT_NE(pool.binary(ExprNode::TIMES, pool.real(M_PI), pool.integer(2)), half);
+    ASSERT_TRUE(half->constant);
+    ASSERT_FALSE(pool.unary(ExprNode::NAGATIVE, pool.identifier("theta"))->constant);
+
+    // trees built outside of the pool map to the same nodes
+    auto outside = std::make_shared<BinaryExprNode>(ExprNode::DIVIDE, std::make_shared<RealLiteralNode>(M_PI),
+                                                    std::make_shared<NNIntegerLiteralNode>(2));
+    ASSERT_EQ(pool.intern(outside), half);
+    ASSERT_EQ(half->pool, &pool);
+    ASSERT_EQ(pool.get(half->id), half);
+}
+
+TEST(ASTTest, ExprEvaluatorMemoizes) {
+    ExprPool pool;
+    auto theta = pool.identifier("theta");
+    auto sum = pool.binary(ExprNode::PLUS, pool.binary(ExprNode::DIVIDE, theta, pool.integer(2)),
+                           pool.binary(ExprNode::DIVIDE, theta, pool.integer(2)));
+    std::vector<std::string> params = {"theta"};
+    std::vector<double> values = {1.0};
+
+    ExprEvaluator evaluator;
+    evaluator.bind(params, values);
+    ASSERT_DOUBLE_EQ(evaluator.evaluate(*sum), 1.0);
+    ASSERT_EQ(evaluator.getComputed(), 4); // sum, theta/2, theta, 2
+
+    // the same binding keeps the results, a new one recomputes all but the constant
+    evaluator.bind(params, values);
+    evaluator.evaluate(*sum);
+    ASSERT_EQ(evaluator.getComputed(), 4);
+    values[0] = 3.0;
+    evaluator.bind(params, values);
+    ASSERT_DOUBLE_EQ(evaluator.evaluate(*sum), 3.0);
+    ASSERT_EQ(evaluator.getComputed(), 7);
+
+    // nodes outside of a pool are evaluated directly
+    RealLiteralNode literal(0.5);
+    ASSERT_DOUBLE_EQ(evaluator.evaluate(literal), 0.5);
+    ASSERT_THROW(evaluator.evaluate(*pool.identifier("phi")), std::runtime_error);
+}
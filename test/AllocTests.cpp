@@ -0,0 +1,181 @@
+// test/AllocTests.cpp
+
+#include <gtest/gtest.h>
+#include <antlr4-runtime.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+#include "QASM2Lexer.h"
+#include "QASM2Parser.h"
+#include "Visitor.h"
+#include "AllocCounter.h"
+
+using namespace antlr4;
+using namespace qasmcpp;
+
+// Allocation budgets per statement for each front-end phase.
+// A statement is a ';' terminated statement (gate body statements included)
+// or a gate declaration, counted over the source and the included files that
+// are parsed.
+static const double kLexBudget = 40;
+static const double kParseBudget = 150;
+static const double kVisitBudget = 150;
+
+// Changes the working directory for the lifetime of a scope, so a failed
+// assertion or a throw does not leave later tests running elsewhere
+class ScopedWorkingDir {
+public:
+    explicit ScopedWorkingDir(const char* path) {
+        changed = getcwd(previous, sizeof(previous)) != nullptr && chdir(path) == 0;
+    }
+
+    ~ScopedWorkingDir() {
+        if (changed && chdir(previous) != 0) {
+            std::cerr << "Could not restore working directory: " << previous << std::endl;
+        }
+    }
+
+    bool ok() const { return changed; }
+
+private:
+    char previous[4096];
+    bool changed = false;
+};
+
+class AllocTest : public ::testing::Test {
+protected:
+    AllocCounts lexAllocs;
+    AllocCounts parseAllocs;
+    AllocCounts visitAllocs;
+
+    void SetUp() override {
+        ASSERT_TRUE(alloc::hooksInstalled());
+    }
+
+    // Run each phase under its own allocation scope
+    void parse(const std::string& qasm_code) {
+        ANTLRInputStream input(qasm_code);
+        QASM2Lexer lexer(&input);
+        CommonTokenStream tokens(&lexer);
+        {
+            AllocScope scope(&lexAllocs);
+            tokens.fill();
+        }
+
+        QASM2Parser parser(&tokens);
+        tree::ParseTree *tree;
+        {
+            AllocScope scope(&parseAllocs);
+            tree = parser.main();
+        }
+
+        QASM2Visitor visitor;
+        {
+            AllocScope scope(&visitAllocs);
+            visitor.visit(tree);
+        }
+    }
+
+    static std::string readFile(const std::string& path) {
+        std::ifstream stream(path);
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+        return buffer.str();
+    }
+
+    // Count ';' terminated statements and gate declarations outside comments
+    static size_t countStatements(const std::string& source) {
+        size_t count = 0;
+        int depth = 0;
+        for (size_t i = 0; i < source.size(); ++i) {
+            char c = source[i];
+            if (c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+                i = source.find('\n', i);
+                if (i == std::string::npos)
+                    break;
+            } else if (c == '{') {
+                depth++;
+            } else if (c == '}' && --depth == 0) {
+                count++;
+            } else if (c == ';') {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    void expectWithinBudget(size_t statements) {
+        ASSERT_GT(statements, 0);
+        double lexPerStmt = double(lexAllocs.allocations) / statements;
+        double parsePerStmt = double(parseAllocs.allocations) / statements;
+        double visitPerStmt = double(visitAllocs.allocations) / statements;
+
+        RecordProperty("lexAllocsPerStmt", std::to_string(lexPerStmt));
+        RecordProperty("parseAllocsPerStmt", std::to_string(parsePerStmt));
+        RecordProperty("visitAllocsPerStmt", std::to_string(visitPerStmt));
+
+        EXPECT_LE(lexPerStmt, kLexBudget);
+        EXPECT_LE(parsePerStmt, kParseBudget);
+        EXPECT_LE(visitPerStmt, kVisitBudget);
+    }
+};
+
+TEST_F(AllocTest, ScopeCountsAllocations) {
+    AllocCounts counts;
+    {
+        AllocScope scope(&counts);
+        std::unique_ptr<int> value(new int(42));
+        std::vector<double> values(16);
+    }
+    ASSERT_EQ(counts.allocations, 2);
+    ASSERT_GE(counts.bytes, sizeof(int) + 16 * sizeof(double));
+}
+
+TEST_F(AllocTest, NullScopeIsDisabled) {
+    // a disabled scope neither allocates nor adds to the scopes around it
+    AllocCounts outer;
+    std::unique_ptr<int> value;
+    AllocCounts before = alloc::current();
+    {
+        AllocScope scope(&outer);
+        {
+            AllocScope disabled(nullptr);
+            value.reset(new int(42));
+        }
+    }
+    AllocCounts after = alloc::current();
+    ASSERT_EQ(*value, 42);
+    ASSERT_EQ(outer.allocations, 1);
+    ASSERT_EQ(outer.bytes, sizeof(int));
+    ASSERT_EQ(after.allocations - before.allocations, 1);
+}
+
+TEST_F(AllocTest, GateStatementBudget) {
+    std::ostringstream qasm_code;
+    qasm_code << "OPENQASM 2.0;\nqreg q[8];\ncreg c[8];\n";
+    for (int i = 0; i < 1000; ++i) {
+        switch (i % 4) {
+        case 0: qasm_code << "h q[" << i % 8 << "];\n"; break;
+        case 1: qasm_code << "cx q[" << i % 8 << "],q[" << (i + 1) % 8 << "];\n"; break;
+        case 2: qasm_code << "U(pi/2,0,pi) q[" << i % 8 << "];\n"; break;
+        default: qasm_code << "u1(-pi/4) q[" << i % 8 << "];\n"; break;
+        }
+    }
+    qasm_code << "measure q -> c;\n";
+
+    parse(qasm_code.str());
+    expectWithinBudget(countStatements(qasm_code.str()));
+}
+
+TEST_F(AllocTest, AdderCircuitBudget) {
+    // The adder includes "../test/circuits/*.inc" relative to the working directory
+    ScopedWorkingDir workingDir(QASM2_TEST_DIR);
+    ASSERT_TRUE(workingDir.ok());
+
+    // qelib1.inc loads the built-in tables, no statement of it is lexed, parsed or visited
+    std::string source = readFile("circuits/adder_n4_cus.qasm");
+    size_t statements = countStatements(source) + countStatements(readFile("circuits/myLibrary.inc"));
+    parse(source);
+    expectWithinBudget(statements);
+}
@@ -0,0 +1,88 @@
+// test/BatchTests.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include "Batch.h"
+#include "Lowering.h"
+
+using namespace qasmcpp;
+
+TEST(BatchTest, BaseSymbolTable) {
+    auto base = std::make_shared<SymbolTable>();
+    auto gate = std::make_shared<Gate>();
+    gate->name = "shared";
+    base->addGateDef("shared", gate);
+    base->includes.insert("qelib1.inc");
+
+    SymbolTable table;
+    table.base = base;
+    ASSERT_TRUE(table.hasGateDef("shared"));
+    ASSERT_EQ(table.findGateDef("shared"), gate);
+    ASSERT_TRUE(table.hasInclude("qelib1.inc"));
+    ASSERT_TRUE(table.gateDefines.empty());
+
+    // own declarations shadow the base and never change it
+    auto own = std::make_shared<Gate>();
+    own->name = "shared";
+    table.addGateDef("shared", own);
+    table.addQubitRegister("q", 2);
+    ASSERT_EQ(table.findGateDef("shared"), own);
+    ASSERT_EQ(base->findGateDef("shared"), gate);
+    ASSERT_FALSE(base->isQubitRegister("q"));
+    ASSERT_THROW(table.addGateDef("shared", own), std::runtime_error);
+}
+
+TEST(BatchTest, ParsesInOrderWithStatus) {
+    auto base = BatchParser::makeBase("OPENQASM 2.0;\ninclude \"qelib1.inc\";\ngate bell a, b { h a; cx a, b; }");
+    ASSERT_TRUE(base->hasGateDef("bell"));
+    ASSERT_TRUE(base->hasGateDef("cx"));
+    size_t baseGates = base->gateDefines.size();
+
+    std::vector<std::string> sources;
+    for (int i = 0; i < 16; i++) {
+        sources.push_back("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q" + std::to_string(i) + "[2];\nbell q" + std::to_string(i) + "[0], q" + std::to_string(i) + "[1];");
+    }
+    sources.push_back("OPENQASM 2.0;\nqreg q[1];\nqreg q[2];");
+    sources.push_back("OPENQASM 2.0;\nqreg q[1];\nh q[0]");
+    sources.push_back("OPENQASM 2.0;\ngate bell a, b { CX b, a; }\nqreg q[2];\nbell q[0], q[1];");
+
+    for (bool singlePass : {false, true}) {
+        BatchParser batch(base);
+        batch.setSinglePass(singlePass);
+        auto results = batch.parse(sources);
+        ASSERT_EQ(results.size(), sources.size());
+
+        for (int i = 0; i < 16; i++) {
+            ASSERT_TRUE(results[i].ok) << results[i].error;
+            ASSERT_EQ(results[i].program->statements.size(), 3);
+            ASSERT_TRUE(results[i].symbolTable.isQubitRegister("q" + std::to_string(i)));
+            // the include was loaded into the base, so the circuit declared no gates
+            ASSERT_TRUE(results[i].symbolTable.gateDefines.empty());
+            ASSERT_TRUE(results[i].symbolTable.hasGateDef("bell"));
+        }
+        ASSERT_FALSE(results[16].ok);
+        ASSERT_NE(results[16].error.find("Register already exists"), std::string::npos);
+        ASSERT_FALSE(results[17].ok);
+        ASSERT_NE(results[17].error.find("Syntax errors"), std::string::npos);
+        ASSERT_TRUE(results[18].ok);
+        ASSERT_EQ(results[18].symbolTable.gateDefines.size(), 1);
+    }
+    ASSERT_EQ(base->gateDefines.size(), baseGates);
+}
+
+TEST(BatchTest, LowersBaseGateBodies) {
+    // the prelude's program is gone, its gate bodies still evaluate their parameters
+    auto base = BatchParser::makeBase("OPENQASM 2.0;\ninclude \"qelib1.inc\";\ngate rot(t) a { rz(t/2) a; }");
+
+    for (bool singlePass : {false, true}) {
+        BatchParser batch(base);
+        batch.setSinglePass(singlePass);
+        auto results = batch.parse({"OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[1];\nrot(pi) q[0];"});
+        ASSERT_TRUE(results[0].ok) << results[0].error;
+
+        Circuit circuit = Lowering(results[0].symbolTable).lower(*results[0].program);
+        ASSERT_EQ(circuit.instructions.size(), 1);
+        ASSERT_EQ(circuit.instructions[0].op, Instruction::U);
+        ASSERT_NEAR(circuit.instructions[0].params[2], M_PI / 2, 1e-12);
+    }
+}
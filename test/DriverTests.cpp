@@ -0,0 +1,168 @@
+// test/DriverTests.cpp
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <unistd.h>
+#include "Driver.h"
+#include "Expr.h"
+#include "StreamingParser.h"
+#include "Warmup.h"
+
+using namespace qasmcpp;
+
+TEST(DriverTest, ParseString) {
+    QASM2Driver driver;
+    auto program = driver.parseString("OPENQASM 2.0;\nqreg q[2];\nCX q[0], q[1];");
+
+    ASSERT_EQ(program->version, "2.0");
+    ASSERT_EQ(program->statements.size(), 2);
+    ASSERT_TRUE(driver.getSymbolTable().isQubitRegister("q"));
+}
+
+TEST(DriverTest, StatsDisabledByDefault) {
+    QASM2Driver driver;
+    driver.parseString("OPENQASM 2.0;\nqreg q[2];\nCX q[0], q[1];");
+
+    ASSERT_EQ(driver.getStats().tokens, 0);
+    ASSERT_EQ(driver.getStats().astNodes, 0);
+}
+
+TEST(DriverTest, CollectStats) {
+    std::string qasm_code = "OPENQASM 2.0;\nqreg q[2];\nCX q[0], q[1];\nU(pi/2, 0, pi) q[0];";
+    QASM2Driver driver;
+    driver.setCollectStats(true);
+    driver.parseString(qasm_code);
+
+    const ParseStats& stats = driver.getStats();
+    ASSERT_EQ(stats.bytesRead, qasm_code.size());
+    ASSERT_EQ(stats.tokens, 36); // include <EOF>
+    ASSERT_EQ(stats.astNodes, 8); // RegDecl, CX, U and its five expression nodes
+    ASSERT_EQ(stats.includeFiles, 0);
+    ASSERT_GT(stats.parseTreeNodes, stats.tokens);
+    ASSERT_EQ(stats.predictions, 0);
+    ASSERT_GT(stats.dfaStates, 0);
+
+    std::ostringstream json;
+    stats.printJson(json);
+    ASSERT_NE(json.str().find("\"tokens\":36"), std::string::npos);
+
+    // predictions are only counted by the profiling simulator
+    driver.setProfilePredictions(true);
+    driver.parseString(qasm_code);
+    ASSERT_GT(driver.getStats().predictions, 0);
+    ASSERT_EQ(driver.getStats().tokens, 36);
+}
+
+TEST(DriverTest, NestedIncludeTime) {
+    // nested.inc includes myLibrary.inc, whose time is counted once, inside the outer include
+    for (bool singlePass : {false, true}) {
+        QASM2Driver driver;
+        driver.setCollectStats(true);
+        driver.setSinglePass(singlePass);
+        char cwd[4096];
+        ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+        ASSERT_EQ(chdir(QASM2_TEST_DIR), 0);
+        driver.parseString("OPENQASM 2.0;\ninclude \"circuits/nested.inc\";\nqreg q[2];\nmy_swap q[0], q[1];");
+        ASSERT_EQ(chdir(cwd), 0);
+
+        const ParseStats& stats = driver.getStats();
+        ASSERT_EQ(stats.includeFiles, 2);
+        ASSERT_GE(singlePass ? stats.parseTime : stats.visitTime, 0);
+        ASSERT_LE(stats.includeTime, stats.totalTime);
+        ASSERT_NE(driver.getSymbolTable().findGateDef("my_gate"), nullptr);
+    }
+}
+
+TEST(DriverTest, WarmupSnapshot) {
+    std::istringstream corpus(warmup::builtinCorpus());
+    ASSERT_EQ(warmup::replay(corpus), 12);
+    ASSERT_GT(warmup::dfaStateCount(), 0);
+
+    // after the replay the same statements add no prediction states, so only the header is written
+    std::istringstream again(warmup::builtinCorpus());
+    std::ostringstream snapshot;
+    ASSERT_EQ(warmup::writeSnapshot(again, snapshot), 0);
+    ASSERT_EQ(snapshot.str().compare(0, 2, "//"), 0);
+
+    std::istringstream replayed(snapshot.str());
+    ASSERT_EQ(warmup::replay(replayed), 0);
+    ASSERT_FALSE(warmup::replayFile("missing.snapshot"));
+}
+
+// Dumps a program to a string, the nodes print to std::cout
+static std::string dumpProgram(const ProgramNode& program) {
+    testing::internal::CaptureStdout();
+    program.dump();
+    return testing::internal::GetCapturedStdout();
+}
+
+TEST(DriverTest, SinglePassMatchesVisitor) {
+    std::string qasm_code = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\ncreg c[2];\n"
+                            "gate g(a, b) x, y { U(-(a / 2) + sin(b) * 2, a ^ 2, ln(3)) x; CX x, y; rz(a - b - pi) y; }\n"
+                            "g(0.5, 2) q[0], q[1];\nh q;\nbarrier q[0], q;\nmeasure q -> c;\nreset q[1];\nif (c == 2) g(1, 2) q[1], q[0];";
+    QASM2Driver visitorDriver;
+    QASM2Driver singlePassDriver;
+    singlePassDriver.setSinglePass(true);
+    singlePassDriver.setCollectStats(true);
+
+    auto visited = visitorDriver.parseString(qasm_code);
+    auto built = singlePassDriver.parseString(qasm_code);
+    ASSERT_EQ(built->version, "2.0");
+    ASSERT_EQ(built->statements.size(), 10);
+    ASSERT_EQ(dumpProgram(*built), dumpProgram(*visited));
+    ASSERT_EQ(built->exprPool->size(), visited->exprPool->size());
+    ASSERT_EQ(singlePassDriver.getSymbolTable().gateDefines.size(), visitorDriver.getSymbolTable().gateDefines.size());
+    ASSERT_EQ(singlePassDriver.getStats().parseTreeNodes, 0);
+
+    // included files are parsed in the same pass and only fill the symbol table
+    char cwd[4096];
+    ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+    ASSERT_EQ(chdir(QASM2_TEST_DIR), 0);
+    visited = visitorDriver.parseFile("circuits/adder_n4_cus.qasm");
+    built = singlePassDriver.parseFile("circuits/adder_n4_cus.qasm");
+    ASSERT_EQ(chdir(cwd), 0);
+    ASSERT_EQ(dumpProgram(*built), dumpProgram(*visited));
+    ASSERT_EQ(singlePassDriver.getSymbolTable().gateDefines.size(), visitorDriver.getSymbolTable().gateDefines.size());
+
+    ASSERT_THROW(singlePassDriver.parseString("OPENQASM 2.0;\nqreg q[1];\nqreg q[2];"), std::runtime_error);
+}
+
+TEST(DriverTest, StreamingParser) {
+    std::string qasm_code = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\n"
+                            "gate g(a) x { U(a / 2, 0, -pi) x; } // comment\n"
+                            "g(0.5) q[0];\nCX q[0], q[1];\nmeasure q[0] -> ;\nreset q[1];";
+    std::istringstream input(qasm_code);
+    ParseStats stats;
+    StreamingParser parser(input);
+    parser.setStats(&stats);
+
+    // the measure without a cbit is a syntax error and is skipped
+    std::vector<std::string> dumps;
+    std::shared_ptr<QASMNode> statement;
+    while (parser.next(statement)) {
+        testing::internal::CaptureStdout();
+        statement->dump();
+        dumps.push_back(testing::internal::GetCapturedStdout());
+    }
+    ASSERT_EQ(parser.getProgram()->version, "2.0");
+    ASSERT_TRUE(parser.getProgram()->statements.empty());
+    ASSERT_EQ(dumps.size(), 6);
+    ASSERT_EQ(parser.getLine(), 8);
+    ASSERT_TRUE(parser.getSymbolTable().isQubitRegister("q"));
+    ASSERT_EQ(stats.includeFiles, 1);
+
+    QASM2Driver driver;
+    auto program = driver.parseString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\ngate g(a) x { U(a / 2, 0, -pi) x; }\n"
+                                      "g(0.5) q[0];\nCX q[0], q[1];\nreset q[1];");
+    ASSERT_EQ(program->statements.size(), dumps.size());
+    for (size_t i = 0; i < dumps.size(); i++) {
+        testing::internal::CaptureStdout();
+        program->statements[i]->dump();
+        ASSERT_EQ(testing::internal::GetCapturedStdout(), dumps[i]);
+    }
+
+    std::istringstream truncated("OPENQASM 2.0;\nqreg q[2];\nCX q[0], q[1]");
+    StreamingParser truncatedParser(truncated);
+    ASSERT_TRUE(truncatedParser.next(statement));
+    ASSERT_THROW(truncatedParser.next(statement), std::runtime_error);
+}
@@ -0,0 +1,81 @@
+// test/FingerprintTests.cpp
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "Driver.h"
+#include "Fingerprint.h"
+
+using namespace qasmcpp;
+
+static Fingerprint fingerprintString(const std::string& qasm_code) {
+    QASM2Driver driver;
+    auto program = driver.parseString(qasm_code);
+    return fingerprint(*program, driver.getSymbolTable());
+}
+
+static const char* kProgram =
+    "OPENQASM 2.0;\ninclude \"qelib1.inc\";\n"
+    "gate foo(a) x, y { rz(a/2) x; cx x, y; }\n"
+    "gate bar x { h x; }\n"
+    "qreg q[2];\ncreg c[2];\n"
+    "foo(pi) q[0], q[1];\nbar q[1];\nmeasure q -> c;";
+
+TEST(FingerprintTest, IgnoresNamesLayoutAndSpelling) {
+    Fingerprint original = fingerprintString(kProgram);
+    ASSERT_EQ(original.toHex().size(), 16);
+    ASSERT_EQ(fingerprintString(kProgram), original);
+
+    // comments, whitespace, register, gate, parameter and argument names,
+    // definition order and the spelling of constants all differ
+    Fingerprint variant = fingerprintString(
+        "// the same circuit\nOPENQASM 2.0;\ninclude \"qelib1.inc\";\n"
+        "gate second t\n{\n  h t;\n}\n"
+        "gate first(theta) m, n {\n  rz(theta / 2) m;\n  cx m, n;\n}\n"
+        "qreg data[2];\ncreg out[2];\n\n"
+        "first(3.141592653589793) data[0], data[1]; // entangle\n"
+        "second data[1];\nmeasure data -> out;\n");
+    ASSERT_EQ(variant.registers, original.registers);
+    ASSERT_EQ(variant.gates, original.gates);
+    ASSERT_EQ(variant.instructions, original.instructions);
+    ASSERT_EQ(variant, original);
+}
+
+TEST(FingerprintTest, DetectsStructuralChanges) {
+    Fingerprint original = fingerprintString(kProgram);
+    std::string source(kProgram);
+    auto changed = [&](const std::string& from, const std::string& to) {
+        std::string text = source;
+        text.replace(text.find(from), from.size(), to);
+        return fingerprintString(text);
+    };
+
+    ASSERT_NE(changed("qreg q[2];", "qreg q[3];").registers, original.registers);
+    ASSERT_NE(changed("rz(a/2)", "rz(a/4)").gates, original.gates);
+    ASSERT_NE(changed("foo(pi)", "foo(pi/2)").instructions, original.instructions);
+    ASSERT_NE(changed("bar q[1];", "bar q[0];").instructions, original.instructions);
+    ASSERT_NE(changed("measure q -> c;", "measure q[0] -> c[0];"), original);
+    // swapping the arguments of a gate is a different circuit
+    ASSERT_NE(changed("foo(pi) q[0], q[1];", "foo(pi) q[1], q[0];"), original);
+    // and so is a different library gate
+    ASSERT_NE(changed("{ h x; }", "{ s x; }"), original);
+}
+
+TEST(FingerprintTest, HashesIncludedGateBodies) {
+    std::string path = testing::TempDir() + "qasm2_fingerprint_library.inc";
+    auto withLibrary = [&](const std::string& library) {
+        {
+            std::ofstream file(path);
+            file << "OPENQASM 2.0;\n" << library;
+        }
+        return fingerprintString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\ninclude \"" + path + "\";\n"
+                                 "qreg q[2];\nprep q[0];\nlink q[0], q[1];");
+    };
+
+    Fingerprint original = withLibrary("gate prep a { h a; }\ngate link a, b { prep a; cx a, b; }");
+    ASSERT_EQ(withLibrary("gate prep t { h t; }\ngate link x, y { prep x; cx x, y; }"), original);
+    // the same file name with a different gate is a different circuit
+    ASSERT_NE(withLibrary("gate prep a { s a; }\ngate link a, b { prep a; cx a, b; }"), original);
+    ASSERT_NE(withLibrary("gate prep a { h a; }\ngate link a, b { prep a; cx b, a; }"), original);
+    std::remove(path.c_str());
+}
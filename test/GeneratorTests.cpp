@@ -0,0 +1,49 @@
+// test/GeneratorTests.cpp
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include "CircuitGenerator.h"
+#include "Driver.h"
+#include "Lowering.h"
+
+using namespace qasmcpp;
+
+static std::string generate(uint64_t seed, const std::string& kind, int qubits, int64_t size, int depth = 4) {
+    std::ostringstream out;
+    CircuitGenerator generator(seed);
+    generator.generate(out, kind, qubits, size, depth);
+    return out.str();
+}
+
+TEST(GeneratorTest, SeedDeterminesOutput) {
+    for (const char* kind : {"clifford_t", "adder", "vqe", "nested"}) {
+        std::string first = generate(7, kind, 6, 50);
+        ASSERT_FALSE(first.empty());
+        ASSERT_EQ(generate(7, kind, 6, 50), first) << kind;
+        ASSERT_NE(generate(8, kind, 6, 50), first) << kind;
+    }
+    // the QFT has no random choices
+    ASSERT_EQ(generate(7, "qft", 6, 2), generate(8, "qft", 6, 2));
+}
+
+TEST(GeneratorTest, EveryKindParsesAndLowers) {
+    for (const char* kind : {"clifford_t", "qft", "adder", "vqe", "nested"}) {
+        QASM2Driver driver;
+        auto program = driver.parseString(generate(1, kind, 5, 20, 3));
+        ASSERT_EQ(driver.getSyntaxErrors(), 0) << kind;
+
+        Circuit circuit;
+        ASSERT_NO_THROW(circuit = Lowering(driver.getSymbolTable()).lower(*program)) << kind;
+        ASSERT_GT(circuit.instructions.size(), 0) << kind;
+        for (const auto& instruction : circuit.instructions) {
+            ASSERT_GE(instruction.qubits[0], 0) << kind;
+        }
+    }
+}
+
+TEST(GeneratorTest, Errors) {
+    std::ostringstream out;
+    CircuitGenerator generator(1);
+    ASSERT_THROW(generator.generate(out, "nested", 1, 10), std::invalid_argument);
+    ASSERT_THROW(generator.generate(out, "toffoli", 4, 10), std::invalid_argument);
+}
@@ -0,0 +1,101 @@
+// test/NoiseTests.cpp
+
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include "Noise.h"
+
+using namespace qasmcpp;
+
+// One qubit and one cbit, with the given U gates before a measurement
+static Circuit singleQubit(const std::vector<std::array<double, 3>>& gates) {
+    Circuit circuit;
+    circuit.numQubits = 1;
+    circuit.numCbits = 1;
+    circuit.qregs.push_back(RegisterLayout{"q", 0, 1});
+    circuit.cregs.push_back(RegisterLayout{"c", 0, 1});
+    for (const auto& angles : gates) {
+        int id = circuit.matrices.intern(angles[0], angles[1], angles[2]);
+        circuit.instructions.push_back(Instruction{Instruction::U, {0, -1}, -1, id, {angles[0], angles[1], angles[2]}});
+    }
+    circuit.instructions.push_back(Instruction{Instruction::MEASURE, {0, -1}, 0, -1, {0, 0, 0}});
+    return circuit;
+}
+
+TEST(NoiseTest, ParseModel) {
+    NoiseModel model = NoiseModel::parse("depolarizing=0.01,readout=2e-2,amplitude_damping=0,depolarizing2=1");
+    ASSERT_DOUBLE_EQ(model.depolarizing, 0.01);
+    ASSERT_DOUBLE_EQ(model.depolarizing2, 1);
+    ASSERT_DOUBLE_EQ(model.readout, 0.02);
+    ASSERT_EQ(model.amplitudeDamping, 0);
+    ASSERT_FALSE(model.isIdeal());
+    ASSERT_TRUE(NoiseModel::parse("").isIdeal());
+
+    ASSERT_THROW(NoiseModel::parse("thermal=0.1"), std::runtime_error);
+    ASSERT_THROW(NoiseModel::parse("readout=1.5"), std::runtime_error);
+    ASSERT_THROW(NoiseModel::parse("readout=0.1x"), std::runtime_error);
+    ASSERT_THROW(NoiseModel::parse("readout"), std::runtime_error);
+}
+
+TEST(NoiseTest, IdealTrajectories) {
+    // h q[0]; cx q[0], q[1]; measure q -> c;
+    Circuit circuit;
+    circuit.numQubits = 2;
+    circuit.numCbits = 2;
+    circuit.qregs.push_back(RegisterLayout{"q", 0, 2});
+    circuit.cregs.push_back(RegisterLayout{"c", 0, 2});
+    circuit.instructions.push_back(Instruction{Instruction::U, {0, -1}, -1, circuit.matrices.intern(M_PI / 2, 0, M_PI), {M_PI / 2, 0, M_PI}});
+    circuit.instructions.push_back(Instruction{Instruction::CX, {0, 1}, -1, -1, {0, 0, 0}});
+    circuit.instructions.push_back(Instruction{Instruction::MEASURE, {0, -1}, 0, -1, {0, 0, 0}});
+    circuit.instructions.push_back(Instruction{Instruction::MEASURE, {1, -1}, 1, -1, {0, 0, 0}});
+
+    SimOptions options;
+    options.shots = 1000;
+    SimResult result = simulateNoisy(circuit, NoiseModel(), options);
+    ASSERT_EQ(result.simulations, 1000);
+    ASSERT_EQ(result.stats.noiseEvents, 0);
+    ASSERT_EQ(result.counts.size(), 2);
+    ASSERT_GT(result.counts["00"], 400);
+    ASSERT_GT(result.counts["11"], 400);
+
+    // a two-qubit error after the cx breaks the correlation
+    NoiseModel noise;
+    noise.depolarizing2 = 0.5;
+    result = simulateNoisy(circuit, noise, options);
+    ASSERT_EQ(result.counts.size(), 4);
+    ASSERT_NEAR(result.stats.noiseEvents / 1000.0, 0.5, 0.06);
+
+    // each trajectory has its own stream, so the counts only depend on the seed
+    ASSERT_EQ(simulateNoisy(circuit, noise, options).counts, result.counts);
+}
+
+TEST(NoiseTest, ErrorRates) {
+    SimOptions options;
+    options.shots = 4000;
+    const std::array<double, 3> x{M_PI, 0, M_PI};
+    const std::array<double, 3> id{0, 0, 0};
+
+    // readout flips the measured 1
+    NoiseModel readout;
+    readout.readout = 0.1;
+    SimResult result = simulateNoisy(singleQubit({x}), readout, options);
+    ASSERT_NEAR(result.counts["0"] / 4000.0, 0.1, 0.02);
+    ASSERT_EQ(result.stats.noiseEvents, result.counts["0"]);
+
+    // X and Y flip the bit, Z does not: P(0) = 2/3 * p
+    NoiseModel depolarizing;
+    depolarizing.depolarizing = 0.3;
+    result = simulateNoisy(singleQubit({x}), depolarizing, options);
+    ASSERT_NEAR(result.counts["0"] / 4000.0, 0.2, 0.025);
+
+    // |1> survives five gates with probability (1 - gamma)^5
+    NoiseModel damping;
+    damping.amplitudeDamping = 0.1;
+    result = simulateNoisy(singleQubit({x, id, id, id, id}), damping, options);
+    ASSERT_NEAR(result.counts["1"] / 4000.0, std::pow(0.9, 5), 0.025);
+    ASSERT_EQ(result.stats.noiseEvents, result.counts["0"]);
+
+    // damping leaves |0> alone
+    result = simulateNoisy(singleQubit({id, id}), damping, options);
+    ASSERT_EQ(result.counts["0"], 4000);
+}
@@ -129,3 +129,27 @@ TEST_F(ParserTest, ParseCXOperation) {
     ASSERT_EQ(cxStmt->targetQubit.name, "q");
     ASSERT_EQ(cxStmt->targetQubit.index, 1);
 }
+
+TEST_F(ParserTest, ParseIf) {
+    std::string qasm_code = "OPENQASM 2.0;\nqreg q[1];\ncreg c[2];\nif (c == 3) U(1, 2, 3) q[0];";
+    auto program = parse(qasm_code);
+
+    auto ifStmt = std::dynamic_pointer_cast<IfStmtNode>(program->statements[2]);
+    ASSERT_NE(ifStmt, nullptr);
+    ASSERT_EQ(ifStmt->classicalRegister.name, "c");
+    ASSERT_EQ(ifStmt->value, 3u);
+    ASSERT_NE(std::dynamic_pointer_cast<UStmtNode>(ifStmt->statement), nullptr);
+}
+
+TEST_F(ParserTest, SharedExpressions) {
+    std::string qasm_code = "OPENQASM 2.0;\nqreg q[2];\nU(pi/2, 0, -pi/2) q[0];\nU(pi/2, 0, -(pi/2)) q[1];";
+    auto program = parse(qasm_code);
+
+    auto first = std::dynamic_pointer_cast<UStmtNode>(program->statements[1]);
+    auto second = std::dynamic_pointer_cast<UStmtNode>(program->statements[2]);
+    ASSERT_NE(program->exprPool, nullptr);
+    ASSERT_EQ(first->theta, second->theta);
+    ASSERT_EQ(first->phi, second->phi);
+    ASSERT_EQ(first->lambda, second->lambda); // parentheses build no node
+    ASSERT_EQ(program->exprPool->size(), 5);  // pi, 2, pi/2, 0, -(pi/2)
+}
@@ -0,0 +1,111 @@
+// test/ResourcesTests.cpp
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <unistd.h>
+#include "Driver.h"
+#include "Lowering.h"
+#include "Resources.h"
+#include "StatementReader.h"
+
+using namespace qasmcpp;
+
+TEST(ResourcesTest, StatementReader) {
+    std::istringstream input("OPENQASM 2.0; // first ; line\ninclude \"a;b.inc\";\ngate g a {\n  h a; # inside\n}\n"
+                             "qreg q[1];\n h  q[0] ;\n");
+    StatementReader reader(input);
+    std::vector<std::string> statements;
+    std::vector<size_t> lines;
+    std::string statement;
+    while (reader.next(statement)) {
+        statements.push_back(statement);
+        lines.push_back(reader.getLine());
+    }
+
+    ASSERT_EQ(statements.size(), 5);
+    ASSERT_EQ(statements[0], "OPENQASM 2.0;");
+    ASSERT_EQ(statements[1], "include \"a;b.inc\";");
+    ASSERT_EQ(statements[2].front(), 'g');
+    ASSERT_EQ(statements[2].back(), '}');
+    ASSERT_EQ(statements[4], "h  q[0] ;");
+    ASSERT_EQ(lines, (std::vector<size_t>{1, 2, 3, 6, 7}));
+
+    std::istringstream unterminated("qreg q[1]");
+    StatementReader broken(unterminated);
+    ASSERT_THROW(broken.next(statement), std::runtime_error);
+}
+
+TEST(ResourcesTest, CountsAndDepth) {
+    ResourceEstimator estimator;
+    ResourceCounts counts = estimator.estimateString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg a[2];\nqreg b[1];\ncreg c[3];\n"
+                                                     "h a;\nccx a[0],a[1],b[0];\nmeasure b[0] -> c[2];");
+
+    ASSERT_EQ(counts.numQubits, 3);
+    ASSERT_EQ(counts.numCbits, 3);
+    ASSERT_EQ(counts.gateCounts["h"], 2);
+    ASSERT_EQ(counts.gateCounts["ccx"], 1);
+    ASSERT_EQ(counts.gateCounts["measure"], 1);
+
+    // ccx expands to 6 cx, 4 t, 3 tdg and 2 h
+    ASSERT_EQ(counts.cxCount, 6);
+    ASSERT_EQ(counts.tCount, 7);
+    ASSERT_EQ(counts.uCount, 11);
+    ASSERT_EQ(counts.maxNesting, 3); // ccx -> h -> u2 -> U
+
+    // h, then the 11 layers of ccx, then the measurement on b
+    ASSERT_EQ(estimator.getGateResources().at("ccx").depth, 11);
+    ASSERT_EQ(counts.registerDepth["a"], 12);
+    ASSERT_EQ(counts.registerDepth["b"], 13);
+    ASSERT_EQ(counts.depth, 13);
+    ASSERT_EQ(counts.statements, 8);
+    ASSERT_EQ(counts.gateDefinitions, 35);
+}
+
+TEST(ResourcesTest, RepeatedInclude) {
+    // a file included twice declares its gates once, as in the parser
+    ResourceEstimator estimator;
+    ResourceCounts counts = estimator.estimateString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\ninclude \"qelib1.inc\";\nqreg q[1];\nh q[0];");
+    ASSERT_EQ(counts.gateDefinitions, 35);
+    ASSERT_EQ(counts.gateCounts["h"], 1);
+}
+
+// The streaming counts must match the U and CX instructions of the lowered circuit
+TEST(ResourcesTest, MatchesLowering) {
+    // The adder includes "../test/circuits/*.inc" relative to the working directory
+    char cwd[4096];
+    ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+    ASSERT_EQ(chdir(QASM2_TEST_DIR), 0);
+
+    QASM2Driver driver;
+    auto program = driver.parseFile("circuits/adder_n4_cus.qasm");
+    ResourceEstimator estimator;
+    ResourceCounts counts = estimator.estimateFile("circuits/adder_n4_cus.qasm");
+    ASSERT_EQ(chdir(cwd), 0);
+
+    Lowering lowering(driver.getSymbolTable());
+    Circuit circuit = lowering.lower(*program);
+    size_t u = 0, cx = 0;
+    for (const auto& instruction : circuit.instructions) {
+        u += instruction.op == Instruction::U;
+        cx += instruction.op == Instruction::CX;
+    }
+
+    ASSERT_EQ(counts.numQubits, circuit.numQubits);
+    ASSERT_EQ(counts.numCbits, circuit.numCbits);
+    ASSERT_EQ(counts.uCount, u);
+    ASSERT_EQ(counts.cxCount, cx);
+}
+
+TEST(ResourcesTest, Errors) {
+    ResourceEstimator estimator;
+    ASSERT_THROW(estimator.estimateString("OPENQASM 2.0;\nqreg q[2];\nfoo q[0];"), std::runtime_error);
+    ASSERT_THROW(estimator.estimateString("OPENQASM 2.0;\nqreg q[2];\nCX q[0], r[1];"), std::runtime_error);
+    ASSERT_THROW(estimator.estimateString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\ncx q[0];"), std::runtime_error);
+
+    try {
+        estimator.estimateString("OPENQASM 2.0;\nqreg q[2];\n\nh q[0];");
+        FAIL();
+    } catch (const std::runtime_error& e) {
+        ASSERT_EQ(std::string(e.what()), "<input>:4: Undefined gate: h");
+    }
+}
@@ -0,0 +1,110 @@
+// test/ServerTests.cpp
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include "Server.h"
+
+using namespace qasmcpp;
+
+static std::string frame(const std::string& command, const std::string& source) {
+    return command + " " + std::to_string(source.size()) + "\n" + source;
+}
+
+// Reads one framed answer, returns false at the end of the stream
+static bool readAnswer(std::istream& in, std::string& status, std::string& payload) {
+    size_t bytes;
+    if (!(in >> status >> bytes)) {
+        return false;
+    }
+    in.get();
+    payload.assign(bytes, '\0');
+    in.read(&payload[0], bytes);
+    return true;
+}
+
+TEST(ServerTest, FramedSession) {
+    std::string program = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\nh q[0];\ncx q[0], q[1];";
+    std::istringstream in(frame("parse", program) + frame("resources", program) + frame("stats", program) +
+                          frame("validate", "OPENQASM 2.0;\nqreg q[1];\nh q[0];") + frame("compile", "") +
+                          frame("quit", "") + frame("parse", program));
+    std::ostringstream out;
+
+    CompileServer server;
+    ASSERT_FALSE(server.serve(in, out));
+    ASSERT_EQ(server.getRequestCount(), 5); // quit is not a request and the frame after it is not read
+
+    std::istringstream answers(out.str());
+    std::string status, payload;
+    ASSERT_TRUE(readAnswer(answers, status, payload));
+    ASSERT_EQ(status, "ok");
+    ASSERT_NE(payload.find("ProgramNode"), std::string::npos);
+
+    ASSERT_TRUE(readAnswer(answers, status, payload));
+    ASSERT_EQ(status, "ok");
+    ASSERT_NE(payload.find("\"cx\""), std::string::npos);
+
+    ASSERT_TRUE(readAnswer(answers, status, payload));
+    ASSERT_EQ(status, "ok");
+    ASSERT_NE(payload.find("\"tokens\""), std::string::npos);
+
+    ASSERT_TRUE(readAnswer(answers, status, payload));
+    ASSERT_EQ(status, "error");
+    ASSERT_NE(payload.find("[undefined-gate]"), std::string::npos);
+
+    ASSERT_TRUE(readAnswer(answers, status, payload));
+    ASSERT_EQ(status, "error");
+    ASSERT_EQ(payload, "Unknown command: compile");
+
+    ASSERT_TRUE(readAnswer(answers, status, payload));
+    ASSERT_EQ(status, "ok");
+    ASSERT_TRUE(payload.empty());
+    ASSERT_FALSE(readAnswer(answers, status, payload));
+}
+
+TEST(ServerTest, ErrorsKeepServing) {
+    CompileServer server;
+    std::string response;
+    ASSERT_FALSE(server.handle("parse", "OPENQASM 2.0;\nqreg q[1];\nfoo q[0];", response));
+    ASSERT_FALSE(response.empty());
+    ASSERT_TRUE(server.handle("parse", "OPENQASM 2.0;\nqreg q[1];\nU(0, 0, 0) q[0];", response));
+
+    // syntax errors are answered to the client instead of printed by the server
+    for (const char* command : {"parse", "stats"}) {
+        testing::internal::CaptureStderr();
+        ASSERT_FALSE(server.handle(command, "OPENQASM 2.0;\nqreg q[1];\nU(0, 0, 0) q[0]\nbarrier q;", response));
+        ASSERT_EQ(testing::internal::GetCapturedStderr(), "");
+        ASSERT_EQ(response.compare(0, 15, "Syntax errors: "), 0);
+        ASSERT_NE(response.find("\n4:"), std::string::npos);
+    }
+
+    // a header that cannot be parsed ends the session, the framing is lost
+    std::istringstream in("parse many\nqreg q[1];");
+    std::ostringstream out;
+    ASSERT_TRUE(server.serve(in, out));
+    ASSERT_EQ(out.str().compare(0, 6, "error "), 0);
+
+    // a header alone does not allocate the size it announces
+    std::istringstream truncated("parse 1073741823\nqreg q[1];");
+    std::ostringstream answer;
+    ASSERT_TRUE(server.serve(truncated, answer));
+    ASSERT_EQ(answer.str().compare(0, 6, "error "), 0);
+    ASSERT_NE(answer.str().find("Truncated request"), std::string::npos);
+}
+
+TEST(ServerTest, SocketPathMustBeASocket) {
+    std::string path = testing::TempDir() + "qasm2_server_not_a_socket";
+    {
+        std::ofstream file(path);
+        file << "keep";
+    }
+    CompileServer server;
+    ASSERT_THROW(server.serveSocket(path), std::runtime_error);
+
+    std::ifstream file(path);
+    std::string content;
+    file >> content;
+    ASSERT_EQ(content, "keep");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,480 @@
+// test/SimulatorTests.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <unistd.h>
+#include "Driver.h"
+#include "Lowering.h"
+#include "Simulator.h"
+#include "Relabel.h"
+#include "Stabilizer.h"
+#include "Template.h"
+
+using namespace qasmcpp;
+
+typedef std::complex<double> Amplitude;
+
+static Circuit lowerString(const std::string& qasm_code) {
+    QASM2Driver driver;
+    auto program = driver.parseString(qasm_code);
+    Lowering lowering(driver.getSymbolTable());
+    return lowering.lower(*program);
+}
+
+TEST(SimulatorTest, Hadamard) {
+    StatevectorSimulator simulator(1);
+    simulator.applyU(0, M_PI / 2, 0, M_PI);
+
+    ASSERT_NEAR(simulator.getState()[0].real(), M_SQRT1_2, 1e-12);
+    ASSERT_NEAR(simulator.getState()[1].real(), M_SQRT1_2, 1e-12);
+}
+
+// The vector kernels must match a plain matrix-vector product on every qubit
+TEST(SimulatorTest, KernelsMatchReference) {
+    const int numQubits = 6;
+    StatevectorSimulator simulator(numQubits);
+    std::vector<Amplitude> reference(1 << numQubits, 0);
+    reference[0] = 1;
+
+    for (int step = 0; step < 60; ++step) {
+        int qubit = step % numQubits;
+        if (step % 3 == 2) {
+            int target = (qubit + 1 + step / 3) % numQubits;
+            if (target == qubit)
+                continue;
+            simulator.applyCX(qubit, target);
+            for (size_t i = 0; i < reference.size(); ++i) {
+                if ((i >> qubit & 1) && !(i >> target & 1))
+                    std::swap(reference[i], reference[i | (size_t(1) << target)]);
+            }
+        } else {
+            double theta = 0.3 * step, phi = 0.7 * step, lambda = 1.1 * step;
+            simulator.applyU(qubit, theta, phi, lambda);
+            Amplitude m[4] = {std::cos(theta / 2), -std::polar(std::sin(theta / 2), lambda),
+                              std::polar(std::sin(theta / 2), phi), std::polar(std::cos(theta / 2), phi + lambda)};
+            for (size_t i = 0; i < reference.size(); ++i) {
+                if (i >> qubit & 1)
+                    continue;
+                size_t j = i | (size_t(1) << qubit);
+                Amplitude a0 = reference[i], a1 = reference[j];
+                reference[i] = m[0] * a0 + m[1] * a1;
+                reference[j] = m[2] * a0 + m[3] * a1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < reference.size(); ++i) {
+        ASSERT_NEAR(std::abs(simulator.getState()[i] - reference[i]), 0, 1e-12);
+    }
+}
+
+TEST(SimulatorTest, LowerBroadcast) {
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg a[2];\nqreg b[2];\ncreg c[2];\n"
+                                  "h a;\ncx a,b;\nmeasure b -> c;");
+
+    ASSERT_EQ(circuit.numQubits, 4);
+    ASSERT_EQ(circuit.numCbits, 2);
+    ASSERT_EQ(circuit.qregs[1].offset, 2);
+    ASSERT_EQ(circuit.instructions.size(), 6); // 2 h (as U), 2 cx, 2 measure
+
+    ASSERT_EQ(circuit.instructions[2].op, Instruction::CX);
+    ASSERT_EQ(circuit.instructions[2].qubits[0], 0);
+    ASSERT_EQ(circuit.instructions[2].qubits[1], 2);
+    ASSERT_EQ(circuit.instructions[5].cbit, 1);
+}
+
+TEST(SimulatorTest, MatrixCache) {
+    MatrixCache cache;
+    int id = cache.intern(M_PI / 2, 0, M_PI);
+    ASSERT_EQ(cache.intern(M_PI / 2, -0.0, M_PI), id);
+    ASSERT_NE(cache.intern(M_PI / 2, 0, M_PI / 2), id);
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_NEAR(cache.get(id)[0].real(), M_SQRT1_2, 1e-12);
+
+    // every t and h shares one matrix each
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[4];\nt q;\nh q;\nt q;");
+    ASSERT_EQ(circuit.instructions.size(), 12);
+    ASSERT_EQ(circuit.matrices.size(), 2);
+    ASSERT_EQ(circuit.instructions[0].matrixId, circuit.instructions[8].matrixId);
+}
+
+TEST(SimulatorTest, CircuitTemplate) {
+    QASM2Driver driver;
+    auto program = driver.parseString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\n"
+                                      "h q;\nrx(theta) q[0];\ncx q[0],q[1];\nrz(2*theta+beta) q;\nu3(pi/2,beta,0) q[1];");
+    CircuitTemplate circuitTemplate(*program, driver.getSymbolTable(), {"theta", "beta"});
+    ASSERT_EQ(circuitTemplate.getNumSlots(), 4); // rx, rz on both qubits and u3, h stays fixed
+
+    Circuit circuit = circuitTemplate.bind({0.1, 0.2});
+    for (int round = 0; round < 3; ++round) {
+        double theta = 0.4 * round, beta = -1.3 + round;
+        circuitTemplate.rebind({theta, beta}, circuit);
+        Circuit expected = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\nh q;\nrx(" + std::to_string(theta) +
+                                       ") q[0];\ncx q[0],q[1];\nrz(2*" + std::to_string(theta) + "+(" + std::to_string(beta) +
+                                       ")) q;\nu3(pi/2," + std::to_string(beta) + ",0) q[1];");
+        ASSERT_EQ(circuit.instructions.size(), expected.instructions.size());
+        ASSERT_EQ(circuit.matrices.size(), expected.matrices.size());
+        for (size_t i = 0; i < expected.instructions.size(); ++i) {
+            ASSERT_EQ(circuit.instructions[i].op, expected.instructions[i].op);
+            for (int k = 0; k < 3; ++k)
+                ASSERT_NEAR(circuit.instructions[i].params[k], expected.instructions[i].params[k], 1e-5);
+        }
+
+        StatevectorSimulator bound(2), reference(2);
+        bound.evolve(circuit);
+        reference.evolve(expected);
+        for (size_t i = 0; i < reference.getState().size(); ++i) {
+            ASSERT_NEAR(std::abs(bound.getState()[i] - reference.getState()[i]), 0, 1e-5);
+        }
+    }
+
+    ASSERT_THROW(circuitTemplate.bind({0.1}), std::runtime_error);
+    ASSERT_THROW(CircuitTemplate(*program, driver.getSymbolTable(), {"theta"}), std::runtime_error);
+}
+
+TEST(SimulatorTest, ScheduleLayers) {
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[4];\ncreg c[4];\n"
+                                  "h q;\ncx q[0],q[1];\ncx q[2],q[3];\nbarrier q;\nh q[0];\nh q[0];\nmeasure q[0] -> c[0];");
+    std::vector<Layer> layers = scheduleLayers(circuit);
+
+    // h on 4 qubits, both cx, barrier fence, h, h, measure
+    ASSERT_EQ(layers.size(), 5);
+    ASSERT_EQ(layers[0].end - layers[0].begin, 4);
+    ASSERT_EQ(layers[1].end - layers[1].begin, 2);
+    ASSERT_EQ(layers[2].end - layers[2].begin, 1);
+    ASSERT_EQ(layers[3].end - layers[3].begin, 1);
+    ASSERT_FALSE(layers[4].gates);
+}
+
+// Layers mix gates inside a cache block with gates across blocks
+TEST(SimulatorTest, LayeredMatchesSequential) {
+    const int numQubits = 14;
+    Circuit circuit;
+    circuit.numQubits = numQubits;
+    for (int step = 0; step < 200; ++step) {
+        int qubit = (step * 5) % numQubits;
+        Instruction instruction{Instruction::U, {qubit, -1}, -1, -1, {0.3 * step, 0.7 * step, 1.1 * step}};
+        if (step % 3 == 2) {
+            instruction.op = Instruction::CX;
+            instruction.qubits[1] = (qubit + 1 + step % 7) % numQubits;
+        } else {
+            instruction.matrixId = circuit.matrices.intern(0.3 * step, 0.7 * step, 1.1 * step);
+        }
+        circuit.instructions.push_back(instruction);
+    }
+
+    StatevectorSimulator layered(numQubits);
+    layered.evolve(circuit);
+    ASSERT_LT(scheduleLayers(circuit).size(), circuit.instructions.size());
+
+    StatevectorSimulator sequential(numQubits);
+    for (const auto& instruction : circuit.instructions) {
+        if (instruction.op == Instruction::U)
+            sequential.applyU(instruction.qubits[0], instruction.params[0], instruction.params[1], instruction.params[2]);
+        else
+            sequential.applyCX(instruction.qubits[0], instruction.qubits[1]);
+    }
+
+    for (size_t i = 0; i < layered.getState().size(); ++i) {
+        ASSERT_NEAR(std::abs(layered.getState()[i] - sequential.getState()[i]), 0, 1e-12);
+    }
+}
+
+// High gates of a layer share gathered sweeps instead of taking one each
+TEST(SimulatorTest, GroupedHighGates) {
+    const int numQubits = 22;
+    Circuit circuit;
+    circuit.numQubits = numQubits;
+    for (int q = 0; q < numQubits; ++q) {
+        circuit.instructions.push_back(Instruction{Instruction::U, {q, -1}, -1, circuit.matrices.intern(0.1 * q, 0.2, 0.3 * q), {0.1 * q, 0.2, 0.3 * q}});
+    }
+    // CX between two high qubits, a high and a low qubit and a high qubit and a tile run qubit
+    circuit.instructions.push_back(Instruction{Instruction::CX, {20, 13}, -1, -1, {0, 0, 0}});
+    circuit.instructions.push_back(Instruction{Instruction::CX, {7, 18}, -1, -1, {0, 0, 0}});
+    circuit.instructions.push_back(Instruction{Instruction::CX, {21, 1}, -1, -1, {0, 0, 0}});
+    ASSERT_EQ(scheduleLayers(circuit).size(), 2);
+
+    ExecStats stats;
+    StatevectorSimulator layered(numQubits);
+    layered.setStats(&stats);
+    layered.evolve(circuit);
+
+    StatevectorSimulator sequential(numQubits);
+    for (const auto& instruction : circuit.instructions) {
+        if (instruction.op == Instruction::U)
+            sequential.applyU(instruction.qubits[0], instruction.params[0], instruction.params[1], instruction.params[2]);
+        else
+            sequential.applyCX(instruction.qubits[0], instruction.qubits[1]);
+    }
+    for (size_t i = 0; i < layered.getState().size(); ++i) {
+        ASSERT_NEAR(std::abs(layered.getState()[i] - sequential.getState()[i]), 0, 1e-12);
+    }
+
+    // initialize, the low U gates, the 10 high U gates in groups of 6 and 4, the 3 CX in one group
+    ASSERT_EQ(stats.sweeps, 1 + 1 + 2 + 1);
+    ASSERT_EQ(stats.blockedGates, circuit.instructions.size());
+}
+
+TEST(SimulatorTest, RelabelQubits) {
+    // the only busy qubits are the last ones of a 14 qubit register
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[14];\ncreg c[14];\n"
+                                  "h q[13];\ncx q[13],q[12];\nry(pi/3) q[12];\nt q[13];\nh q[0];\nmeasure q -> c;");
+    std::vector<int> order = chooseQubitOrder(circuit);
+    ASSERT_EQ(order[13], 0);
+    ASSERT_EQ(order[12], 1);
+    ASSERT_EQ(order[0], 2);
+
+    // q[2] has fewer gates than q[1] but shares its CX gates with q[3]
+    Circuit partners = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[4];\n"
+                                   "x q[3];\nx q[3];\nx q[3];\nx q[3];\nx q[1];\nx q[1];\nx q[1];\nx q[1];\n"
+                                   "x q[2];\ncx q[3],q[2];\ncx q[3],q[2];");
+    ASSERT_EQ(chooseQubitOrder(partners), (std::vector<int>{3, 2, 1, 0}));
+
+    Circuit relabeled = circuit;
+    ASSERT_EQ(relabelQubits(relabeled, order), 14);
+    ASSERT_EQ(relabeled.physicalQubits[13], 0);
+
+    // amplitudes are reported in declared qubit order either way
+    StatevectorSimulator plain(14);
+    plain.evolve(circuit);
+    StatevectorSimulator moved(14);
+    moved.evolve(relabeled);
+    for (uint64_t i = 0; i < plain.getState().size(); ++i) {
+        ASSERT_NEAR(std::abs(plain.amplitude(i) - moved.amplitude(i)), 0, 1e-12);
+    }
+
+    SimOptions options;
+    options.shots = 500;
+    SimResult result = simulate(circuit, options);
+    options.relabelQubits = false;
+    ASSERT_EQ(simulate(circuit, options).counts, result.counts);
+
+    ASSERT_EQ(result.stats.relabeledQubits, 14);
+    ASSERT_EQ(result.stats.highGatesBefore, 4); // h, cx, ry and t each lower to one gate
+    ASSERT_EQ(result.stats.highGatesAfter, 0);
+}
+
+TEST(SimulatorTest, LowerErrors) {
+    ASSERT_THROW(lowerString("OPENQASM 2.0;\nqreg q[2];\nfoo q[0];"), std::runtime_error);
+    ASSERT_THROW(lowerString("OPENQASM 2.0;\nqreg q[2];\nCX q[0], r[1];"), std::runtime_error);
+    ASSERT_THROW(lowerString("OPENQASM 2.0;\nqreg q[2];\ncreg c[3];\nmeasure q -> c;"), std::runtime_error);
+}
+
+TEST(SimulatorTest, BellCounts) {
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\ncreg c[2];\n"
+                                  "h q[0];\ncx q[0],q[1];\nmeasure q -> c;");
+    SimOptions options;
+    options.shots = 1000;
+    options.seed = 7;
+    SimResult result = simulate(circuit, options);
+
+    ASSERT_EQ(result.counts.size(), 2);
+    ASSERT_EQ(result.counts["00"] + result.counts["11"], 1000);
+    ASSERT_GT(result.counts["00"], 400);
+    ASSERT_GT(result.counts["11"], 400);
+
+    // same seed, same counts
+    ASSERT_EQ(simulate(circuit, options).counts, result.counts);
+
+    // the measurements are terminal, so the circuit ran once
+    ASSERT_TRUE(hasTerminalMeasurements(circuit));
+    ASSERT_EQ(result.simulations, 1);
+    ASSERT_EQ(result.registerCounts["c"], result.counts);
+}
+
+TEST(SimulatorTest, TerminalSamplingMatchesShots) {
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg a[1];\ncreg b[2];\n"
+                                  "ry(pi/3) q[0];\nh q[1];\ncx q[1],q[2];\nmeasure q[0] -> a[0];\nmeasure q[1] -> b[0];\nmeasure q[2] -> b[1];");
+    SimOptions options;
+    options.shots = 4000;
+    SimResult sampled = simulate(circuit, options);
+    options.sampleTerminal = false;
+    SimResult shots = simulate(circuit, options);
+
+    ASSERT_EQ(sampled.simulations, 1);
+    ASSERT_EQ(shots.simulations, 4000);
+
+    // P(a=1) = sin^2(pi/6) = 1/4, b is 00 or 11 with equal probability
+    for (const auto& result : {sampled, shots}) {
+        ASSERT_NEAR(result.registerCounts.at("a").at("1") / 4000.0, 0.25, 0.03);
+        ASSERT_NEAR(result.registerCounts.at("b").at("11") / 4000.0, 0.5, 0.03);
+        ASSERT_EQ(result.registerCounts.at("b").count("01"), 0);
+    }
+}
+
+TEST(SimulatorTest, MidCircuitMeasurement) {
+    ASSERT_FALSE(hasTerminalMeasurements(lowerString("OPENQASM 2.0;\nqreg q[1];\ncreg c[1];\n"
+                                                     "measure q[0] -> c[0];\nU(pi,0,pi) q[0];")));
+    ASSERT_FALSE(hasTerminalMeasurements(lowerString("OPENQASM 2.0;\nqreg q[1];\nreset q[0];")));
+}
+
+TEST(SimulatorTest, ClassicalState) {
+    Circuit circuit;
+    circuit.numCbits = 73;
+    circuit.cregs = {{"a", 0, 3}, {"b", 3, 70}};
+    ClassicalState classical(circuit);
+    ASSERT_EQ(classical.getWords().size(), 3);
+
+    // a is word 0, b is words 1 and 2
+    classical.set(0, 1);
+    classical.set(2, 1);
+    classical.set(3 + 65, 1);
+    ASSERT_TRUE(classical.test(Condition{0, 1, 5}));
+    ASSERT_FALSE(classical.test(Condition{0, 1, 4}));
+    ASSERT_FALSE(classical.test(Condition{1, 2, 0}));
+    classical.set(3 + 65, 0);
+    ASSERT_TRUE(classical.test(Condition{1, 2, 0}));
+    classical.set(3 + 1, 1);
+    ASSERT_TRUE(classical.test(Condition{1, 2, 2}));
+
+    std::vector<int> cbits;
+    classical.toBits(cbits);
+    ASSERT_EQ(cbits.size(), 73);
+    ASSERT_EQ(cbits[0] + cbits[1] * 2 + cbits[2] * 4, 5);
+    ASSERT_EQ(cbits[4], 1);
+    classical.clear();
+    ASSERT_TRUE(classical.test(Condition{0, 1, 0}));
+}
+
+// A measured bit decides an operation later in the same shot
+TEST(SimulatorTest, ClassicalControl) {
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg c[1];\ncreg d[2];\n"
+                                  "h q[0];\nmeasure q[0] -> c[0];\nif (c == 1) cx q[1], q[2];\nif (c == 1) x q[1];\n"
+                                  "if (c == 0) reset q[0];\nmeasure q[1] -> d[0];\nmeasure q[2] -> d[1];");
+    ASSERT_EQ(circuit.conditions.size(), 3);
+    ASSERT_EQ(circuit.numWords, 2);
+    ASSERT_EQ(circuit.conditions[0].word, 0);
+    ASSERT_EQ(circuit.conditions[0].value, 1u);
+    ASSERT_EQ(circuit.instructions[2].condition, 0);
+    ASSERT_EQ(circuit.instructions[4].condition, 2);
+    ASSERT_EQ(circuit.instructions.back().condition, -1);
+    ASSERT_FALSE(hasTerminalMeasurements(circuit));
+
+    // the cx runs before the x, so q[2] stays 0
+    SimOptions options;
+    options.shots = 400;
+    for (bool stabilizer : {false, true}) {
+        options.useStabilizer = stabilizer;
+        SimResult result = simulate(circuit, options);
+        ASSERT_EQ(result.simulations, 400);
+        ASSERT_EQ(result.counts.size(), 2);
+        ASSERT_EQ(result.counts["00 0"] + result.counts["01 1"], 400);
+        ASSERT_GT(result.counts["01 1"], 150);
+    }
+
+    ASSERT_THROW(lowerString("OPENQASM 2.0;\nqreg q[1];\ncreg c[2];\nif (c == 4) U(0,0,0) q[0];"), std::runtime_error);
+    ASSERT_THROW(lowerString("OPENQASM 2.0;\nqreg q[1];\nif (c == 0) U(0,0,0) q[0];"), std::runtime_error);
+}
+
+TEST(SimulatorTest, ResetAndRegisters) {
+    Circuit circuit = lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg a[1];\ncreg b[2];\n"
+                                  "x q;\nreset q[1];\nmeasure q[0] -> a[0];\nmeasure q[1] -> b[0];\nmeasure q[2] -> b[1];");
+    SimOptions options;
+    options.shots = 10;
+    SimResult result = simulate(circuit, options);
+
+    ASSERT_EQ(result.counts.size(), 1);
+    ASSERT_EQ(result.counts["10 1"], 10);
+    ASSERT_EQ(result.registerCounts["b"]["10"], 10);
+    ASSERT_EQ(result.simulations, 10); // reset is not terminal
+}
+
+TEST(SimulatorTest, DetectClifford) {
+    ASSERT_TRUE(isCliffordCircuit(lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg c[3];\n"
+                                              "h q;\ns q[0];\nsdg q[1];\nx q[2];\ny q[0];\nz q[1];\n"
+                                              "cx q[0],q[1];\ncz q[1],q[2];\nswap q[0],q[2];\nreset q[1];\nmeasure q -> c;")));
+    ASSERT_TRUE(isCliffordU(-M_PI / 2, 3 * M_PI, 0));
+    ASSERT_FALSE(isCliffordCircuit(lowerString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[1];\nt q[0];")));
+    ASSERT_THROW(StabilizerSimulator(1).applyU(0, M_PI / 4, 0, 0), std::runtime_error);
+}
+
+// Stabilizer states are uniform over their support, which the tableau samples must match
+TEST(SimulatorTest, StabilizerMatchesStatevector) {
+    const int numQubits = 5;
+    for (uint64_t round = 0; round < 20; ++round) {
+        Circuit circuit;
+        circuit.numQubits = numQubits;
+        uint64_t state = round * 7919 + 17;
+        for (int i = 0; i < 40; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            Instruction instruction;
+            int qubit = (state >> 33) % numQubits;
+            if ((state >> 20) % 3 == 0) {
+                instruction.op = Instruction::CX;
+                instruction.qubits[0] = qubit;
+                instruction.qubits[1] = (qubit + 1 + (state >> 40) % (numQubits - 1)) % numQubits;
+            } else {
+                instruction.op = Instruction::U;
+                instruction.qubits[0] = qubit;
+                for (int p = 0; p < 3; ++p) {
+                    instruction.params[p] = ((state >> (44 + 4 * p)) % 8) * M_PI / 2 - M_PI;
+                }
+                instruction.matrixId = circuit.matrices.intern(instruction.params[0], instruction.params[1], instruction.params[2]);
+            }
+            circuit.instructions.push_back(instruction);
+        }
+        ASSERT_TRUE(isCliffordCircuit(circuit));
+
+        StatevectorSimulator reference(numQubits);
+        reference.evolve(circuit);
+        double largest = 0;
+        for (uint64_t i = 0; i < reference.getState().size(); ++i) {
+            largest = std::max(largest, reference.probability(i));
+        }
+
+        StabilizerSimulator tableau(numQubits);
+        tableau.evolve(circuit);
+        for (uint64_t seed = 1; seed <= 16; ++seed) {
+            StabilizerSimulator copy = tableau;
+            copy.setSeed(seed);
+            uint64_t outcome = 0;
+            for (int qubit = 0; qubit < numQubits; ++qubit) {
+                outcome |= uint64_t(copy.measure(qubit)) << qubit;
+            }
+            ASSERT_NEAR(reference.probability(outcome), largest, 1e-9);
+        }
+    }
+}
+
+TEST(SimulatorTest, StabilizerGHZ) {
+    // far beyond the statevector limit, 1000 qubits fit in a tableau of 512 KiB
+    std::string qasm = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[1000];\ncreg c[1000];\nh q[0];\n";
+    for (int i = 1; i < 1000; ++i) {
+        qasm += "cx q[" + std::to_string(i - 1) + "],q[" + std::to_string(i) + "];\n";
+    }
+    qasm += "measure q -> c;";
+    Circuit circuit = lowerString(qasm);
+
+    SimOptions options;
+    options.shots = 20;
+    SimResult result = simulate(circuit, options);
+
+    ASSERT_TRUE(result.stats.stabilizer);
+    ASSERT_EQ(result.simulations, 1);
+    ASSERT_EQ(result.counts.size(), 2);
+    ASSERT_EQ(result.counts[std::string(1000, '0')] + result.counts[std::string(1000, '1')], 20);
+}
+
+TEST(SimulatorTest, AdderCircuit) {
+    // The adder includes "../test/circuits/*.inc" relative to the working directory
+    char cwd[4096];
+    ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+    ASSERT_EQ(chdir(QASM2_TEST_DIR), 0);
+
+    QASM2Driver driver;
+    auto program = driver.parseFile("circuits/adder_n4_cus.qasm");
+    ASSERT_EQ(chdir(cwd), 0);
+
+    Lowering lowering(driver.getSymbolTable());
+    Circuit circuit = lowering.lower(*program);
+    ASSERT_EQ(circuit.numQubits, 4);
+
+    SimOptions options;
+    options.shots = 100;
+    size_t shots = 0;
+    for (const auto& count : simulate(circuit, options).counts) {
+        ASSERT_EQ(count.first[3], '0'); // q[0] is reset before it is measured
+        shots += count.second;
+    }
+    ASSERT_EQ(shots, 100);
+}
@@ -0,0 +1,111 @@
+// test/StdLibTests.cpp
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include "Driver.h"
+#include "Lowering.h"
+#include "StdLib.h"
+
+using namespace qasmcpp;
+
+TEST(StdLibTest, IsQelib1) {
+    ASSERT_TRUE(stdlib::isQelib1("qelib1.inc"));
+    ASSERT_TRUE(stdlib::isQelib1("../test/circuits/qelib1.inc"));
+    ASSERT_FALSE(stdlib::isQelib1("myqelib1.inc"));
+    ASSERT_FALSE(stdlib::isQelib1("myLibrary.inc"));
+}
+
+TEST(StdLibTest, LoadQelib1) {
+    SymbolTable symbolTable;
+    stdlib::loadQelib1(symbolTable);
+
+    size_t count;
+    stdlib::qelib1Gates(count);
+    ASSERT_EQ(count, 35);
+    ASSERT_EQ(symbolTable.gateDefines.size(), count);
+
+    auto u2 = symbolTable.getGateDef("u2");
+    ASSERT_EQ(u2->params.size(), 2);
+    ASSERT_EQ(u2->qubits.size(), 1);
+    ASSERT_EQ(u2->body.size(), 1);
+    ASSERT_NE(std::dynamic_pointer_cast<UStmtNode>(u2->body[0]), nullptr);
+}
+
+TEST(StdLibTest, IncludeUsesBuiltin) {
+    std::string qasm_code = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\nh q[0];\ncx q[0],q[1];";
+    QASM2Driver driver;
+    driver.setCollectStats(true);
+    driver.parseString(qasm_code);
+
+    ASSERT_TRUE(driver.getSymbolTable().hasGateDef("ccx"));
+    ASSERT_EQ(driver.getStats().includeFiles, 1);
+    ASSERT_EQ(driver.getStats().bytesRead, qasm_code.size()); // nothing read from disk
+}
+
+// Lowers one application of a gate with the built-in tables or the library file
+static Circuit lowerCall(const Gate& gate, const std::vector<double>& angles, bool useBuiltinStdlib) {
+    std::ostringstream qasm_code;
+    qasm_code << "OPENQASM 2.0;\ninclude \"" << QASM2_TEST_DIR << "/circuits/qelib1.inc\";\nqreg q[3];\n" << gate.name;
+    if (!gate.params.empty()) {
+        qasm_code << "(";
+        for (size_t i = 0; i < gate.params.size(); ++i) {
+            qasm_code << (i > 0 ? "," : "") << angles[i];
+        }
+        qasm_code << ")";
+    }
+    // qubits in reverse order, so a swapped slot in a body changes the circuit
+    for (size_t i = 0; i < gate.qubits.size(); ++i) {
+        qasm_code << (i > 0 ? "," : " ") << "q[" << gate.qubits.size() - 1 - i << "]";
+    }
+    qasm_code << ";";
+
+    QASM2Driver driver;
+    driver.setUseBuiltinStdlib(useBuiltinStdlib);
+    auto program = driver.parseString(qasm_code.str());
+    return Lowering(driver.getSymbolTable()).lower(*program);
+}
+
+// The built-in tables must match the library file gate by gate
+TEST(StdLibTest, MatchesLibraryFile) {
+    QASM2Driver driver;
+    driver.setUseBuiltinStdlib(false);
+    driver.parseFile(QASM2_TEST_DIR "/circuits/qelib1.inc");
+    const auto& parsed = driver.getSymbolTable().gateDefines;
+
+    const auto& builtin = stdlib::qelib1Definitions();
+    ASSERT_EQ(parsed.size(), builtin.size());
+
+    const std::vector<std::vector<double>> bindings = {{0.3, 1.1, -0.7}, {-2.5, 0.45, 3.0}};
+    for (const auto& gate : builtin) {
+        auto it = parsed.find(gate->name);
+        ASSERT_NE(it, parsed.end()) << gate->name;
+        const auto& expected = it->second;
+
+        ASSERT_EQ(gate->params, expected->params) << gate->name;
+        ASSERT_EQ(gate->qubits.size(), expected->qubits.size()) << gate->name;
+        for (size_t i = 0; i < gate->qubits.size(); ++i) {
+            ASSERT_EQ(gate->qubits[i]->name, expected->qubits[i]->name) << gate->name;
+        }
+        ASSERT_EQ(gate->body.size(), expected->body.size()) << gate->name;
+
+        // the angles and qubits of the expanded bodies must agree instruction by instruction
+        for (const auto& angles : bindings) {
+            Circuit circuit = lowerCall(*gate, angles, true);
+            Circuit reference = lowerCall(*gate, angles, false);
+            ASSERT_EQ(circuit.instructions.size(), reference.instructions.size()) << gate->name;
+            for (size_t i = 0; i < circuit.instructions.size(); ++i) {
+                const Instruction& actual = circuit.instructions[i];
+                const Instruction& wanted = reference.instructions[i];
+                ASSERT_EQ(actual.op, wanted.op) << gate->name << " instruction " << i;
+                ASSERT_EQ(actual.qubits[0], wanted.qubits[0]) << gate->name << " instruction " << i;
+                if (actual.op == Instruction::CX) {
+                    ASSERT_EQ(actual.qubits[1], wanted.qubits[1]) << gate->name << " instruction " << i;
+                } else if (actual.op == Instruction::U) {
+                    for (int k = 0; k < 3; ++k) {
+                        ASSERT_NEAR(actual.params[k], wanted.params[k], 1e-12) << gate->name << " instruction " << i;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,159 @@
+// test/TranspilerTests.cpp
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include "Driver.h"
+#include "Lowering.h"
+#include "Simulator.h"
+#include "Transpiler.h"
+
+using namespace qasmcpp;
+
+typedef std::complex<double> Amplitude;
+
+// Applies a basis gate through U and CX, each equal to the gate up to a global phase
+static void applyOp(StatevectorSimulator& simulator, const BasisOp& op) {
+    switch (op.gate) {
+    case BasisOp::RZ: simulator.applyU(op.qubits[0], 0, 0, op.params[0]); break;
+    case BasisOp::RX: simulator.applyU(op.qubits[0], op.params[0], -M_PI / 2, M_PI / 2); break;
+    case BasisOp::RY: simulator.applyU(op.qubits[0], op.params[0], 0, 0); break;
+    case BasisOp::SX: simulator.applyU(op.qubits[0], M_PI / 2, -M_PI / 2, M_PI / 2); break;
+    case BasisOp::X: simulator.applyU(op.qubits[0], M_PI, 0, M_PI); break;
+    case BasisOp::U3: simulator.applyU(op.qubits[0], op.params[0], op.params[1], op.params[2]); break;
+    case BasisOp::CX: simulator.applyCX(op.qubits[0], op.qubits[1]); break;
+    case BasisOp::CZ:
+        simulator.applyU(op.qubits[1], M_PI / 2, 0, M_PI);
+        simulator.applyCX(op.qubits[0], op.qubits[1]);
+        simulator.applyU(op.qubits[1], M_PI / 2, 0, M_PI);
+        break;
+    }
+}
+
+static void expectSameUpToPhase(const std::vector<Amplitude>& expected, const std::vector<Amplitude>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    size_t largest = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (std::abs(expected[i]) > std::abs(expected[largest]))
+            largest = i;
+    }
+    Amplitude phase = actual[largest] / expected[largest];
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_NEAR(std::abs(expected[i] * phase - actual[i]), 0, 1e-9) << "amplitude " << i;
+    }
+}
+
+TEST(TranspilerTest, Basis) {
+    ASSERT_EQ(Basis::get({"cx", "sx", "rz"}), Basis::get({"rz", "sx", "cx"}));
+    ASSERT_EQ(Basis::get(Basis::parseList("rz,sx,cx"))->getName(), "cx,rz,sx");
+    ASSERT_EQ(Basis::get({"rz", "ry", "cz"})->getEuler(), Basis::EULER_ZYZ);
+    ASSERT_EQ(Basis::get({"rz", "ry", "cz"})->getTwoQubitGate(), BasisOp::CZ);
+    ASSERT_THROW(Basis::get({"rz", "cx"}), std::runtime_error);
+    ASSERT_THROW(Basis::get({"u3", "ccx"}), std::runtime_error);
+}
+
+// Random circuits of two independent blocks, with special angles and repeated gates to fuse
+TEST(TranspilerTest, MatchesCircuitUpToPhase) {
+    const int numQubits = 5;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+    const double special[] = {0, M_PI / 4, M_PI / 2, M_PI};
+
+    for (const char* gates : {"rz,sx,cx", "rz,sx,x,cx", "u3,cx", "rz,ry,cx", "rz,rx,cz", "rz,sx,cz"}) {
+        auto basis = Basis::get(Basis::parseList(gates));
+        for (int round = 0; round < 10; ++round) {
+            Circuit circuit;
+            circuit.numQubits = numQubits;
+            for (int step = 0; step < 60; ++step) {
+                int qubit = rng() % numQubits;
+                if (rng() % 3 == 0) {
+                    // qubits 0-2 and 3-4 never interact
+                    int target = qubit < 3 ? (qubit + 1 + rng() % 2) % 3 : 7 - qubit;
+                    circuit.instructions.push_back(Instruction{Instruction::CX, {qubit, target}, -1, -1, {0, 0, 0}});
+                    continue;
+                }
+                double theta = rng() % 2 ? special[rng() % 4] : angle(rng);
+                double phi = rng() % 2 ? special[rng() % 4] : angle(rng);
+                double lambda = angle(rng);
+                Instruction u{Instruction::U, {qubit, -1}, -1, circuit.matrices.intern(theta, phi, lambda), {theta, phi, lambda}};
+                circuit.instructions.push_back(u);
+                if (rng() % 4 == 0)
+                    circuit.instructions.push_back(u);
+            }
+
+            TranspileStats stats;
+            TranspiledCircuit transpiled = transpile(circuit, basis, &stats);
+            ASSERT_GE(stats.blocks, 2) << gates;
+            ASSERT_GT(stats.fusedRuns, 0) << gates;
+
+            StatevectorSimulator expected(numQubits), actual(numQubits);
+            expected.evolve(circuit);
+            for (const auto& op : transpiled.ops) {
+                applyOp(actual, op);
+            }
+            expectSameUpToPhase(expected.getState(), actual.getState());
+        }
+    }
+}
+
+TEST(TranspilerTest, MergesRotations) {
+    QASM2Driver driver;
+    auto program = driver.parseString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\ncreg c[2];\n"
+                                      "h q[0];\nh q[0];\nt q[1];\nt q[1];\ns q[1];\ncx q[0],q[1];\nmeasure q -> c;");
+    Circuit circuit = Lowering(driver.getSymbolTable()).lower(*program);
+    TranspiledCircuit transpiled = transpile(circuit, Basis::get({"rz", "sx", "cx"}));
+
+    // h h cancels, t t s is one rz of pi
+    ASSERT_EQ(transpiled.ops.size(), 4);
+    ASSERT_EQ(transpiled.ops[0].gate, BasisOp::RZ);
+    ASSERT_NEAR(std::abs(transpiled.ops[0].params[0]), M_PI, 1e-9);
+    ASSERT_EQ(transpiled.ops[1].gate, BasisOp::CX);
+    ASSERT_EQ(transpiled.ops[3].gate, BasisOp::MEASURE);
+}
+
+// A barrier statement stays one fence over all of its qubits
+TEST(TranspilerTest, KeepsBarrierStatements) {
+    QASM2Driver driver;
+    auto program = driver.parseString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg a[2];\nqreg b[2];\n"
+                                      "h a[0];\nh b[1];\nbarrier a[0],b[1];\nbarrier a;\nh a[1];");
+    Circuit circuit = Lowering(driver.getSymbolTable()).lower(*program);
+
+    std::ostringstream out;
+    transpile(circuit, Basis::get({"u3", "cx"})).write(out);
+    std::string text = out.str();
+
+    size_t first = text.find("barrier a[0],b[1];\n");
+    size_t second = text.find("barrier a[0],a[1];\n");
+    ASSERT_NE(first, std::string::npos) << text;
+    ASSERT_NE(second, std::string::npos) << text;
+    ASSERT_EQ(text.find("barrier b[1];"), std::string::npos) << text;
+    // both h come before the first barrier, the last one after the second
+    ASSERT_LT(text.rfind(") b[1];", first), first) << text;
+    ASSERT_NE(text.rfind(") b[1];", first), std::string::npos) << text;
+    ASSERT_GT(text.find(") a[1];"), second) << text;
+}
+
+// The written program parses back to the same state
+TEST(TranspilerTest, WritesQasm) {
+    std::string source = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg a[2];\nqreg b[2];\n"
+                         "h a;\ncx a[0],b[1];\nccx a[0],a[1],b[0];\nu3(0.3,-1.2,2.5) b[1];\ncrz(0.7) b[1],a[1];\nswap a[0],b[0];";
+    QASM2Driver driver;
+    auto program = driver.parseString(source);
+    Circuit circuit = Lowering(driver.getSymbolTable()).lower(*program);
+    StatevectorSimulator expected(circuit.numQubits);
+    expected.evolve(circuit);
+
+    for (const char* gates : {"rz,sx,cx", "u3,cz"}) {
+        std::ostringstream out;
+        transpile(circuit, Basis::get(Basis::parseList(gates))).write(out);
+
+        QASM2Driver reparsed;
+        auto transpiledProgram = reparsed.parseString(out.str());
+        ASSERT_EQ(reparsed.getSyntaxErrors(), 0) << out.str();
+        Circuit transpiledCircuit = Lowering(reparsed.getSymbolTable()).lower(*transpiledProgram);
+        StatevectorSimulator actual(transpiledCircuit.numQubits);
+        actual.evolve(transpiledCircuit);
+        expectSameUpToPhase(expected.getState(), actual.getState());
+    }
+}
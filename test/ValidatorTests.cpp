@@ -0,0 +1,128 @@
+// test/ValidatorTests.cpp
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include "SymbolTable.h"
+#include "Validator.h"
+
+using namespace qasmcpp;
+
+static std::vector<DiagCode> codes(const DiagnosticSink& sink) {
+    std::vector<DiagCode> result;
+    for (const auto& diagnostic : sink.getDiagnostics()) {
+        result.push_back(diagnostic.code);
+    }
+    return result;
+}
+
+TEST(ValidatorTest, ValidProgram) {
+    DiagnosticSink sink;
+    Validator validator(sink);
+    ASSERT_TRUE(validator.validateString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[3];\ncreg c[3];\n"
+                                         "gate maj(t) a,b,c { cx c,b; cx c,a; ccx a,b,c; rz(t/2) a; }\n"
+                                         "h q;\nmaj(pi) q[0],q[1],q[2];\nbarrier q;\nmeasure q -> c;\nif(c==7) x q[0];"));
+    ASSERT_FALSE(sink.hasErrors());
+}
+
+TEST(ValidatorTest, ReportsEveryError) {
+    DiagnosticSink sink;
+    Validator validator(sink);
+    ASSERT_FALSE(validator.validateString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[2];\ncreg c[1];\n"
+                                          "qreg q[4];\n"        // 5
+                                          "foo q[0];\n"         // 6
+                                          "cx q[0], q[2];\n"    // 7
+                                          "h c[0];\n"           // 8
+                                          "cx q[1], q[1];\n"    // 9
+                                          "measure q -> c;\n"   // 10
+                                          "rz(theta) q[0];\n"   // 11
+                                          "if(c==2) x q[0];\n"  // 12
+                                          "u1(1, 2) q[0];\n")); // 13
+
+    std::vector<DiagCode> expected = {DiagCode::DuplicateRegister, DiagCode::UndefinedGate, DiagCode::IndexOutOfRange,
+                                      DiagCode::WrongRegisterKind, DiagCode::DuplicateQubit, DiagCode::RegisterSizeMismatch,
+                                      DiagCode::UndefinedIdentifier, DiagCode::ValueOutOfRange, DiagCode::WrongArgumentCount};
+    ASSERT_EQ(codes(sink), expected);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(sink.getDiagnostics()[i].line, i + 5);
+        ASSERT_EQ(sink.getDiagnostics()[i].source, "<input>");
+    }
+
+    std::ostringstream out;
+    sink.print(out);
+    ASSERT_NE(out.str().find("<input>:6:1: error: Undefined gate: foo [undefined-gate]"), std::string::npos);
+}
+
+TEST(ValidatorTest, GateBodies) {
+    DiagnosticSink sink;
+    Validator validator(sink);
+    validator.validateString("OPENQASM 2.0;\n"
+                             "gate g(t, t) a, a { U(t, 0, s) a; CX a, b; }\n"
+                             "gate g a { }\n"
+                             "qreg q[2];\n"
+                             "g(1, 2) q[0], q[1];");
+
+    std::vector<DiagCode> expected = {DiagCode::DuplicateArgument, DiagCode::DuplicateArgument, DiagCode::UndefinedIdentifier,
+                                      DiagCode::UndefinedIdentifier, DiagCode::DuplicateGate};
+    ASSERT_EQ(codes(sink), expected);
+}
+
+TEST(ValidatorTest, SyntaxErrors) {
+    DiagnosticSink sink;
+    Validator validator(sink);
+    ASSERT_FALSE(validator.validateString("OPENQASM 3.0;\nqreg q[2];\nCX q[0] q[1];\nqreg r[0];\nCX r[0], q[5];"));
+
+    // syntax errors are reported while parsing, before the semantic checks
+    std::vector<Diagnostic> diagnostics = sink.getDiagnostics();
+    ASSERT_GE(diagnostics.size(), 4);
+    ASSERT_EQ(diagnostics.front().code, DiagCode::SyntaxError);
+    ASSERT_EQ(diagnostics.front().line, 3);
+    ASSERT_EQ(diagnostics[diagnostics.size() - 3].code, DiagCode::UnsupportedVersion);
+
+    // the parser recovers, so the statements after the syntax error are still checked
+    ASSERT_EQ(diagnostics[diagnostics.size() - 2].code, DiagCode::InvalidSize);
+    ASSERT_EQ(diagnostics.back().code, DiagCode::IndexOutOfRange);
+    ASSERT_EQ(diagnostics.back().line, 5);
+}
+
+TEST(ValidatorTest, MissingInclude) {
+    DiagnosticSink sink;
+    Validator validator(sink);
+    ASSERT_FALSE(validator.validateString("OPENQASM 2.0;\ninclude \"missing.inc\";"));
+    ASSERT_EQ(codes(sink), std::vector<DiagCode>{DiagCode::IncludeNotFound});
+    ASSERT_STREQ(DiagnosticSink::codeName(DiagCode::IncludeNotFound), "include-not-found");
+}
+
+TEST(ValidatorTest, RepeatedInclude) {
+    // a file included twice declares its gates once, as in the parser
+    DiagnosticSink sink;
+    Validator validator(sink);
+    ASSERT_TRUE(validator.validateString("OPENQASM 2.0;\ninclude \"qelib1.inc\";\ninclude \"qelib1.inc\";\nqreg q[1];\nh q[0];"));
+    ASSERT_TRUE(sink.getDiagnostics().empty());
+}
+
+TEST(ValidatorTest, WideConditions) {
+    // a 64-bit creg takes any 64-bit value, as the lowering does
+    DiagnosticSink sink;
+    Validator validator(sink);
+    ASSERT_TRUE(validator.validateString("OPENQASM 2.0;\nqreg q[1];\ncreg c[64];\ncreg d[63];\n"
+                                         "if(c==9223372036854775808) U(0, 0, 0) q[0];\n"
+                                         "if(c==18446744073709551615) U(0, 0, 0) q[0];\n"
+                                         "if(d==9223372036854775807) U(0, 0, 0) q[0];"));
+
+    ASSERT_FALSE(validator.validateString("OPENQASM 2.0;\nqreg q[1];\ncreg c[64];\ncreg d[63];\n"
+                                          "if(c==18446744073709551616) U(0, 0, 0) q[0];\n"
+                                          "if(d==9223372036854775808) U(0, 0, 0) q[0];"));
+    ASSERT_EQ(codes(sink), std::vector<DiagCode>(2, DiagCode::ValueOutOfRange));
+}
+
+TEST(ValidatorTest, SymbolTableLookups) {
+    SymbolTable table;
+    ASSERT_TRUE(table.tryAddRegister("q", 2, BitType::Qubit));
+    ASSERT_FALSE(table.tryAddRegister("q", 3, BitType::Qubit));
+    ASSERT_NE(table.findQubitRegister("q"), nullptr);
+    ASSERT_EQ(table.findCbitRegister("q"), nullptr);
+    ASSERT_EQ(table.findGateDef("h"), nullptr);
+    ASSERT_TRUE(table.findQubitRegister("q")->hasBit(1));
+    ASSERT_FALSE(table.findQubitRegister("q")->hasBit(2));
+    ASSERT_THROW(table.addRegister("q", 1, BitType::Qubit), std::runtime_error);
+}
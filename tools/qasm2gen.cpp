@@ -0,0 +1,82 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "CircuitGenerator.h"
+
+using namespace qasmcpp;
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <clifford_t|qft|adder|vqe|nested>"
+              << " [--qubits N] [--size N] [--depth N] [--seed N] [--no-include] [-o <path>]" << std::endl;
+    std::cerr << "  --qubits   number of qubits, or the addend width for adder (default 16)" << std::endl;
+    std::cerr << "  --size     gates (clifford_t, nested), repetitions (qft, adder) or layers (vqe) (default 1000)" << std::endl;
+    std::cerr << "  --depth    nesting depth of the gate hierarchy for nested (default 4)" << std::endl;
+    std::cerr << "  --seed     seed of the random sequence (default 1)" << std::endl;
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string kind = argv[1];
+    int qubits = 16;
+    long long size = 1000;
+    int depth = 4;
+    unsigned long long seed = 1;
+    bool includeStdlib = true;
+    const char* outputPath = nullptr;
+
+    for (int i = 2; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--qubits") == 0 && hasValue) {
+            qubits = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+            size = std::stoll(argv[++i]);
+        } else if (std::strcmp(argv[i], "--depth") == 0 && hasValue) {
+            depth = std::stoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = std::stoull(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-include") == 0) {
+            includeStdlib = false;
+        } else if (std::strcmp(argv[i], "-o") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (qubits < 1 || size < 0 || depth < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // large output buffer, the circuits can reach gigabytes
+    std::vector<char> buffer(1 << 20);
+    std::ofstream file;
+    if (outputPath != nullptr) {
+        file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        file.open(outputPath);
+        if (!file.is_open()) {
+            std::cerr << "Could not open file: " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath != nullptr ? file : std::cout;
+
+    try {
+        CircuitGenerator generator(seed, includeStdlib);
+        generator.generate(out, kind, qubits, size, depth);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    out.flush();
+    return out.good() ? 0 : 1;
+}